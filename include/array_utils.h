@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <stdint.h>
 #include <array>
@@ -22,4 +23,29 @@ public:
   /// \return Whether or not id was found in array.
   static bool skip_index_to_id(uint32_t& curr_index, uint32_t const* const array, const uint32_t& array_len,
                                const uint32_t& id);
+
+  // number of elements checked one by one before galloping
+  static constexpr uint32_t PROBE_LEN = 4;
+
+  /// Returns the index of the first element >= id in array[start_index, array_len), or array_len if there is none.
+  /// Short skips (the common case when intersecting lists of similar sizes) are resolved inline by probing the next
+  /// few elements. Longer skips gallop to bracket the target and finish with a vectorized scan of the final window
+  /// (AVX2 or SSE2 when available, scalar otherwise).
+  static inline uint32_t lower_bound_from(const uint32_t* array, uint32_t array_len, uint32_t start_index,
+                                          uint32_t id) {
+    const uint32_t probe_end = std::min<uint64_t>(uint64_t(start_index) + PROBE_LEN, array_len);
+    for(uint32_t i = start_index; i < probe_end; i++) {
+      if(array[i] >= id) {
+        return i;
+      }
+    }
+
+    return (probe_end >= array_len) ? array_len : gallop_from(array, array_len, probe_end - 1, id);
+  }
+
+  /// Galloping part of lower_bound_from(): requires array[low] < id.
+  static uint32_t gallop_from(const uint32_t* array, uint32_t array_len, uint32_t low, uint32_t id);
+
+  /// Number of leading elements of the sorted array that are smaller than id.
+  static uint32_t count_less_than(const uint32_t* array, uint32_t array_len, uint32_t id);
 };
\ No newline at end of file
@@ -84,6 +84,12 @@ private:
     std::string skip_index_upper_bound_key = std::string(SKIP_INDICES_PREFIX) + "`";  // cannot inline this
     rocksdb::Slice* skip_index_iter_upper_bound = nullptr;
 
+    // A crash while indexing coalesced writes can't be pinned to a single log entry: the crash is recorded with this
+    // key instead, and the writes are replayed one at a time on restart so that the bad entry can be skipped.
+    const static int64_t COALESCED_WRITES_LOG_INDEX = -9998;
+    static constexpr const char* COALESCED_CRASH_KEY = "$XC";
+    bool coalescing_disabled = false;
+
     // When set, all writes (both live and log serialized) are skipped with 422 response
     const std::atomic<bool>& skip_writes;
 
@@ -96,6 +102,16 @@ private:
 
     static std::string get_req_suffix_key(uint64_t req_id);
 
+    // Single document writes that can be indexed together share a key: they add documents to the same collection
+    // with the same parameters. Returns false for every other kind of request.
+    bool get_coalesce_key(uint64_t req_id, std::string& coalesce_key);
+
+    // Takes the writes that can be coalesced with `req_id` from the front of the queue, waiting up to the configured
+    // time for more of them to arrive. The returned ids start with `req_id`.
+    std::vector<uint64_t> take_coalesced_writes(uint64_t req_id, std::deque<uint64_t>& queue, await_t& queue_mutex);
+
+    void index_coalesced_writes(const std::vector<uint64_t>& req_ids);
+
 public:
 
     static const constexpr char* RAFT_REQ_LOG_PREFIX = "$RL_";
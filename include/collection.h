@@ -62,6 +62,9 @@ private:
 
     const size_t DEFAULT_TOPSTER_SIZE = 250;
 
+    // minimum number of documents that each thread must parse when hydrating search hits in parallel
+    static constexpr size_t PARALLEL_PARSE_MIN_DOCS = 16;
+
     struct highlight_t {
         size_t field_index;
         std::string field;
@@ -109,6 +112,14 @@ private:
     // Auto incrementing record ID used internally for indexing - not exposed to the client
     std::atomic<uint32_t> next_seq_id;
 
+    // Bumped on every write that can change search results: used to key cached search responses
+    std::atomic<uint64_t> write_generation{0};
+
+    // Bumped along with the write generation of any collection (join queries span collections)
+    static std::atomic<uint64_t> global_write_generation;
+
+    void bump_write_generation();
+
     Store* store;
 
     std::vector<field> fields;
@@ -344,6 +355,10 @@ private:
 
     std::shared_ptr<VQModel> vq_model = nullptr;
 
+    Option<bool> parse_stored_document(const std::string& seq_id_key, const StoreStatus json_doc_status,
+                                       const std::string& json_doc_str, nlohmann::json& document,
+                                       bool raw_doc) const;
+
 public:
 
     enum {MAX_ARRAY_MATCHES = 5};
@@ -402,6 +417,10 @@ public:
 
     uint32_t get_collection_id() const;
 
+    uint64_t get_write_generation() const;
+
+    static uint64_t get_global_write_generation();
+
     uint32_t get_next_seq_id();
 
     Option<uint32_t> doc_id_to_seq_id_with_lock(const std::string & doc_id) const;
@@ -447,6 +466,12 @@ public:
 
     Option<bool> get_document_from_store(const uint32_t& seq_id, nlohmann::json & document, bool raw_doc = false) const;
 
+    /// Batched variant of `get_document_from_store`: `documents` and `document_ops` are aligned with `seq_id_keys`.
+    void get_documents_from_store(const std::vector<std::string>& seq_id_keys,
+                                  std::vector<nlohmann::json>& documents,
+                                  std::vector<Option<bool>>& document_ops,
+                                  size_t concurrency, bool raw_doc = false) const;
+
     Option<uint32_t> index_in_memory(nlohmann::json & document, uint32_t seq_id,
                                      const index_operation_t op, const DIRTY_VALUES& dirty_values);
 
@@ -525,6 +550,17 @@ public:
 
     void do_housekeeping();
 
+    /// Persists the HNSW graph of every vector field into `dir_path` and appends an entry per graph to `manifest`.
+    /// Graphs that don't fit within the remaining `max_elements` are left out and get rebuilt on load.
+    Option<bool> save_vector_indices(const std::string& dir_path, nlohmann::json& manifest,
+                                     size_t& max_elements) const;
+
+    /// Restores the HNSW graphs listed for this collection in `manifest`. Entries that no longer match the schema
+    /// are skipped, so that those fields are rebuilt from the stored documents instead.
+    void load_vector_indices(const std::string& dir_path, const nlohmann::json& manifest);
+
+    void clear_restored_vector_watermarks();
+
     Option<nlohmann::json> search(std::string query, const std::vector<std::string> & search_fields,
                                   const std::string & filter_query, const std::vector<std::string> & facet_fields,
                                   const std::vector<sort_by> & sort_fields, const std::vector<uint32_t>& num_typos,
@@ -678,7 +714,7 @@ public:
 
     void reference_populate_sort_mapping(int* sort_order, std::vector<size_t>& geopoint_indices,
                                          std::vector<sort_by>& sort_fields_std,
-                                         std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values) const;
+                                         std::array<sort_column_t*, 3>& field_values) const;
 
     int64_t reference_string_sort_score(const std::string& field_name, const uint32_t& seq_id) const;
 
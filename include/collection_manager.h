@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <string>
+#include <deque>
 #include <sparsepp.h>
 #include "store.h"
 #include "field.h"
@@ -10,6 +11,41 @@
 #include "threadpool.h"
 #include "batched_indexer.h"
 
+struct doc_load_batch_t {
+    std::vector<index_record> index_records;
+
+    // estimated memory taken up by the parsed documents
+    size_t num_bytes = 0;
+};
+
+// Parsed documents of one seq_id range, handed over from a reader thread to the indexing thread during load
+struct doc_load_range_t {
+    std::string start_key;
+    std::string upper_bound_key;
+
+    std::deque<doc_load_batch_t> batches;
+
+    bool done = false;
+    Option<bool> status = Option<bool>(true);
+};
+
+// State shared by the reader threads of a collection and the thread that indexes what they parse, guarded by `mutex`
+struct doc_load_state_t {
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    std::vector<std::unique_ptr<doc_load_range_t>> ranges;
+
+    // range that is being indexed: the ranges after it are read ahead
+    size_t current_range = 0;
+
+    // estimated memory of the documents that are parsed but not indexed yet, across all readers
+    size_t num_buffered_bytes = 0;
+    size_t max_buffered_bytes = 0;
+
+    bool abort = false;
+};
+
 template<typename ResourceType>
 struct locked_resource_view_t {
     locked_resource_view_t(std::shared_mutex &mutex, ResourceType &resource) : _lock(mutex), _resource(&resource) {}
@@ -102,6 +138,17 @@ public:
     static constexpr const char* SYMLINK_PREFIX = "$SL";
     static constexpr const char* PRESET_PREFIX = "$PS";
 
+    static constexpr const char* VECTOR_INDEX_MANIFEST_FILE = "manifest.json";
+
+    // number of seq_id ranges of a collection that are read and parsed concurrently during load
+    static constexpr const size_t DOC_LOAD_NUM_READERS = 4;
+
+    // number of parsed batches a reader can queue ahead of the indexer
+    static constexpr const size_t DOC_LOAD_MAX_QUEUED_BATCHES = 2;
+
+    // estimated memory that the parsed documents of all readers can take up before the readers wait for the indexer
+    static constexpr const size_t DOC_LOAD_MAX_BUFFERED_BYTES = 250 * 1024 * 1024;
+
     static CollectionManager & get_instance() {
         static CollectionManager instance;
         return instance;
@@ -125,11 +172,17 @@ public:
                                        float max_memory_ratio,
                                        spp::sparse_hash_map<std::string, std::string>& referenced_in);
 
+    static void read_doc_range(Store* store, Collection* collection, const std::string& seq_id_prefix,
+                               doc_load_state_t& state, const size_t range_index, const size_t batch_size,
+                               const size_t batch_mem_threshold, const std::atomic<bool>& quit);
+
     static Option<bool> load_collection(const nlohmann::json& collection_meta,
                                         const size_t batch_size,
                                         const StoreStatus& next_coll_id_status,
                                         const std::atomic<bool>& quit,
-                                        spp::sparse_hash_map<std::string, std::string>& referenced_in);
+                                        spp::sparse_hash_map<std::string, std::string>& referenced_in,
+                                        const std::string& vector_index_dir = "",
+                                        const nlohmann::json& vector_index_manifest = nlohmann::json::array());
 
     Option<Collection*> clone_collection(const std::string& existing_name, const nlohmann::json& req_json);
 
@@ -149,7 +202,12 @@ public:
     // only for tests!
     void init(Store *store, const float max_memory_ratio, const std::string & auth_key, std::atomic<bool>& exit);
 
-    Option<bool> load(const size_t collection_batch_size, const size_t document_batch_size);
+    Option<bool> load(const size_t collection_batch_size, const size_t document_batch_size,
+                      const std::string& vector_index_dir = "");
+
+    // persists the vector graphs of all collections into `dir_path`, along with a manifest describing them, until
+    // `max_elements` vectors have been written: writes are paused meanwhile, so this bounds the pause
+    Option<bool> save_vector_indices(const std::string& dir_path, size_t max_elements) const;
 
     // frees in-memory data structures when server is shutdown - helps us run a memory leak detector properly
     void dispose();
@@ -35,6 +35,11 @@ bool get_export_documents(const std::shared_ptr<http_req>& req, const std::share
 
 bool post_add_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
+// Indexes the documents of several `post_add_document` requests to the same collection and with the same parameters
+// as one batch, setting the response of each request.
+void post_add_documents_coalesced(const std::vector<std::shared_ptr<http_req>>& reqs,
+                                  const std::vector<std::shared_ptr<http_res>>& ress);
+
 bool patch_update_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
 bool patch_update_documents(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
@@ -192,6 +197,10 @@ Option<std::pair<std::string,std::string>> get_api_key_and_ip(const std::string&
 
 void init_api(uint32_t cache_num_entries);
 
+uint64_t hash_search_request(const std::shared_ptr<http_req>& req);
+
+uint64_t hash_multi_search_request(const std::shared_ptr<http_req>& req);
+
 
 bool post_proxy(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
@@ -11,6 +11,7 @@
 #include "option.h"
 #include "text_embedder.h"
 #include "image_embedder.h"
+#include "query_embedding_cache.h"
 
 struct text_embedding_model {
     std::string model_name;
@@ -48,6 +49,17 @@ public:
     void delete_text_embedder(const std::string& model_path);
     void delete_all_text_embedders();
 
+    // batching and latency stats of the local models
+    nlohmann::json get_inference_stats();
+
+    /// Embeds a search query (with the model's query prefix), going through the query embedding cache.
+    embedding_res_t embed_query(TextEmbedder* embedder, const nlohmann::json& model_config, const std::string& query,
+                                const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries);
+
+    void set_query_embedding_cache_max_bytes(size_t max_bytes);
+
+    nlohmann::json get_query_embedding_cache_stats() const;
+
     void delete_image_embedder(const std::string& model_path);
     void delete_all_image_embedders();
 
@@ -96,6 +108,10 @@ private:
     std::unordered_map<std::string, text_embedding_model> public_models;
     std::mutex text_embedders_mutex, image_embedders_mutex;
 
+    query_embedding_cache_t query_embedding_cache;
+
+    static std::string get_text_embedder_key(const nlohmann::json& model_config);
+
     static Option<std::string> get_namespace(const std::string& model_name);
 };
 
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+/// Dense forward store of the facet ids (hashes) of each document of a single facet field.
+///
+/// `offsets[seq_id]` and `lengths[seq_id]` locate the facet ids of a document within the packed `values` array, in the
+/// order of the field's array elements. Both arrays are indexed directly by seq_id, so looking up the facet ids of a
+/// result is a single random access instead of a skip through compressed posting list blocks.
+///
+/// Updating a document appends its new facet ids and leaves the old ones behind: `values` is compacted once the
+/// unreachable facet ids outnumber the reachable ones.
+class facet_column_t {
+private:
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::vector<uint32_t> values;
+
+    // number of seq_ids that carry facet ids
+    uint32_t num_docs = 0;
+
+    // number of entries of `values` that are no longer referenced by any seq_id
+    size_t num_dead_values = 0;
+
+    // range of the facet ids stored so far (not narrowed on deletion)
+    uint32_t min_facet_id = std::numeric_limits<uint32_t>::max();
+    uint32_t max_facet_id = 0;
+
+    void compact();
+
+public:
+
+    static constexpr uint32_t MIN_CAPACITY = 1024;
+
+    facet_column_t() = default;
+
+    facet_column_t(const facet_column_t&) = delete;
+    facet_column_t& operator=(const facet_column_t&) = delete;
+
+    /// Replaces the facet ids of the seq_id.
+    void upsert(uint32_t seq_id, const std::vector<uint32_t>& facet_ids);
+
+    void erase(uint32_t seq_id);
+
+    [[nodiscard]] inline bool contains(uint32_t seq_id) const {
+        return seq_id < lengths.size() && lengths[seq_id] != 0;
+    }
+
+    /// Points `facet_ids` to the facet ids of the seq_id and returns how many there are (0 when there are none).
+    /// The pointer is invalidated by the next write to the column.
+    inline uint32_t get(uint32_t seq_id, const uint32_t*& facet_ids) const {
+        if(!contains(seq_id)) {
+            return 0;
+        }
+
+        facet_ids = values.data() + offsets[seq_id];
+        return lengths[seq_id];
+    }
+
+    [[nodiscard]] size_t num_ids() const {
+        return num_docs;
+    }
+
+    [[nodiscard]] uint32_t get_min_facet_id() const {
+        return min_facet_id;
+    }
+
+    [[nodiscard]] uint32_t get_max_facet_id() const {
+        return max_facet_id;
+    }
+
+    void clear();
+};
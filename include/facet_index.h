@@ -3,11 +3,15 @@
 #include "ids_t.h"
 #include "tsl/htrie_map.h"
 #include <unordered_set>
+#include <mutex>
 #include <posting_list.h>
+#include "facet_column.h"
 #include <num_tree.h>
 #include <list>
 #include <field.h>
 
+class ThreadPool;
+
 struct facet_value_id_t {
     std::string facet_value;
     uint32_t facet_id = UINT32_MAX;
@@ -81,7 +85,15 @@ private:
         std::map<std::string, facet_id_seq_ids_t> fvalue_seq_ids;
         std::list<facet_count_t> counts;
         std::map<uint32_t, std::list<facet_count_t>::iterator> count_map;
-        posting_list_t* seq_id_hashes = nullptr;
+
+        // count node => (count node, new count) of the counts that changed since `counts` was last ordered:
+        // writes only record the new count here and the next read that walks `counts` moves the nodes
+        std::unordered_map<const facet_count_t*, std::pair<std::list<facet_count_t>::iterator, uint32_t>> pending_counts;
+
+        // reads run concurrently, so the first one to apply the pending counts must exclude the others
+        std::mutex pending_counts_mutex;
+
+        facet_column_t* seq_id_hashes = nullptr;
         spp::sparse_hash_map<uint32_t, int64_t> fhash_to_int64_map;
 
         bool has_value_index = true;
@@ -90,7 +102,7 @@ private:
         facet_doc_ids_list_t() {
             fvalue_seq_ids.clear();
             counts.clear();
-            seq_id_hashes = new posting_list_t(256);
+            seq_id_hashes = new facet_column_t();
         }
 
         facet_doc_ids_list_t(const facet_doc_ids_list_t& other) = delete;
@@ -114,14 +126,42 @@ private:
     // auto incrementing ID that is assigned to each unique facet value string
     std::atomic_uint32_t next_facet_id = 0;
 
+    static void record_count(facet_doc_ids_list_t& facet_index, std::list<facet_count_t>::iterator facet_count_it,
+                             uint32_t new_count);
+
+    static void apply_pending_counts(facet_doc_ids_list_t& facet_index);
+
     void get_stringified_value(const nlohmann::json& value, const field& afield,
                                std::vector<std::string>& values);
 
     void get_stringified_values(const nlohmann::json& document, const field& afield,
                                 std::vector<std::string>& values);
 
+    // cost of counting `result_ids` through a value's id list by merging the two sorted lists
+    static size_t merge_count_cost(size_t num_value_ids, size_t result_ids_len);
+
 public:
 
+    // relative cost of counting one result id through the hash index vs. probing an id in the result bitmap
+    static constexpr size_t HASH_COUNT_COST = 8;
+
+    // once more than 1 in this many values of a large field have changed counts, the count list is re-sorted
+    // instead of moving each of the changed nodes
+    static constexpr size_t PENDING_COUNTS_RESORT_RATIO = 4;
+    static constexpr size_t PENDING_COUNTS_RESORT_MIN_VALUES = 1024;
+
+    // fixed cost of visiting a facet value (lookup of its id list) during `intersect`
+    static constexpr size_t VALUE_VISIT_COST = 16;
+
+    // result ids are materialized as a bitmap only while it needs at most this many 64-bit words per result id
+    static constexpr size_t MAX_RESULT_BITMAP_WORDS_PER_ID = 2;
+
+    // number of values that a task claims at a time when `intersect` walks the values with several tasks
+    static constexpr size_t VALUE_BLOCK_SIZE = 64;
+
+    // a facet is split across tasks only if each of them gets at least this much work (in units of probed ids)
+    static constexpr size_t MIN_FACET_TASK_COST = 64 * 1024;
+
     facet_index_t() = default;
 
     ~facet_index_t();
@@ -139,6 +179,8 @@ public:
 
     size_t get_facet_count(const std::string& field_name);
 
+    /// Counts the result ids of the field's top values. With a `thread_pool`, up to `num_tasks` tasks count the
+    /// values in parallel: the result is the same as that of a single task.
     size_t intersect(facet& a_facet, const field& facet_field,
                      bool has_facet_query,
                      bool estimate_facets,
@@ -147,8 +189,19 @@ public:
                      const std::vector<char>& symbols_to_index, const std::vector<char>& token_separators,
                      const uint32_t* result_ids, size_t result_id_len,
                      size_t max_facet_count, std::map<std::string, docid_count_t>& found,
-                     bool is_wildcard_no_filter_query, const std::string& sort_order = "");
-    
+                     bool is_wildcard_no_filter_query, const std::string& sort_order = "",
+                     ThreadPool* thread_pool = nullptr, size_t num_tasks = 1);
+
+    /// Cost of materializing the result ids as a bitmap, or SIZE_MAX when the ids are too sparse for one.
+    static size_t result_bitmap_cost(const uint32_t* result_ids, size_t result_ids_len);
+
+    /// Estimates whether counting the facet values of `result_ids` through the value index (`intersect`) is cheaper
+    /// than counting the facet hashes of every result id through the hash index. When `value_cost` is given and both
+    /// indices exist, it is set to the estimated cost of `intersect` (in units of probed ids). Only the costs are
+    /// compared: whether `intersect` finds the top values of the results is up to the caller.
+    bool is_value_index_cheaper(const std::string& field_name, const uint32_t* result_ids, size_t result_ids_len,
+                                size_t max_facet_count, size_t total_docs, size_t* value_cost = nullptr);
+
     size_t get_facet_indexes(const std::string& field, 
         std::map<uint32_t, std::vector<uint32_t>>& seqid_countIndexes);
     
@@ -163,7 +216,7 @@ public:
 
     bool has_value_index(const std::string& field_name);
 
-    posting_list_t* get_facet_hash_index(const std::string& field_name);
+    facet_column_t* get_facet_hash_index(const std::string& field_name);
 
     //get fhash=>int64 map for stats
     const spp::sparse_hash_map<uint32_t, int64_t>& get_fhash_int64_map(const std::string& field_name);
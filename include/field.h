@@ -778,6 +778,9 @@ struct facet_info_t {
     bool use_facet_query = false;
     bool should_compute_stats = false;
     bool use_value_index = false;
+    // estimated work of counting the facet (in units of probed ids) and the number of tasks to split it into
+    size_t cost = 0;
+    size_t num_value_tasks = 1;
     field facet_field{"", "", false};
 };
 
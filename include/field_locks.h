@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+struct filter_node_t;
+
+/// Lock stripes that guard the per-field structures of an index (token trees, numerical, sort, facet and vector
+/// indices). A field is guarded by the stripe that its name hashes to.
+///
+/// A batch of writes indexes every field in a task of its own, holding only the stripe of that field exclusively, so
+/// a search waits only for the fields that it reads. Readers lock all of their stripes up front and in stripe order,
+/// while writers never hold more than one stripe at a time: the two can't deadlock.
+class field_locks_t {
+public:
+    static constexpr size_t NUM_STRIPES = 64;
+
+    typedef std::bitset<NUM_STRIPES> stripe_set_t;
+
+    /// Holds a set of stripes in shared mode for its lifetime.
+    class shared_lock_t {
+    private:
+        const field_locks_t& locks;
+        const stripe_set_t stripes;
+
+    public:
+        shared_lock_t(const field_locks_t& locks, const stripe_set_t& stripes);
+
+        shared_lock_t(const shared_lock_t&) = delete;
+        shared_lock_t& operator=(const shared_lock_t&) = delete;
+
+        ~shared_lock_t();
+    };
+
+    field_locks_t() = default;
+
+    field_locks_t(const field_locks_t&) = delete;
+    field_locks_t& operator=(const field_locks_t&) = delete;
+
+    static size_t get_stripe(const std::string& field_name) {
+        return std::hash<std::string>{}(field_name) % NUM_STRIPES;
+    }
+
+    static stripe_set_t all_stripes() {
+        return stripe_set_t().set();
+    }
+
+    static void add_field(const std::string& field_name, stripe_set_t& stripes) {
+        stripes.set(get_stripe(field_name));
+    }
+
+    static stripe_set_t stripes_of(const std::string& field_name) {
+        return stripe_set_t().set(get_stripe(field_name));
+    }
+
+    /// Adds the stripes of the fields read by the filter tree. Returns false when the fields can't be known up front,
+    /// e.g. when the tree joins on another collection.
+    static bool add_filter_fields(const filter_node_t* filter_node, stripe_set_t& stripes);
+
+    std::unique_lock<std::shared_mutex> lock_field(const std::string& field_name) {
+        return std::unique_lock<std::shared_mutex>(stripe_mutexes[get_stripe(field_name)]);
+    }
+
+private:
+    mutable std::array<std::shared_mutex, NUM_STRIPES> stripe_mutexes;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "sorted_array.h"
+
+struct filter_node_t;
+
+/// Identifies a filter subtree in the cache, along with what the subtree's result depends on.
+struct filter_cache_key_t {
+    /// Canonical form of the subtree: operands of AND/OR are ordered, so `a && b` and `b && a` share an entry.
+    std::string key;
+
+    /// Fields that are filtered on anywhere in the subtree.
+    std::vector<std::string> fields;
+
+    /// Set when the result depends on the full set of documents (e.g. `!=` filters match documents that don't have
+    /// the field at all), so that every newly indexed document can change it.
+    bool depends_on_all_ids = false;
+
+    /// Builds the key of the subtree. Returns false if the subtree cannot be cached, e.g. when it joins on another
+    /// collection whose writes are not tracked by this index.
+    static bool build(const filter_node_t* filter_node, filter_cache_key_t& cache_key);
+};
+
+/// Caches the ids matched by filter subtrees of an index, so that filters repeated across queries (tenant or
+/// visibility filters) are not evaluated against the posting lists and numeric trees every time.
+///
+/// The cache is bounded by the bytes that its entries take up, and a single entry can only take up a small share of
+/// them, so that a few huge id lists cannot push out the small entries that are used all the time.
+///
+/// Entries are kept up to date incrementally:
+/// - deleted documents are recorded and dropped from an entry's ids when the entry is next looked up
+/// - inserts and updates evict only the entries that filter on one of the written fields (plus the ones that depend
+///   on the full set of documents when new documents are added)
+class filter_result_cache_t {
+private:
+    struct entry_t {
+        sorted_array ids;
+        std::vector<std::string> fields;
+        bool depends_on_all_ids = false;
+
+        // number of entries of `deleted_ids` that have been removed from `ids`
+        size_t num_deletes_applied = 0;
+
+        size_t num_bytes = 0;
+
+        std::list<std::string>::iterator lru_it;
+    };
+
+    mutable std::mutex mutex;
+
+    std::unordered_map<std::string, std::unique_ptr<entry_t>> entries;
+
+    // most recently used key is at the front
+    std::list<std::string> lru;
+
+    // seq_ids deleted since the entries were last caught up
+    std::vector<uint32_t> deleted_ids;
+
+    const size_t max_bytes;
+    size_t num_bytes = 0;
+
+    static size_t get_entry_bytes(const std::string& key, entry_t& entry);
+
+    void erase(std::unordered_map<std::string, std::unique_ptr<entry_t>>::iterator it);
+
+    void apply_deletes(entry_t& entry);
+
+public:
+
+    static constexpr size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+    // an entry can take up at most 1 / MAX_ENTRY_SHARE of the cache
+    static constexpr size_t MAX_ENTRY_SHARE = 8;
+
+    // subtrees below the root of a filter are only cached when they match at least this many ids: smaller ones are
+    // cheap to compute again, and are often one-off parts of compound filters
+    static constexpr uint32_t MIN_SUBTREE_IDS = 4096;
+
+    // deletes are applied to every entry and forgotten once this many of them are pending
+    static constexpr size_t MAX_PENDING_DELETES = 16 * 1024;
+
+    explicit filter_result_cache_t(size_t max_bytes = DEFAULT_MAX_BYTES);
+
+    /// On a hit, `ids` is set to a newly allocated array holding the cached ids.
+    bool find(const std::string& key, uint32_t*& ids, uint32_t& ids_length);
+
+    void insert(const filter_cache_key_t& cache_key, const uint32_t* ids, uint32_t ids_length);
+
+    /// Called when a document is deleted from the index.
+    void remove_id(uint32_t seq_id);
+
+    /// Called after documents have been indexed, with the names of the fields that were written.
+    void invalidate(const std::unordered_set<std::string>& written_fields, bool ids_added);
+
+    void clear();
+
+    size_t size() const;
+
+    size_t get_num_bytes() const;
+};
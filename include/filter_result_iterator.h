@@ -9,6 +9,7 @@
 #include "option.h"
 #include "posting_list.h"
 #include "id_list.h"
+#include "filter_result_cache.h"
 
 class Index;
 struct filter_node_t;
@@ -265,6 +266,13 @@ private:
 
     bool delete_filter_node = false;
 
+    /// Key of the filter subtree in the index's filter cache. The key is empty when the subtree cannot be cached.
+    filter_cache_key_t cache_key;
+    bool is_filter_result_cached = false;
+
+    /// Set for the nodes below the root of the filter tree, which are only cached when they are costly to compute.
+    bool is_subtree = false;
+
     std::unique_ptr<filter_result_iterator_timeout_info> timeout_info;
 
     /// Initializes the state of iterator node after it's creation.
@@ -286,8 +294,22 @@ private:
     /// Finds the next match for a filter on string field.
     void get_string_filter_next_match(const bool& field_is_array);
 
+    /// Initializes the node with the ids of an identical filter subtree that was computed earlier. Returns false if
+    /// there is no such subtree in the cache.
+    bool init_from_cache();
+
+    /// Adds the computed ids of the node to the index's filter cache.
+    void cache_filter_result();
+
     explicit filter_result_iterator_t(uint32_t approx_filter_ids_length);
 
+    /// Creates the node of a subtree of the filter tree, below `parent`.
+    filter_result_iterator_t(const std::string& collection_name, Index const* const index,
+                             filter_node_t const* const filter_node, const filter_result_iterator_t* parent);
+
+    /// Builds the iterator tree below the node and initializes it.
+    void init_tree();
+
     /// Collects n doc ids while advancing the iterator. The iterator may become invalid during this operation.
     /// **The references are moved from filter_result_iterator_t.
     void get_n_ids(const uint32_t& n, filter_result_t*& result, const bool& override_timeout = false);
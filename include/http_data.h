@@ -177,6 +177,9 @@ struct cached_res_t {
     uint32_t ttl;
     uint64_t hash;
 
+    // query of the request that produced the response: equivalent queries share the cached response
+    std::string raw_query;
+
     bool operator == (const cached_res_t& res) const {
         return hash == res.hash;
     }
@@ -414,7 +417,7 @@ struct http_req {
             // Serialized request from an older version (v0.21 and below) which serializes import data differently.
             body = content["body"];
         } else {
-            body += content["body"];
+            body += content["body"].get_ref<const std::string&>();
         }
 
         for (nlohmann::json::iterator it = content["params"].begin(); it != content["params"].end(); ++it) {
@@ -161,6 +161,10 @@ public:
 
     size_t intersect_count(const uint32_t* res_ids, size_t res_ids_len,
                            bool estimate_facets, size_t facet_sample_interval);
+
+    // counts the ids that are set in `res_bitmap` (bit `id` set for every result id <= `max_res_id`)
+    size_t intersect_count(const uint64_t* res_bitmap, uint32_t max_res_id,
+                           bool estimate_facets, size_t facet_sample_interval);
 };
 
 template<class T>
@@ -36,6 +36,8 @@ struct compact_id_list_t {
     [[nodiscard]] uint32_t num_ids() const;
 
     size_t intersect_count(const uint32_t* res_ids, size_t res_ids_len);
+
+    size_t intersect_count(const uint64_t* res_bitmap, uint32_t max_res_id);
 };
 
 class ids_t {
@@ -101,6 +103,10 @@ public:
     static size_t intersect_count(void*& obj, const uint32_t* result_ids, size_t result_ids_len,
                                   bool estimate_facets = false, size_t facet_sample_mod_value = 1);
 
+    /// Same as above, but against a result set materialized as a bitmap (see `facet_index_t::intersect`).
+    static size_t intersect_count(void*& obj, const uint64_t* result_bitmap, uint32_t max_result_id,
+                                  bool estimate_facets = false, size_t facet_sample_mod_value = 1);
+
     static void to_expanded_id_lists(const std::vector<void*>& raw_id_lists, std::vector<id_list_t*>& id_lists,
                                      std::vector<id_list_t*>& expanded_id_lists);
 
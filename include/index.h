@@ -6,6 +6,7 @@
 #include <mutex>
 #include <shared_mutex>
 #include <condition_variable>
+#include <queue>
 #include <art.h>
 #include <number.h>
 #include <sparsepp.h>
@@ -29,9 +30,14 @@
 #include "override.h"
 #include "vector_query_ops.h"
 #include "hnswlib/hnswlib.h"
+#include "quantized_vectors.h"
 #include "filter.h"
 #include "facet_index.h"
 #include "numeric_range_trie.h"
+#include "sort_column.h"
+#include "filter_result_cache.h"
+#include "field_locks.h"
+#include "trigram_index.h"
 
 static constexpr size_t ARRAY_FACET_DIM = 4;
 using facet_map_t = spp::sparse_hash_map<uint32_t, facet_hash_values_t>;
@@ -40,7 +46,7 @@ using array_mapped_facet_t = std::array<facet_map_t*, ARRAY_FACET_DIM>;
 using array_mapped_single_val_facet_t = std::array<single_val_facet_map_t*, ARRAY_FACET_DIM>;
 
 static constexpr size_t ARRAY_INFIX_DIM = 4;
-using array_mapped_infix_t = std::vector<tsl::htrie_set<char>*>;
+using array_mapped_infix_t = std::vector<trigram_index_t*>;
 
 struct token_t {
     size_t position;
@@ -258,9 +264,10 @@ struct index_record {
 
     DIRTY_VALUES dirty_values;
 
-    index_record(size_t record_pos, uint32_t seq_id, const nlohmann::json& doc, index_operation_t operation,
+    // `doc` is taken by value, so that a freshly parsed document can be moved in instead of being copied
+    index_record(size_t record_pos, uint32_t seq_id, nlohmann::json doc, index_operation_t operation,
                  const DIRTY_VALUES& dirty_values):
-            position(record_pos), seq_id(seq_id), doc(doc), operation(operation), is_update(false),
+            position(record_pos), seq_id(seq_id), doc(std::move(doc)), operation(operation), is_update(false),
             indexed(false), dirty_values(dirty_values) {
 
     }
@@ -309,28 +316,253 @@ public:
     }
 };
 
+/// Checks the ids visited by a graph search against the materialized filter ids, instead of seeking the filter
+/// iterator for each of them. Ids that are dense enough are looked up in a bitset that spans just their range, sparse
+/// ones (e.g. a few ids spread over the large seq_ids of a collection with churn) by binary search.
+class VectorFilterIdsFunctor: public hnswlib::BaseFilterFunctor {
+    // must outlive the functor
+    const uint32_t* const ids;
+    const uint32_t ids_length;
+
+    uint32_t min_id = 0;
+    std::vector<uint64_t> bits;
+
+public:
+
+    // `ids` must be sorted
+    VectorFilterIdsFunctor(const uint32_t* ids, const uint32_t ids_length): ids(ids), ids_length(ids_length) {
+        if(ids_length == 0) {
+            return ;
+        }
+
+        min_id = ids[0];
+        const size_t num_words = (ids[ids_length - 1] - min_id) / 64 + 1;
+
+        // a bitset is used while it takes no more than a word per id
+        if(num_words > ids_length) {
+            return ;
+        }
+
+        bits.resize(num_words, 0);
+        for(uint32_t i = 0; i < ids_length; i++) {
+            const uint32_t offset = ids[i] - min_id;
+            bits[offset / 64] |= (uint64_t(1) << (offset % 64));
+        }
+    }
+
+    bool operator()(hnswlib::labeltype id) override {
+        if(bits.empty()) {
+            return std::binary_search(ids, ids + ids_length, id);
+        }
+
+        if(id < min_id) {
+            return false;
+        }
+
+        const hnswlib::labeltype offset = id - min_id;
+        return offset / 64 < bits.size() && ((bits[offset / 64] >> (offset % 64)) & 1) != 0;
+    }
+};
+
+/// How a vector search with a filter is run, see `Index::plan_filtered_vector_search()`.
+struct vector_search_plan_t {
+    enum strategy_t {
+        // exact distances to each of the filtered ids
+        flat,
+        // graph search that checks the materialized filter ids
+        ids_filtered_hnsw,
+        // graph search that checks the ids against the filter iterator: used for filters that match most documents,
+        // since materializing them would cost more than the search
+        iterator_filtered_hnsw
+    };
+
+    strategy_t strategy = iterator_filtered_hnsw;
+
+    // widened to make up for the neighbours that the filter rejects
+    size_t ef = 0;
+};
+
 struct hnsw_index_t {
+    // float vectors, for exact distances
     hnswlib::InnerProductSpace* space;
+
+    // vectors held by the graph: `space` itself, or int8 codes when the field is quantized
+    hnswlib::SpaceInterface<float>* graph_space;
+
     hnswlib::HierarchicalNSW<float>* vecdex;
     size_t num_dim;
     vector_distance_type_t distance_type;
 
+    // set when the graph is quantized: it only holds the codes, so the vectors are kept here to rerank and read them
+    half_vector_store_t* rerank_store = nullptr;
+
     // ensures that this index is not dropped when it's being repaired
     std::mutex repair_m;
 
-    hnsw_index_t(size_t num_dim, size_t init_size, vector_distance_type_t distance_type, size_t M = 16, size_t ef_construction = 200) :
+    // when the graph is restored from a snapshot, it already contains the vectors of all documents below this seq_id
+    uint32_t restored_seq_id_watermark = 0;
+
+    // a quantized graph is searched for this many times the requested neighbours, which are then reranked
+    static constexpr size_t RERANK_OVERSAMPLING = 4;
+
+    hnsw_index_t(size_t num_dim, size_t init_size, vector_distance_type_t distance_type, size_t M = 16,
+                 size_t ef_construction = 200, bool int8_quantized = false) :
         space(new hnswlib::InnerProductSpace(num_dim)),
-        vecdex(new hnswlib::HierarchicalNSW<float>(space, init_size, M, ef_construction, 100, true)),
-        num_dim(num_dim), distance_type(distance_type) {
+        graph_space(int8_quantized ? static_cast<hnswlib::SpaceInterface<float>*>(new Int8InnerProductSpace(num_dim)) :
+                                     space),
+        vecdex(new hnswlib::HierarchicalNSW<float>(graph_space, init_size, M, ef_construction, 100, true)),
+        num_dim(num_dim), distance_type(distance_type),
+        rerank_store(int8_quantized ? new half_vector_store_t(num_dim) : nullptr) {
 
     }
 
     ~hnsw_index_t() {
         std::lock_guard lk(repair_m);
         delete vecdex;
+        delete rerank_store;
+        if(graph_space != space) {
+            delete graph_space;
+        }
         delete space;
     }
 
+    static bool is_int8_quantized(const nlohmann::json& hnsw_params) {
+        return hnsw_params.count("quantization") != 0 && hnsw_params["quantization"] == "int8";
+    }
+
+    void save(const std::string& file_path) {
+        vecdex->saveIndex(file_path);
+        if(rerank_store != nullptr) {
+            rerank_store->save(file_path + ".f16");
+        }
+    }
+
+    // replaces the current graph with the one persisted at `file_path`, throws on a corrupt or missing file
+    void load(const std::string& file_path, uint32_t seq_id_watermark) {
+        std::unique_ptr<half_vector_store_t> loaded_store;
+        if(rerank_store != nullptr) {
+            loaded_store = std::make_unique<half_vector_store_t>(num_dim);
+            loaded_store->load(file_path + ".f16");
+        }
+
+        auto loaded_vecdex = new hnswlib::HierarchicalNSW<float>(graph_space, file_path, false, 0, true);
+        delete vecdex;
+        vecdex = loaded_vecdex;
+
+        if(loaded_store) {
+            delete rerank_store;
+            rerank_store = loaded_store.release();
+        }
+
+        restored_seq_id_watermark = seq_id_watermark;
+    }
+
+    // adds or replaces the vector of `seq_id`, which must already be normalized for cosine distance
+    void add_point(const float* values, uint32_t seq_id) {
+        if(rerank_store == nullptr) {
+            vecdex->addPoint(values, seq_id, true);
+            return ;
+        }
+
+        std::vector<char> codes(graph_space->get_data_size());
+        Int8InnerProductSpace::quantize(values, num_dim, codes.data());
+
+        rerank_store->upsert(seq_id, values);
+        vecdex->addPoint(codes.data(), seq_id, true);
+    }
+
+    void mark_delete(uint32_t seq_id) {
+        vecdex->markDelete(seq_id);
+        if(rerank_store != nullptr) {
+            rerank_store->erase(seq_id);
+        }
+    }
+
+    // throws when `seq_id` has no vector
+    std::vector<float> get_vector(uint32_t seq_id) {
+        if(rerank_store == nullptr) {
+            return vecdex->getDataByLabel<float>(seq_id);
+        }
+
+        std::vector<float> values;
+        if(!rerank_store->get(seq_id, values)) {
+            throw std::runtime_error("Label not found");
+        }
+
+        return values;
+    }
+
+    // nearest neighbours of `query` (normalized for cosine distance), closest first
+    std::vector<std::pair<float, size_t>> search_knn(const float* query, size_t k, size_t ef,
+                                                     hnswlib::BaseFilterFunctor* filter) {
+        if(rerank_store == nullptr) {
+            return vecdex->searchKnnCloserFirst(query, k, ef, filter);
+        }
+
+        std::vector<char> query_codes(graph_space->get_data_size());
+        Int8InnerProductSpace::quantize(query, num_dim, query_codes.data());
+
+        auto candidates = vecdex->searchKnnCloserFirst(query_codes.data(), k * RERANK_OVERSAMPLING,
+                                                       std::max(ef, k * RERANK_OVERSAMPLING), filter);
+
+        std::vector<float> values;
+        for(auto& candidate: candidates) {
+            if(rerank_store->get(candidate.second, values)) {
+                candidate.first = space->get_dist_func()(query, values.data(), &num_dim);
+            }
+        }
+
+        std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+
+        if(candidates.size() > k) {
+            candidates.resize(k);
+        }
+
+        return candidates;
+    }
+
+    // exact nearest neighbours of `query` among `ids`, closest first
+    std::vector<std::pair<float, size_t>> flat_search_knn(const float* query, const uint32_t* ids, size_t ids_length,
+                                                          size_t k) {
+        if(k == 0) {
+            return {};
+        }
+
+        // max heap of the closest vectors found so far
+        std::priority_queue<std::pair<float, size_t>> closest;
+        const auto dist_func = space->get_dist_func();
+
+        for(size_t i = 0; i < ids_length; i++) {
+            std::vector<float> values;
+
+            try {
+                values = get_vector(ids[i]);
+            } catch(...) {
+                // document has no vector
+                continue;
+            }
+
+            const float dist = dist_func(query, values.data(), &num_dim);
+
+            if(closest.size() < k) {
+                closest.emplace(dist, ids[i]);
+            } else if(dist < closest.top().first) {
+                closest.pop();
+                closest.emplace(dist, ids[i]);
+            }
+        }
+
+        std::vector<std::pair<float, size_t>> results(closest.size());
+        for(size_t i = results.size(); i > 0; i--) {
+            results[i - 1] = closest.top();
+            closest.pop();
+        }
+
+        return results;
+    }
+
     // needed for cosine similarity
     static void normalize_vector(const std::vector<float>& src, std::vector<float>& norm_dest) {
         float norm = 0.0f;
@@ -346,8 +578,7 @@ struct hnsw_index_t {
 
 struct group_by_field_it_t {
     std::string field_name;
-    posting_list_t::iterator_t it;
-    bool is_array;
+    const facet_column_t* column;
 };
 
 struct Hasher32 {
@@ -365,8 +596,15 @@ struct pair_hash {
 
 class Index {
 private:
+    // Held exclusively by writes that change the schema or replace whole structures (e.g. loading an image).
+    // Indexing a batch and removing a document hold it shared along with `write_mutex`: the per-field structures that
+    // they write are guarded by `field_locks` instead, so that searches only wait for the fields they read.
     mutable std::shared_mutex mutex;
 
+    std::mutex write_mutex;
+
+    mutable field_locks_t field_locks;
+
     std::string name;
 
     const uint32_t collection_id;
@@ -402,10 +640,9 @@ private:
 
     facet_index_t* facet_index_v4 = nullptr;
   
-    // sort_field => (seq_id => value)
-    spp::sparse_hash_map<std::string, spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*> sort_index;
-    typedef spp::sparse_hash_map<std::string, 
-        spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*>::iterator sort_index_iterator;
+    // sort_field => (seq_id => value), stored column-wise and indexed directly by seq_id
+    spp::sparse_hash_map<std::string, sort_column_t*> sort_index;
+    typedef spp::sparse_hash_map<std::string, sort_column_t*>::iterator sort_index_iterator;
 
     // str_sort_field => adi_tree_t
     spp::sparse_hash_map<std::string, adi_tree_t*> str_sort_index;
@@ -419,6 +656,9 @@ private:
     // this is used for wildcard queries
     id_list_t* seq_ids;
 
+    // ids matched by recently used filter subtrees
+    mutable filter_result_cache_t filter_cache;
+
     std::vector<char> symbols_to_index;
 
     std::vector<char> token_separators;
@@ -427,16 +667,18 @@ private:
 
     // used as sentinels
 
-    static spp::sparse_hash_map<uint32_t, int64_t, Hasher32> text_match_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t, Hasher32> seq_id_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t, Hasher32> eval_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t, Hasher32> geo_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t, Hasher32> str_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t, Hasher32> vector_distance_sentinel_value;
-    static spp::sparse_hash_map<uint32_t, int64_t, Hasher32> vector_query_sentinel_value;
+    static sort_column_t text_match_sentinel_value;
+    static sort_column_t seq_id_sentinel_value;
+    static sort_column_t eval_sentinel_value;
+    static sort_column_t geo_sentinel_value;
+    static sort_column_t str_sentinel_value;
+    static sort_column_t vector_distance_sentinel_value;
+    static sort_column_t vector_query_sentinel_value;
 
     // Internal utility functions
 
+    static uint8_t get_sort_column_width(const field& a_field);
+
     static inline uint32_t next_suggestion2(const std::vector<tok_candidates>& token_candidates_vec,
                                             long long int n,
                                             std::vector<token_t>& query_suggestion,
@@ -506,7 +748,7 @@ private:
                                        const size_t max_candidates,
                                        int syn_orig_num_tokens,
                                        const int* sort_order,
-                                       std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values,
+                                       std::array<sort_column_t*, 3>& field_values,
                                        const std::vector<size_t>& geopoint_indices,
                                        std::set<uint64>& query_hashes,
                                        std::vector<uint32_t>& id_buff, const std::string& collection_name = "") const;
@@ -540,6 +782,21 @@ private:
 
     static void compute_facet_stats(facet &a_facet, const int64_t raw_value, const std::string & field_type);
 
+    /// Computes the stats of a facet in one go from the values of all results, as stored in the field's sort column.
+    static void compute_facet_stats(facet &a_facet, const std::vector<int64_t>& sort_values, const field& facet_field);
+
+    // adds the stripes of the sort fields, returns false if sorting can read fields that are not known up front
+    static bool add_sort_stripes(const std::vector<sort_by>& sort_fields_std, field_locks_t::stripe_set_t& stripes);
+
+    // stripes of every field that a search reads
+    static field_locks_t::stripe_set_t get_search_stripes(const std::vector<search_field_t>& the_fields,
+                                                          const filter_node_t* filter_tree_root,
+                                                          const std::vector<facet>& facets,
+                                                          const std::vector<sort_by>& sort_fields_std,
+                                                          const std::vector<std::string>& group_by_fields,
+                                                          const vector_query_t& vector_query,
+                                                          const std::string& default_sorting_field);
+
     static void handle_doc_ops(const tsl::htrie_map<char, field>& search_schema,
                                nlohmann::json& update_doc, const nlohmann::json& old_doc);
 
@@ -554,7 +811,7 @@ private:
 
     void initialize_facet_indexes(const field& facet_field);
 
-    std::vector<group_by_field_it_t> get_group_by_field_iterators(const std::vector<std::string>&, bool is_reverse=false) const;
+    std::vector<group_by_field_it_t> get_group_by_field_iterators(const std::vector<std::string>&) const;
 
     static void batch_embed_fields(std::vector<index_record*>& documents,
                                    const tsl::htrie_map<char, field>& embedding_fields,
@@ -581,6 +838,19 @@ public:
     // in the query that have the least individual hits one by one until enough results are found.
     static const int DROP_TOKENS_THRESHOLD = 1;
 
+    // records of a batch are validated and preprocessed in parallel tasks of at least this many records each
+    static constexpr size_t MIN_RECORDS_PER_PREPROCESS_TASK = 16;
+
+    // token postings of a text field are written in slices of about this many documents, releasing the field's lock
+    // in between so that searches on the field are not held up for a whole batch
+    static constexpr size_t MAX_POSTINGS_PER_WRITE_SLICE = 4096;
+
+    // a vector search filter that matches at least this share of the vectors is not materialized
+    static constexpr double BROAD_VECTOR_FILTER_SELECTIVITY = 0.5;
+
+    // distances that a graph search computes per entry of its candidate list (about the links of a node on layer 0)
+    static constexpr size_t HNSW_DISTANCES_PER_EF = 32;
+
     Index() = delete;
 
     Index(const std::string& name,
@@ -607,12 +877,25 @@ public:
                            int syn_orig_num_tokens,
                            const std::vector<posting_list_t::iterator_t>& posting_lists) const;
 
+    /// Upper bound of the match score that score_results2() can compute for a field in which `num_field_tokens` of
+    /// the query tokens are present. `min_position` is the smallest token position recorded in the posting list
+    /// blocks that hold the document (see posting_list_t::block_t::min_position).
+    static uint64_t field_match_score_upper_bound(size_t num_field_tokens, size_t num_query_tokens,
+                                                  int syn_orig_num_tokens, uint32_t total_cost,
+                                                  uint32_t min_position, bool prioritize_exact_match,
+                                                  bool single_exact_query_token, bool prioritize_token_position);
+
+    /// Packs the components of a multi-field text match into the final 64-bit text match score.
+    static uint64_t aggregate_text_match_score(text_match_type_t match_type, size_t query_len,
+                                               int64_t best_field_match_score, int64_t best_field_weight,
+                                               size_t num_matching_fields);
+
     void score_results(const std::vector<sort_by> &sort_fields, const uint16_t &query_index, const uint8_t &field_id,
                        bool field_is_array, const uint32_t total_cost,
                        Topster *topster, const std::vector<art_leaf *> &query_suggestion,
                        spp::sparse_hash_map<uint64_t, uint32_t>& groups_processed,
                        const uint32_t seq_id, const int sort_order[3],
-                       std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values,
+                       std::array<sort_column_t*, 3> field_values,
                        const std::vector<size_t>& geopoint_indices,
                        const size_t group_limit,
                        const std::vector<std::string> &group_by_fields,
@@ -629,6 +912,8 @@ public:
 
     const spp::sparse_hash_map<std::string, num_tree_t*>& _get_numerical_index() const;
 
+    const filter_result_cache_t& _get_filter_cache() const;
+
     const spp::sparse_hash_map<std::string, NumericTrie*>& _get_range_index() const;
 
     const spp::sparse_hash_map<std::string, array_mapped_infix_t>& _get_infix_index() const;
@@ -644,9 +929,24 @@ public:
 
     static float int64_t_to_float(int64_t n);
 
-    void get_distinct_id(posting_list_t::iterator_t& facet_index_it, const uint32_t seq_id,
-                         const bool is_array, const bool group_missing_values, uint64_t& distinct_id,
-                         bool is_reverse=false) const;
+    /// Chooses how to search the nearest `k` of `num_vectors` vectors that pass a filter matching (at most)
+    /// `num_filter_ids` of them. A graph search has to visit about `1 / selectivity` candidates for each one that
+    /// passes the filter, so its `ef` is widened accordingly, and it is skipped for exact distances when those would
+    /// take fewer distance computations.
+    static vector_search_plan_t plan_filtered_vector_search(size_t num_filter_ids, size_t num_vectors, size_t k,
+                                                            size_t ef);
+
+    /// Nearest neighbours of `query` among the ids matched by `filter_result_iterator` (minus `excluded_ids`), closest
+    /// first, searched the way `plan_filtered_vector_search()` picks.
+    static std::vector<std::pair<float, size_t>> search_filtered_vectors(hnsw_index_t* field_vector_index,
+                                                                         const float* query, size_t k, size_t ef,
+                                                                         filter_result_iterator_t* filter_result_iterator,
+                                                                         const uint32_t* excluded_ids,
+                                                                         size_t excluded_ids_length,
+                                                                         bool& search_cutoff);
+
+    void get_distinct_id(const facet_column_t* facet_column, const uint32_t seq_id,
+                         const bool group_missing_values, uint64_t& distinct_id) const;
 
     static void compute_token_offsets_facets(index_record& record,
                                              const tsl::htrie_map<char, field>& search_schema,
@@ -727,6 +1027,8 @@ public:
                                      const bool use_addition_fields = false,
                                      const tsl::htrie_map<char, field>& addition_fields = tsl::htrie_map<char, field>());
 
+    /// Locks the field itself: the tokens and facet values of text fields are gathered from the batch before the
+    /// field's lock is taken.
     void index_field_in_memory(const field& afield, std::vector<index_record>& iter_batch);
 
     template<class T>
@@ -770,7 +1072,7 @@ public:
                                  filter_result_iterator_t* const filter_result_iterator,
                                  const size_t concurrency,
                                  const int* sort_order,
-                                 std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values,
+                                 std::array<sort_column_t*, 3>& field_values,
                                  const std::vector<size_t>& geopoint_indices,
                                  const std::string& collection_name = "") const;
 
@@ -783,11 +1085,11 @@ public:
 
     void populate_sort_mapping(int* sort_order, std::vector<size_t>& geopoint_indices,
                                std::vector<sort_by>& sort_fields_std,
-                               std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values) const;
+                               std::array<sort_column_t*, 3>& field_values) const;
 
     void populate_sort_mapping_with_lock(int* sort_order, std::vector<size_t>& geopoint_indices,
                                          std::vector<sort_by>& sort_fields_std,
-                                         std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values) const;
+                                         std::array<sort_column_t*, 3>& field_values) const;
 
     int64_t reference_string_sort_score(const std::string& field_name, const uint32_t& seq_id) const;
 
@@ -798,7 +1100,7 @@ public:
                              uint32_t* all_result_ids, const size_t& all_result_ids_len,
                              const std::vector<std::string>& group_by_fields,
                              size_t group_limit, bool is_wildcard_no_filter_query,
-                             size_t max_candidates,
+                             size_t max_candidates, size_t max_facet_count,
                              std::vector<facet_info_t>& facet_infos, facet_index_type_t facet_index_type
                              ) const;
 
@@ -821,7 +1123,7 @@ public:
                                  const size_t max_extra_suffix, const std::vector<token_t>& query_tokens, Topster* actual_topster,
                                  filter_result_iterator_t* const filter_result_iterator,
                                  const int sort_order[3],
-                                 std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values,
+                                 std::array<sort_column_t*, 3> field_values,
                                  const std::vector<size_t>& geopoint_indices,
                                  const std::vector<uint32_t>& curated_ids_sorted,
                                  const std::unordered_set<uint32_t>& excluded_group_ids,
@@ -857,7 +1159,7 @@ public:
                                                  filter_result_iterator_t* const filter_result_iterator,
                                                  std::set<uint64>& query_hashes,
                                                  const int* sort_order,
-                                                 std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values,
+                                                 std::array<sort_column_t*, 3>& field_values,
                                                  const std::vector<size_t>& geopoint_indices,
                                                  tsl::htrie_map<char, token_leaf>& qtoken_set,
                                                  const std::string& collection_name = "") const;
@@ -870,7 +1172,7 @@ public:
                                   const bool group_missing_values,
                                   Topster* actual_topster,
                                   const int sort_order[3],
-                                  std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values,
+                                  std::array<sort_column_t*, 3> field_values,
                                   const std::vector<size_t>& geopoint_indices,
                                   const std::vector<uint32_t>& curated_ids_sorted,
                                   filter_result_iterator_t*& filter_result_iterator,
@@ -913,7 +1215,7 @@ public:
                                                    size_t min_len_2typo,
                                                    int syn_orig_num_tokens,
                                                    const int* sort_order,
-                                                   std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values,
+                                                   std::array<sort_column_t*, 3>& field_values,
                                                    const std::vector<size_t>& geopoint_indices,
                                                    const std::string& collection_name = "",
                                                    bool enable_typos_for_numerical_tokens = true) const;
@@ -946,6 +1248,7 @@ public:
                                       bool prioritize_exact_match,
                                       const bool search_all_candidates,
                                       const bool prioritize_num_matching_fields,
+                                      const bool exhaustive_search,
                                       filter_result_iterator_t* const filter_result_iterator,
                                       const uint32_t total_cost,
                                       const int syn_orig_num_tokens,
@@ -953,7 +1256,7 @@ public:
                                       size_t exclude_token_ids_size,
                                       const std::unordered_set<uint32_t>& excluded_group_ids,
                                       const int* sort_order,
-                                      std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values,
+                                      std::array<sort_column_t*, 3>& field_values,
                                       const std::vector<size_t>& geopoint_indices,
                                       std::vector<uint32_t>& id_buff,
                                       uint32_t*& all_result_ids, size_t& all_result_ids_len,
@@ -990,7 +1293,7 @@ public:
                                   bool enable_typos_for_numerical_tokens) const;
 
     Option<bool> compute_sort_scores(const std::vector<sort_by>& sort_fields, const int* sort_order,
-                                     std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values,
+                                     std::array<sort_column_t*, 3> field_values,
                                      const std::vector<size_t>& geopoint_indices, uint32_t seq_id,
                                      const std::map<basic_string<char>, reference_filter_result_t>& references,
                                      std::vector<uint32_t>& filter_indexes,
@@ -1031,6 +1334,18 @@ public:
 
     void repair_hnsw_index();
 
+    /// Writes the HNSW graph of the vector field to `file_path` when it holds at most `max_elements` vectors, which
+    /// are then deducted from `max_elements`. Returns false without writing anything for a larger graph.
+    Option<bool> save_vector_index(const std::string& field_name, const std::string& file_path,
+                                   size_t& max_elements) const;
+
+    /// Replaces the HNSW graph of the vector field with the one persisted at `file_path`. Documents below
+    /// `seq_id_watermark` will not be re-inserted into the graph until `clear_restored_vector_watermarks()` is called.
+    Option<bool> load_vector_index(const std::string& field_name, const std::string& file_path,
+                                   uint32_t seq_id_watermark);
+
+    void clear_restored_vector_watermarks();
+
     void aggregate_facet(const size_t group_limit, facet& this_facet, facet& acc_facet) const;
 };
 
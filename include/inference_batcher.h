@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "json.hpp"
+#include "text_embedder_tokenizer.h"
+#include "text_embedder_remote.h"
+
+// Queues the encoded inputs of the concurrent callers of a local model, so that they are run together in batches of
+// inputs of similar length. Callers run batches themselves while they wait for their own inputs.
+class inference_batcher_t {
+public:
+    // An input waiting in the queue to be run as part of a batch.
+    struct inference_t {
+        encoded_input_t encoded_input;
+        embedding_res_t result;
+        uint64_t enqueued_us = 0;
+        bool in_batch = false;
+
+        // inputs of the same caller that have no result yet
+        size_t* num_pending = nullptr;
+    };
+
+    // Runs the model on a batch and sets the result of every input in it, including the ones that fail. The inputs
+    // can belong to other callers, so errors must be handed to each of them instead of being thrown.
+    typedef std::function<void(const std::vector<inference_t*>& batch)> run_batch_t;
+
+    // a batch is filled with inputs of similar length until its padded length reaches this many tokens
+    static constexpr size_t MAX_BATCH_TOKENS = 4096;
+    static constexpr size_t MAX_BATCH_SIZE = 64;
+
+    inference_batcher_t(run_batch_t run_batch, size_t max_parallel_batches);
+
+    // Queues the inputs along with the ones of other callers and returns their results, in the same order, once all
+    // of them have been run.
+    std::vector<embedding_res_t> infer(std::vector<encoded_input_t>&& encoded_inputs);
+
+    // Queue wait and run time of the batches.
+    nlohmann::json get_stats() const;
+
+private:
+    run_batch_t run_batch;
+    const size_t max_parallel_batches;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<inference_t*> pending_inferences;  // oldest first
+    size_t num_running_batches = 0;
+
+    std::atomic<uint64_t> num_batches = 0;
+    std::atomic<uint64_t> num_inputs = 0;
+    std::atomic<uint64_t> queue_wait_us = 0;
+    std::atomic<uint64_t> run_us = 0;
+
+    std::vector<inference_t*> take_batch();
+};
@@ -59,6 +59,10 @@ public:
         // link to next block
         block_t* next = nullptr;
 
+        // Smallest non-zero offset of any document in this block, i.e. the earliest token position. It is lowered on
+        // upsert but never raised on erase, so it is a conservative block-level bound used for score pruning.
+        uint32_t min_position = UINT32_MAX;
+
         bool contains(uint32_t id);
 
         void remove_and_shift_offset_index(const uint32_t* indices_sorted, uint32_t num_indices);
@@ -111,6 +115,10 @@ public:
         [[nodiscard]] inline block_t* block() const;
         [[nodiscard]] uint32_t get_field_id() const;
 
+        [[nodiscard]] uint32_t block_min_position() const {
+            return curr_block->min_position;
+        }
+
         posting_list_t::iterator_t clone() const;
     };
 
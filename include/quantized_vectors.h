@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include "hnswlib/hnswlib.h"
+#include "sparsepp.h"
+
+/// Space of int8 quantized vectors for the hnsw graph: each vector is stored as a float scale followed by one signed
+/// byte per dimension, so the graph holds a quarter of the bytes of float vectors and walks them with integer dot
+/// products. Distances are the same `1 - inner product` as `hnswlib::InnerProductSpace`, up to quantization error.
+class Int8InnerProductSpace : public hnswlib::SpaceInterface<float> {
+private:
+    size_t num_dim;
+    size_t data_size;
+
+public:
+
+    explicit Int8InnerProductSpace(size_t num_dim);
+
+    size_t get_data_size() override;
+
+    hnswlib::DISTFUNC<float> get_dist_func() override;
+
+    void* get_dist_func_param() override;
+
+    /// Writes the quantized form of `values` (`num_dim` of them) to `dest`, which must hold `get_data_size()` bytes.
+    static void quantize(const float* values, size_t num_dim, void* dest);
+
+    static int32_t dot_product(const int8_t* a, const int8_t* b, size_t num_dim);
+};
+
+/// Half precision copies of the vectors of a quantized graph, which hold 2 bytes per dimension. The nearest neighbours
+/// found on the int8 codes are reranked on these, and they are what the vector of a document reads back as.
+class half_vector_store_t {
+private:
+    mutable std::shared_mutex mutex;
+
+    const size_t num_dim;
+
+    // `num_dim` values per slot
+    std::vector<uint16_t> values;
+
+    spp::sparse_hash_map<uint32_t, uint32_t> seq_id_slots;
+
+    std::vector<uint32_t> free_slots;
+
+public:
+
+    explicit half_vector_store_t(size_t num_dim);
+
+    void upsert(uint32_t seq_id, const float* vals);
+
+    void erase(uint32_t seq_id);
+
+    bool get(uint32_t seq_id, std::vector<float>& vals) const;
+
+    size_t size() const;
+
+    void save(const std::string& file_path) const;
+
+    /// Replaces the contents of the store with the ones persisted at `file_path`, throws on a corrupt or missing file.
+    void load(const std::string& file_path);
+
+    static uint16_t float_to_half(float value);
+
+    static float half_to_float(uint16_t value);
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "json.hpp"
+
+/// LRU cache of the embeddings of search queries, so that popular queries are not sent through a local model or a
+/// remote embedding API on every search.
+///
+/// Entries are keyed on the model and the (prefixed) query text, and the cache is bounded by the approximate number
+/// of bytes that the entries take up. A capacity of 0 disables it.
+class query_embedding_cache_t {
+private:
+    struct entry_t {
+        std::string model_key;
+        std::vector<float> embedding;
+        std::list<std::string>::iterator lru_it;
+    };
+
+    mutable std::mutex mutex;
+
+    std::unordered_map<std::string, entry_t> entries;
+
+    // most recently used key is at the front
+    std::list<std::string> lru;
+
+    size_t max_bytes;
+    size_t num_bytes = 0;
+
+    std::atomic<uint64_t> num_hits = 0;
+    std::atomic<uint64_t> num_misses = 0;
+    std::atomic<uint64_t> num_evictions = 0;
+
+    static std::string get_key(const std::string& model_key, const std::string& query);
+
+    static size_t get_entry_bytes(const std::string& key, const entry_t& entry);
+
+    void erase(std::unordered_map<std::string, entry_t>::iterator it);
+
+    void evict();
+
+public:
+
+    explicit query_embedding_cache_t(size_t max_bytes = 0);
+
+    /// Trims and collapses whitespace, which the tokenizers of the local models discard anyway. Case is preserved,
+    /// because cased models embed "Apple" and "apple" differently. Queries are looked up as given, so the text that
+    /// is cached must be the text that was embedded.
+    static std::string normalize_query(const std::string& query);
+
+    bool find(const std::string& model_key, const std::string& query, std::vector<float>& embedding);
+
+    void insert(const std::string& model_key, const std::string& query, const std::vector<float>& embedding);
+
+    /// Drops the embeddings of a model, e.g. when it is deleted or reloaded.
+    void erase_model(const std::string& model_key);
+
+    void set_max_bytes(size_t max_bytes);
+
+    void clear();
+
+    size_t size() const;
+
+    nlohmann::json get_stats() const;
+};
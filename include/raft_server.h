@@ -100,6 +100,7 @@ class ReplicationState : public braft::StateMachine {
 private:
     static constexpr const char* db_snapshot_name = "db_snapshot";
     static constexpr const char* analytics_db_snapshot_name = "analytics_db_snapshot";
+    static constexpr const char* vector_index_snapshot_name = "vector_index_snapshot";
     static constexpr const char* BATCHED_INDEXER_STATE_KEY = "$BI";
 
     mutable std::shared_mutex node_mutex;
@@ -199,7 +200,7 @@ public:
     // Shut this node down.
     void shutdown();
 
-    int init_db();
+    int init_db(const std::string& vector_index_snapshot_path = "");
 
     Store* get_store();
 
@@ -261,6 +262,7 @@ private:
         std::string state_dir_path;
         std::string db_snapshot_path;
         std::string analytics_db_snapshot_path;
+        std::string vector_index_snapshot_path;
         std::string ext_snapshot_path;
         braft::Closure* done;
     };
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+/// Dense columnar store for numerical sort values of a single field.
+///
+/// Seq ids are allocated sequentially per collection, so values are kept in a contiguous array indexed directly by
+/// seq_id, with a bitmap tracking which seq_ids actually carry a value. Each element is stored in the narrowest width
+/// that fits the field type (1 byte for bool, 4 bytes for int32 and 8 bytes for everything else).
+class sort_column_t {
+private:
+    uint8_t* values = nullptr;
+    uint64_t* present = nullptr;
+
+    // number of seq_ids that `values` and `present` can address: 64 bit, since addressing the largest seq_id takes a
+    // capacity of 2^32
+    uint64_t capacity = 0;
+
+    // number of seq_ids that carry a value
+    uint32_t num_values = 0;
+
+    const uint8_t width;
+
+    void grow(uint32_t seq_id);
+
+    inline int64_t load(uint32_t seq_id) const {
+        switch(width) {
+            case 1:
+                return reinterpret_cast<const int8_t*>(values)[seq_id];
+            case 4:
+                return reinterpret_cast<const int32_t*>(values)[seq_id];
+            default:
+                return reinterpret_cast<const int64_t*>(values)[seq_id];
+        }
+    }
+
+public:
+
+    static constexpr uint32_t MIN_CAPACITY = 1024;
+
+    static constexpr uint8_t WIDTH_8 = 1;
+    static constexpr uint8_t WIDTH_32 = 4;
+    static constexpr uint8_t WIDTH_64 = 8;
+
+    explicit sort_column_t(uint8_t width = WIDTH_64);
+
+    ~sort_column_t();
+
+    sort_column_t(const sort_column_t&) = delete;
+    sort_column_t& operator=(const sort_column_t&) = delete;
+
+    /// Stores the value only when the seq_id does not already have one (same semantics as map emplace).
+    bool emplace(uint32_t seq_id, int64_t value);
+
+    void erase(uint32_t seq_id);
+
+    [[nodiscard]] inline bool contains(uint32_t seq_id) const {
+        return seq_id < capacity && (present[seq_id >> 6] & (1ULL << (seq_id & 63))) != 0;
+    }
+
+    [[nodiscard]] inline size_t count(uint32_t seq_id) const {
+        return contains(seq_id) ? 1 : 0;
+    }
+
+    /// Returns the value of the seq_id, or `default_val` when the seq_id has no value.
+    [[nodiscard]] inline int64_t get(uint32_t seq_id, int64_t default_val) const {
+        return contains(seq_id) ? load(seq_id) : default_val;
+    }
+
+    /// Appends the values of the given seq_ids to `out`, skipping the seq_ids that have no value. The values are
+    /// copied into one contiguous array so that reductions over them (min, max, sum) can be vectorized.
+    void gather(const uint32_t* seq_ids, size_t num_seq_ids, std::vector<int64_t>& out) const;
+
+    /// Throws std::out_of_range when the seq_id has no value.
+    int64_t at(uint32_t seq_id) const;
+
+    [[nodiscard]] size_t size() const {
+        return num_values;
+    }
+
+    [[nodiscard]] uint8_t get_width() const {
+        return width;
+    }
+
+    [[nodiscard]] size_t get_capacity() const {
+        return capacity;
+    }
+
+    void clear();
+};
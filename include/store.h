@@ -166,6 +166,35 @@ public:
         return StoreStatus::ERROR;
     }
 
+    // fetches all the keys in a single batched lookup: `values` and `statuses` are aligned with `keys`
+    void multi_get(const std::vector<std::string>& keys, std::vector<std::string>& values,
+                   std::vector<StoreStatus>& statuses) const {
+        std::vector<rocksdb::Slice> key_slices;
+        key_slices.reserve(keys.size());
+        for(const auto& key: keys) {
+            key_slices.emplace_back(key);
+        }
+
+        values.clear();
+        statuses.clear();
+        statuses.reserve(keys.size());
+
+        std::shared_lock lock(mutex);
+        std::vector<rocksdb::Status> db_statuses = db->MultiGet(rocksdb::ReadOptions(), key_slices, &values);
+
+        for(size_t i = 0; i < db_statuses.size(); i++) {
+            const auto& status = db_statuses[i];
+            if(status.ok()) {
+                statuses.push_back(StoreStatus::FOUND);
+            } else if(status.IsNotFound()) {
+                statuses.push_back(StoreStatus::NOT_FOUND);
+            } else {
+                LOG(ERROR) << "Error while fetching the key: " << keys[i] << " - status is: " << status.ToString();
+                statuses.push_back(StoreStatus::ERROR);
+            }
+        }
+    }
+
     bool remove(const std::string& key) {
         std::shared_lock lock(mutex);
         rocksdb::Status status = db->Delete(write_options, key);
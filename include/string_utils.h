@@ -339,6 +339,14 @@ struct StringUtils {
 
     static size_t get_occurence_count(const std::string& str, char symbol);
 
+    // Checks whether the text is a single JSON object that is closed by its last non-whitespace character. Only the
+    // nesting of brackets outside of strings is looked at: the document is not validated.
+    static bool is_closed_json_object(const char* text, size_t length);
+
+    // Moves the non-empty newline delimited lines of `body` into `json_lines`. Unless `is_last_chunk` is set, a
+    // trailing line that is not a closed JSON object is left in `body` to be completed by the next chunk.
+    static void split_json_lines(std::string& body, std::vector<std::string>& json_lines, bool is_last_chunk);
+
     static Option<bool> split_reference_include_exclude_fields(const std::string& include_fields,
                                                                size_t& index, std::string& token);
 };
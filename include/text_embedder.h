@@ -3,8 +3,11 @@
 #include <sentencepiece_processor.h>
 #include <core/session/onnxruntime_cxx_api.h>
 #include <tokenizer/bert_tokenizer.hpp>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include "option.h"
+#include "inference_batcher.h"
 #include "text_embedder_tokenizer.h"
 #include "text_embedder_remote.h"
 
@@ -37,16 +40,25 @@ class TextEmbedder {
         const TokenizerType get_tokenizer_type() {
             return tokenizer_->get_tokenizer_type();
         }
+
+        // Queue wait and run time of the batches of a local model.
+        nlohmann::json get_inference_stats() const;
     private:
         std::shared_ptr<Ort::Session> session_;
         std::shared_ptr<Ort::Env> env_;
         encoded_input_t Encode(const std::string& text);
-        batch_encoded_input_t batch_encode(const std::vector<std::string>& inputs);
+
+        // Local models: encodes the inputs and runs them in batches along with the inputs of other callers.
+        std::vector<embedding_res_t> infer(const std::vector<std::string>& inputs);
+        void run_batch(const std::vector<inference_batcher_t::inference_t*>& batch);
         std::unique_ptr<TextEmbeddingTokenizer> tokenizer_;
         std::unique_ptr<RemoteEmbedder> remote_embedder_;
         std::string vocab_file_name;
         static std::vector<float> mean_pooling(const std::vector<std::vector<float>>& input, const std::vector<int64_t>& attention_mask);
         std::string output_tensor_name;
         size_t num_dim;
-        std::mutex mutex_;
+
+        std::mutex tokenizer_mutex_;
+
+        std::unique_ptr<inference_batcher_t> batcher_;
 };
@@ -1,96 +1,371 @@
-// https://github.com/jhasse/ThreadPool
+// Originally based on https://github.com/jhasse/ThreadPool
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <future>
-#include <queue>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
+/// Work-stealing thread pool.
+///
+/// Every worker owns a deque: tasks enqueued from a worker thread are pushed to its own deque and popped back in LIFO
+/// order, while idle workers steal from the front of other deques. Tasks enqueued from outside the pool go to one
+/// of two global lanes. Workers always drain the HIGH lane before anything else, so latency sensitive work (search)
+/// is picked up ahead of queued indexing work.
+///
+/// Fork/join call sites should use `task_group_t` (or `parallel_for`): the thread waiting on a group runs the
+/// group's not yet started tasks itself instead of blocking while a worker gets around to them.
 class ThreadPool {
 public:
+    enum priority_t {
+        HIGH,
+        NORMAL
+    };
+
+    class task_group_t;
+
     explicit ThreadPool(size_t);
+
     template<class F, class... Args>
     decltype(auto) enqueue(F&& f, Args&&... args);
+
+    template<class F, class... Args>
+    decltype(auto) enqueue_with_priority(priority_t priority, F&& f, Args&&... args);
+
+    /// Splits [begin, end) into at most `num_chunks` contiguous ranges and calls `f(chunk_begin, chunk_end)` on each
+    /// of them in parallel. Returns once all of the ranges are processed.
+    template<class F>
+    void parallel_for(size_t begin, size_t end, size_t num_chunks, F&& f, priority_t priority = NORMAL);
+
+    size_t get_num_threads() const {
+        return workers.size();
+    }
+
     void shutdown();
+
 private:
+    typedef std::packaged_task<void()> task_t;
+
+    struct task_queue_t {
+        std::mutex mutex;
+        std::deque<task_t> tasks;
+    };
+
     // need to keep track of threads so we can join them
-    std::vector< std::thread > workers;
-    // the task queue
-    std::queue< std::packaged_task<void()> > tasks;
+    std::vector<std::thread> workers;
+
+    std::vector<std::unique_ptr<task_queue_t>> worker_queues;
+    task_queue_t high_queue;
+    task_queue_t normal_queue;
+
+    // total number of tasks sitting in any of the queues
+    std::atomic<size_t> num_queued{0};
+    std::atomic<size_t> num_sleeping{0};
+    std::atomic<bool> draining{false};
 
-    // synchronization
-    std::mutex queue_mutex;
+    // synchronization for idle workers and for shutdown
+    std::mutex sleep_mutex;
     std::condition_variable condition;
     std::condition_variable condition_producers;
-    bool stop;
+    std::atomic<bool> stop{false};
+
+    // identifies the pool and worker that the current thread belongs to
+    inline static thread_local ThreadPool* current_pool = nullptr;
+    inline static thread_local size_t current_worker = 0;
+
+    void push_task(priority_t priority, task_t&& task);
+
+    bool pop_task(size_t worker_id, task_t& task);
+
+    bool pop_front(task_queue_t& queue, task_t& task);
+
+    bool pop_back(task_queue_t& queue, task_t& task);
+
+    void on_task_popped();
+
+    void worker_loop(size_t worker_id);
+};
+
+/// A set of tasks that can be waited on together. `wait()` runs tasks of this group that no worker has picked up yet
+/// on the calling thread, so nested fork/join never leaves the waiting thread idle. Only tasks of the group itself are
+/// run inline: unrelated (possibly long running) pool tasks are never picked up by a waiting thread.
+///
+/// When the pool is null, tasks are run inline by `wait()`.
+class ThreadPool::task_group_t {
+private:
+    struct state_t {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::function<void()>> unstarted;
+        size_t pending = 0;
+        std::exception_ptr error;
+    };
+
+    ThreadPool* pool;
+    const priority_t priority;
+    std::shared_ptr<state_t> state;
+
+    // runs one unstarted task of the group, returns false if there is none
+    static bool run_one(const std::shared_ptr<state_t>& state) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if(state->unstarted.empty()) {
+                return false;
+            }
+
+            task = std::move(state->unstarted.front());
+            state->unstarted.pop_front();
+        }
+
+        std::exception_ptr error;
+
+        try {
+            task();
+        } catch(...) {
+            error = std::current_exception();
+        }
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        if(error && !state->error) {
+            state->error = error;
+        }
+
+        if(--state->pending == 0) {
+            state->cv.notify_all();
+        }
+
+        return true;
+    }
+
+public:
+    explicit task_group_t(ThreadPool* pool, priority_t priority = NORMAL):
+            pool(pool), priority(priority), state(std::make_shared<state_t>()) {
+
+    }
+
+    task_group_t(const task_group_t&) = delete;
+    task_group_t& operator=(const task_group_t&) = delete;
+
+    ~task_group_t() {
+        // tasks reference the caller's stack, so they must not outlive the group
+        std::unique_lock<std::mutex> lock(state->mutex);
+        if(state->pending != 0) {
+            lock.unlock();
+            try {
+                wait();
+            } catch(...) {}
+        }
+    }
+
+    template<class F>
+    void run(F&& f) {
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->unstarted.emplace_back(std::forward<F>(f));
+            state->pending++;
+        }
+
+        if(pool != nullptr) {
+            // the pool task only holds on to the shared state: it becomes a no-op if the waiter already ran the task
+            pool->enqueue_with_priority(priority, [state = state]() {
+                run_one(state);
+            });
+        }
+    }
+
+    /// Blocks until all tasks of the group are done. Rethrows the first exception thrown by any of the tasks.
+    void wait() {
+        while(run_one(state)) {}
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->cv.wait(lock, [this]() { return state->pending == 0; });
+
+        if(state->error) {
+            auto error = state->error;
+            state->error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
 };
 
 // the constructor just launches some amount of workers
-inline ThreadPool::ThreadPool(size_t threads)
-        :   stop(false)
-{
-    for(size_t i = 0;i<threads;++i)
-        workers.emplace_back(
-                [this]
-                {
-                    for(;;)
-                    {
-                        std::packaged_task<void()> task;
-                        {
-                            std::unique_lock<std::mutex> lock(this->queue_mutex);
-                            this->condition.wait(lock,
-                                                 [this]{ return this->stop || !this->tasks.empty(); });
-                            if(this->stop) {
-                                return;
-                            }
-
-                            if(this->tasks.empty()) {
-                                continue;
-                            }
-                            task = std::move(this->tasks.front());
-                            this->tasks.pop();
-                            if (tasks.empty()) {
-                                condition_producers.notify_one(); // notify the destructor that the queue is empty
-                            }
-                        }
-
-                        task();
-                    }
-                }
-        );
+inline ThreadPool::ThreadPool(size_t threads) {
+    for(size_t i = 0; i < threads; ++i) {
+        worker_queues.emplace_back(new task_queue_t());
+    }
+
+    for(size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+inline void ThreadPool::worker_loop(size_t worker_id) {
+    current_pool = this;
+    current_worker = worker_id;
+
+    for(;;) {
+        task_t task;
+
+        if(pop_task(worker_id, task)) {
+            task();
+            continue;
+        }
+
+        // Announce that we are going to sleep before re-checking the queue count: a producer increments
+        // `num_queued` before looking at `num_sleeping`, so one of the two always sees the other.
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        num_sleeping++;
+        condition.wait(lock, [this]{ return stop || num_queued.load() != 0; });
+        num_sleeping--;
+
+        if(stop) {
+            return;
+        }
+    }
+}
+
+inline void ThreadPool::push_task(priority_t priority, task_t&& task) {
+    task_queue_t* queue;
+
+    if(priority == HIGH) {
+        queue = &high_queue;
+    } else if(current_pool == this) {
+        queue = worker_queues[current_worker].get();
+    } else {
+        queue = &normal_queue;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        queue->tasks.emplace_back(std::move(task));
+        num_queued++;
+    }
+
+    if(num_sleeping.load() != 0) {
+        // taking the lock ensures that a worker which is about to sleep either sees the task or gets the notification
+        { std::unique_lock<std::mutex> lock(sleep_mutex); }
+        condition.notify_one();
+    }
+}
+
+inline bool ThreadPool::pop_front(task_queue_t& queue, task_t& task) {
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    num_queued--;
+    return true;
+}
+
+inline bool ThreadPool::pop_back(task_queue_t& queue, task_t& task) {
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    num_queued--;
+    return true;
+}
+
+inline bool ThreadPool::pop_task(size_t worker_id, task_t& task) {
+    if(num_queued.load() == 0) {
+        return false;
+    }
+
+    // high priority lane first, then our own deque (most recently pushed task is the most cache friendly), then the
+    // shared lane and finally steal the oldest task from another worker
+    bool found = pop_front(high_queue, task) ||
+                 pop_back(*worker_queues[worker_id], task) ||
+                 pop_front(normal_queue, task);
+
+    for(size_t i = 1; !found && i < worker_queues.size(); i++) {
+        found = pop_front(*worker_queues[(worker_id + i) % worker_queues.size()], task);
+    }
+
+    if(found) {
+        on_task_popped();
+    }
+
+    return found;
+}
+
+inline void ThreadPool::on_task_popped() {
+    if(draining.load() && num_queued.load() == 0) {
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        condition_producers.notify_all(); // notify shutdown() that the queues are empty
+    }
 }
 
 // add new work item to the pool
 template<class F, class... Args>
-decltype(auto) ThreadPool::enqueue(F&& f, Args&&... args)
-{
+decltype(auto) ThreadPool::enqueue(F&& f, Args&&... args) {
+    return enqueue_with_priority(NORMAL, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<class F, class... Args>
+decltype(auto) ThreadPool::enqueue_with_priority(priority_t priority, F&& f, Args&&... args) {
     using return_type = std::invoke_result_t<F, Args...>;
 
-    std::packaged_task<return_type()> task(
+    auto task = std::make_shared<std::packaged_task<return_type()>>(
             std::bind(std::forward<F>(f), std::forward<Args>(args)...)
     );
 
-    std::future<return_type> res = task.get_future();
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex);
+    std::future<return_type> res = task->get_future();
 
-        // don't allow enqueueing after stopping the pool
-        if(!stop) {
-            tasks.emplace(std::move(task));
-        }
+    // don't allow enqueueing after stopping the pool
+    if(!stop) {
+        push_task(priority, task_t([task]() { (*task)(); }));
     }
-    condition.notify_one();
+
     return res;
 }
 
+template<class F>
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t num_chunks, F&& f, priority_t priority) {
+    if(begin >= end) {
+        return ;
+    }
+
+    num_chunks = std::max<size_t>(1, std::min(num_chunks, end - begin));
+    const size_t chunk_size = (end - begin + num_chunks - 1) / num_chunks;  // rounds up
+
+    task_group_t group(this, priority);
+
+    for(size_t chunk_begin = begin; chunk_begin < end; chunk_begin += chunk_size) {
+        const size_t chunk_end = std::min(end, chunk_begin + chunk_size);
+        group.run([&f, chunk_begin, chunk_end]() {
+            f(chunk_begin, chunk_end);
+        });
+    }
+
+    group.wait();
+}
+
 inline void ThreadPool::shutdown() {
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        condition_producers.wait(lock, [this] { return tasks.empty(); });
+        draining = true;
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        condition_producers.wait(lock, [this] { return num_queued.load() == 0; });
         stop = true;
     }
+
     condition.notify_all();
-    for (std::thread& worker : workers) {
+    for(std::thread& worker : workers) {
         worker.join();
     }
 }
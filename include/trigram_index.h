@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "id_list.h"
+#include "sparsepp.h"
+#include "tsl/htrie_map.h"
+
+/// Dictionary of the tokens of an infix searchable field, indexed by the trigrams (substrings of 3 bytes) that they
+/// contain.
+///
+/// A token can only contain a query if it contains every trigram of the query, so an infix search intersects the
+/// tokens of the query's trigrams and verifies just those, instead of scanning the whole dictionary.
+class trigram_index_t {
+private:
+    tsl::htrie_map<char, uint32_t> token_ids;
+
+    // token of each id: ids of erased tokens are reused
+    std::vector<std::string> tokens;
+    std::vector<uint32_t> free_token_ids;
+
+    // ids of the tokens that contain a trigram
+    spp::sparse_hash_map<uint32_t, id_list_t*> trigram_token_ids;
+
+    static void get_trigrams(const std::string& token, std::vector<uint32_t>& trigrams);
+
+public:
+
+    static constexpr size_t TRIGRAM_LEN = 3;
+
+    static constexpr uint16_t TOKEN_IDS_BLOCK_SIZE = 256;
+
+    trigram_index_t() = default;
+
+    trigram_index_t(const trigram_index_t&) = delete;
+    trigram_index_t& operator=(const trigram_index_t&) = delete;
+
+    ~trigram_index_t();
+
+    void insert(const std::string& token);
+
+    void erase(const std::string& token);
+
+    [[nodiscard]] size_t size() const {
+        return token_ids.size();
+    }
+
+    /// Calls `func` with the tokens that may contain `query`: the ones that contain all of its trigrams, or every
+    /// token when the query is shorter than a trigram. Stops as soon as `func` returns false.
+    void for_each_candidate(const std::string& query, const std::function<bool(const std::string&)>& func) const;
+};
@@ -76,8 +76,22 @@ private:
 
     uint32_t db_compaction_interval;
 
+    uint32_t write_coalesce_max_docs;
+
+    uint32_t write_coalesce_wait_ms;
+
+    uint32_t embedding_max_parallel_batches;
+
+    uint32_t embedding_intra_op_threads;
+
+    uint32_t query_embedding_cache_size_mb;
+
     bool enable_lazy_filter;
 
+    bool enable_vector_index_snapshot;
+
+    uint32_t vector_index_snapshot_max_elements;
+
     bool enable_search_logging;
 
 protected:
@@ -110,8 +124,19 @@ protected:
         this->housekeeping_interval = 1800;     // in seconds
         this->db_compaction_interval = 0;     // in seconds, disabled
 
+        this->write_coalesce_max_docs = 1;   // disabled
+        this->write_coalesce_wait_ms = 0;
+
+        this->embedding_max_parallel_batches = 1;
+        this->embedding_intra_op_threads = 0;  // decided by onnxruntime
+
+        this->query_embedding_cache_size_mb = 16;
+
         this->enable_lazy_filter = false;
 
+        this->enable_vector_index_snapshot = false;
+        this->vector_index_snapshot_max_elements = 5000000;
+
         this->enable_search_logging = false;
     }
 
@@ -334,6 +359,26 @@ public:
         return this->db_compaction_interval;
     }
 
+    size_t get_write_coalesce_max_docs() const {
+        return this->write_coalesce_max_docs;
+    }
+
+    size_t get_write_coalesce_wait_ms() const {
+        return this->write_coalesce_wait_ms;
+    }
+
+    size_t get_embedding_max_parallel_batches() const {
+        return this->embedding_max_parallel_batches;
+    }
+
+    size_t get_embedding_intra_op_threads() const {
+        return this->embedding_intra_op_threads;
+    }
+
+    size_t get_query_embedding_cache_size_mb() const {
+        return this->query_embedding_cache_size_mb;
+    }
+
     size_t get_thread_pool_size() const {
         return this->thread_pool_size;
     }
@@ -374,6 +419,14 @@ public:
         return enable_lazy_filter;
     }
 
+    bool get_enable_vector_index_snapshot() const {
+        return enable_vector_index_snapshot;
+    }
+
+    size_t get_vector_index_snapshot_max_elements() const {
+        return vector_index_snapshot_max_elements;
+    }
+
     const std::atomic<bool>& get_skip_writes() const {
         return skip_writes;
     }
@@ -1,5 +1,90 @@
 #include "array_utils.h"
 #include <memory.h>
+#include <algorithm>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define ARRAY_UTILS_SIMD
+#define ARRAY_UTILS_AVX2
+#elif defined(__aarch64__)
+#include <sse2neon.h>
+#define ARRAY_UTILS_SIMD
+#endif
+
+// window size below which the galloping search stops bisecting and scans instead
+static constexpr uint32_t LOWER_BOUND_SCAN_WINDOW = 32;
+
+static uint32_t count_less_than_scalar(const uint32_t* array, uint32_t array_len, uint32_t id) {
+    uint32_t count = 0;
+    while(count < array_len && array[count] < id) {
+        count++;
+    }
+
+    return count;
+}
+
+#ifdef ARRAY_UTILS_SIMD
+// SSE2 only has signed comparisons, so both sides are biased by 2^31 to compare unsigned values
+static uint32_t count_less_than_sse2(const uint32_t* array, uint32_t array_len, uint32_t id) {
+    const __m128i bias = _mm_set1_epi32(0x80000000);
+    const __m128i key = _mm_xor_si128(_mm_set1_epi32(id), bias);
+
+    uint32_t count = 0, i = 0;
+
+    for(; i + 4 <= array_len; i += 4) {
+        const __m128i vals = _mm_xor_si128(_mm_loadu_si128((const __m128i*) (array + i)), bias);
+        const int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key, vals)));
+        count += __builtin_popcount(mask);
+
+        if(mask != 0xF) {
+            // array is sorted, so the remaining elements are all >= id
+            return count;
+        }
+    }
+
+    return count + count_less_than_scalar(array + i, array_len - i, id);
+}
+#endif
+
+#ifdef ARRAY_UTILS_AVX2
+__attribute__((target("avx2")))
+static uint32_t count_less_than_avx2(const uint32_t* array, uint32_t array_len, uint32_t id) {
+    const __m256i bias = _mm256_set1_epi32(0x80000000);
+    const __m256i key = _mm256_xor_si256(_mm256_set1_epi32(id), bias);
+
+    uint32_t count = 0, i = 0;
+
+    for(; i + 8 <= array_len; i += 8) {
+        const __m256i vals = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*) (array + i)), bias);
+        const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key, vals)));
+        count += __builtin_popcount(mask);
+
+        if(mask != 0xFF) {
+            return count;
+        }
+    }
+
+    return count + count_less_than_sse2(array + i, array_len - i, id);
+}
+#endif
+
+typedef uint32_t (*count_less_than_fn_t)(const uint32_t*, uint32_t, uint32_t);
+
+static count_less_than_fn_t resolve_count_less_than() {
+#if defined(ARRAY_UTILS_AVX2)
+    if(__builtin_cpu_supports("avx2")) {
+        return count_less_than_avx2;
+    }
+#endif
+
+#if defined(ARRAY_UTILS_SIMD)
+    return count_less_than_sse2;
+#else
+    return count_less_than_scalar;
+#endif
+}
+
+static const count_less_than_fn_t count_less_than_impl = resolve_count_less_than();
 
 size_t ArrayUtils::and_scalar(const uint32_t *A, const size_t lenA,
                               const uint32_t *B, const size_t lenB, uint32_t **results) {
@@ -178,4 +263,33 @@ bool ArrayUtils::skip_index_to_id(uint32_t& curr_index, uint32_t const* const ar
 
     curr_index = start;
     return false;
-}
\ No newline at end of file
+}
+uint32_t ArrayUtils::count_less_than(const uint32_t* array, uint32_t array_len, uint32_t id) {
+    return count_less_than_impl(array, array_len, id);
+}
+
+uint32_t ArrayUtils::gallop_from(const uint32_t* array, uint32_t array_len, uint32_t low, uint32_t id) {
+    // invariant: array[low] < id, and the answer lies in (low, high]
+    uint64_t step = PROBE_LEN;
+    uint64_t high = low + step;
+
+    while(high < array_len && array[high] < id) {
+        low = high;
+        step <<= 1;
+        high = low + step;
+    }
+
+    uint32_t left = low + 1;
+    uint32_t right = std::min<uint64_t>(high, array_len);
+
+    while(right - left > LOWER_BOUND_SCAN_WINDOW) {
+        const uint32_t mid = left + (right - left) / 2;
+        if(array[mid] < id) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left + count_less_than(array + left, right - left, id);
+}
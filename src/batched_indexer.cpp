@@ -187,6 +187,13 @@ void BatchedIndexer::run() {
 
     LOG(INFO) << "BatchedIndexer skip_index: " << skip_index;
 
+    std::string coalesced_crash_value;
+    if(meta_store->get(COALESCED_CRASH_KEY, coalesced_crash_value) == StoreStatus::FOUND) {
+        LOG(ERROR) << "Indexing coalesced writes triggered a crash previously, so writes will not be coalesced.";
+        coalescing_disabled = true;
+        meta_store->remove(COALESCED_CRASH_KEY);
+    }
+
     for(size_t i = 0; i < num_threads; i++) {
         std::deque<uint64_t>& queue = queues[i];
         await_t& queue_mutex = qmutuxes[i];
@@ -204,6 +211,16 @@ void BatchedIndexer::run() {
                 queue.pop_front();
                 qlk.unlock();
 
+                // writes are replayed one at a time after a crash so that a bad log entry is skipped on its own
+                if(config.get_write_coalesce_max_docs() > 1 && !coalescing_disabled &&
+                   skip_index == UNSET_SKIP_INDEX) {
+                    const std::vector<uint64_t>& req_ids = take_coalesced_writes(req_id, queue, queue_mutex);
+                    if(req_ids.size() > 1) {
+                        index_coalesced_writes(req_ids);
+                        continue;
+                    }
+                }
+
                 std::unique_lock mlk(mutex);
                 auto req_res_map_it = req_res_map.find(req_id);
                 if(req_res_map_it == req_res_map.end()) {
@@ -490,6 +507,200 @@ std::string BatchedIndexer::get_req_suffix_key(uint64_t req_id) {
     return req_key_prefix;
 }
 
+bool BatchedIndexer::get_coalesce_key(uint64_t req_id, std::string& coalesce_key) {
+    std::unique_lock lk(mutex);
+    auto req_res_map_it = req_res_map.find(req_id);
+    if(req_res_map_it == req_res_map.end()) {
+        return false;
+    }
+
+    const req_res_t& req_res = req_res_map_it->second;
+    const std::shared_ptr<http_req>& req = req_res.req;
+
+    // the whole request must be a single chunk that has not been read yet
+    if(!req_res.is_complete || req_res.num_chunks != 1 || req_res.next_chunk_index != 0 || req->start_ts == 0) {
+        return false;
+    }
+
+    route_path* rpath = nullptr;
+    if(!server->get_route(req->route_hash, &rpath) || rpath->handler != post_add_document) {
+        return false;
+    }
+
+    // params include the collection name
+    coalesce_key.clear();
+    for(const auto& kv: req->params) {
+        coalesce_key += std::to_string(kv.first.size()) + ":" + kv.first +
+                        std::to_string(kv.second.size()) + ":" + kv.second;
+    }
+
+    return true;
+}
+
+std::vector<uint64_t> BatchedIndexer::take_coalesced_writes(uint64_t req_id, std::deque<uint64_t>& queue,
+                                                            await_t& queue_mutex) {
+    std::vector<uint64_t> req_ids = {req_id};
+    std::string coalesce_key;
+
+    if(!get_coalesce_key(req_id, coalesce_key)) {
+        return req_ids;
+    }
+
+    const size_t max_docs = config.get_write_coalesce_max_docs();
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(config.get_write_coalesce_wait_ms());
+
+    while(req_ids.size() < max_docs && !quit) {
+        // Other threads only append to the queue, so the requests at its front stay there until they are popped below.
+        // The queue lock is not held while looking at the requests since `mutex` is acquired before it elsewhere.
+        std::vector<uint64_t> candidate_ids;
+
+        {
+            std::unique_lock qlk(queue_mutex.mcv);
+            bool has_writes = queue_mutex.cv.wait_until(qlk, deadline, [&] { return quit || !queue.empty(); });
+
+            if(!has_writes || quit) {
+                break;
+            }
+
+            for(size_t i = 0; i < queue.size() && req_ids.size() + candidate_ids.size() < max_docs; i++) {
+                candidate_ids.push_back(queue[i]);
+            }
+        }
+
+        size_t num_taken = 0;
+        std::string candidate_key;
+
+        while(num_taken < candidate_ids.size() && get_coalesce_key(candidate_ids[num_taken], candidate_key) &&
+              candidate_key == coalesce_key) {
+            num_taken++;
+        }
+
+        {
+            std::unique_lock qlk(queue_mutex.mcv);
+            queue.erase(queue.begin(), queue.begin() + num_taken);
+        }
+
+        req_ids.insert(req_ids.end(), candidate_ids.begin(), candidate_ids.begin() + num_taken);
+
+        if(num_taken < candidate_ids.size()) {
+            // writes must be applied in order, so stop at the first one that cannot join the batch
+            break;
+        }
+    }
+
+    return req_ids;
+}
+
+void BatchedIndexer::index_coalesced_writes(const std::vector<uint64_t>& req_ids) {
+    std::vector<req_res_t*> req_res_entries;
+
+    {
+        // entries of complete requests are erased only by the thread that indexes them
+        std::unique_lock mlk(mutex);
+        for(uint64_t req_id: req_ids) {
+            req_res_entries.push_back(&req_res_map.at(req_id));
+        }
+    }
+
+    {
+        std::shared_lock slk(pause_mutex); // used for snapshot
+
+        std::vector<std::shared_ptr<http_req>> reqs;
+        std::vector<std::shared_ptr<http_res>> ress;
+
+        for(req_res_t* req_res: req_res_entries) {
+            const std::string& request_chunk_key = get_req_prefix_key(req_res->start_ts) +
+                                                   StringUtils::serialize_uint32_t(0);
+            std::string req_json;
+
+            if(store->get(request_chunk_key, req_json) != StoreStatus::FOUND) {
+                LOG(ERROR) << "Req ID " << req_res->start_ts << " not found in store.";
+                continue;
+            }
+
+            req_res->req->body = "";
+            req_res->req->load_from_json(req_json);
+
+            // update thread local for reference during a crash
+            write_log_index = req_res->req->log_index;
+
+            if(write_log_index == skip_index) {
+                LOG(ERROR) << "Skipping write log index " << write_log_index
+                           << " which seems to have triggered a crash previously.";
+                populate_skip_index();
+                continue;
+            }
+
+            reqs.push_back(req_res->req);
+            ress.push_back(req_res->res);
+        }
+
+        if(!reqs.empty()) {
+            auto resource_check = cached_resource_stat_t::get_instance()
+                                  .has_enough_resources(config.get_data_dir(),
+                                                        config.get_disk_used_max_percentage(),
+                                                        config.get_memory_used_max_percentage());
+            bool send_always = false;
+
+            if(resource_check != cached_resource_stat_t::OK) {
+                const std::string& err_msg = "Rejecting write: running out of resource type: " +
+                                             std::string(magic_enum::enum_name(resource_check));
+                LOG(ERROR) << err_msg;
+                for(const auto& res: ress) {
+                    res->set_422(err_msg);
+                    res->final = true;
+                }
+                send_always = true;
+            } else if(skip_writes) {
+                for(const auto& res: ress) {
+                    res->set(422, "Skipping write.");
+                    res->final = true;
+                }
+                send_always = true;
+            } else {
+                try {
+                    write_log_index = COALESCED_WRITES_LOG_INDEX;
+                    post_add_documents_coalesced(reqs, ress);
+                } catch(const std::exception& e) {
+                    LOG(ERROR) << "Exception while indexing " << reqs.size() << " coalesced writes.";
+                    LOG(ERROR) << "Raw error: " << e.what();
+                    for(const auto& res: ress) {
+                        res->set_400("Bad request.");
+                        res->final = true;
+                    }
+                }
+            }
+
+            for(size_t i = 0; i < reqs.size(); i++) {
+                if(send_always || ress[i]->is_alive) {
+                    async_req_res_t* async_req_res = new async_req_res_t(reqs[i], ress[i], true);
+                    server->get_message_dispatcher()->send_message(HttpServer::STREAM_RESPONSE_MESSAGE, async_req_res);
+                }
+            }
+        }
+
+        for(req_res_t* req_res: req_res_entries) {
+            queued_writes--;
+            req_res->next_chunk_index++;
+        }
+    }
+
+    for(uint64_t req_id: req_ids) {
+        const std::string& req_key_prefix = get_req_prefix_key(req_id);
+        store->delete_range(req_key_prefix, req_key_prefix + StringUtils::serialize_uint32_t(UINT32_MAX));
+    }
+
+    {
+        std::unique_lock lk(mutex);
+        for(uint64_t req_id: req_ids) {
+            req_res_map.erase(req_id);
+        }
+    }
+
+    refq_wait.cv.notify_one();
+}
+
 BatchedIndexer::~BatchedIndexer() {
     delete [] qmutuxes;
     delete skip_index_iter_upper_bound;
@@ -518,6 +729,12 @@ void BatchedIndexer::populate_skip_index() {
 }
 
 void BatchedIndexer::persist_applying_index() {
+    if(write_log_index == COALESCED_WRITES_LOG_INDEX) {
+        LOG(INFO) << "Saving that coalesced writes were being applied.";
+        meta_store->insert(COALESCED_CRASH_KEY, std::to_string(write_log_index));
+        return ;
+    }
+
     LOG(INFO) << "Saving currently applying index: " << write_log_index;
     std::string key = SKIP_INDICES_PREFIX + std::to_string(write_log_index);
     meta_store->insert(key, std::to_string(write_log_index));
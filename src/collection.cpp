@@ -41,6 +41,8 @@ struct sort_fields_guard_t {
     }
 };
 
+std::atomic<uint64_t> Collection::global_write_generation{0};
+
 Collection::Collection(const std::string& name, const uint32_t collection_id, const uint64_t created_at,
                        const uint32_t next_seq_id, Store *store, const std::vector<field> &fields,
                        const std::string& default_sorting_field,
@@ -555,7 +557,8 @@ nlohmann::json Collection::add_many(std::vector<std::string>& json_lines, nlohma
         Option<doc_seq_id_t> doc_seq_id_op = to_doc(json_line, document, operation, dirty_values, id);
 
         const uint32_t seq_id = doc_seq_id_op.ok() ? doc_seq_id_op.get().seq_id : 0;
-        index_record record(i, seq_id, document, operation, dirty_values);
+        // `document` is parsed again from the next line, so it can be moved into the record
+        index_record record(i, seq_id, std::move(document), operation, dirty_values);
 
         // NOTE: we overwrite the input json_lines with result to avoid memory pressure
 
@@ -872,6 +875,7 @@ size_t Collection::batch_index_in_memory(std::vector<index_record>& index_record
                                                    search_schema, embedding_fields, fallback_field_type,
                                                    token_separators, symbols_to_index, true, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries, generate_embeddings);
     num_documents += num_indexed;
+    bump_write_generation();
     return num_indexed;
 }
 
@@ -1317,8 +1321,8 @@ Option<bool> Collection::validate_and_standardize_sort_fields(const std::vector<
                             }
                         }
 
-                        std::string embed_query = embedder_manager.get_query_prefix(vector_field_it.value().embed[fields::model_config]) + q;
-                        auto embedding_op = embedder->Embed(embed_query, remote_embedding_timeout_ms, remote_embedding_num_tries);
+                        auto embedding_op = embedder_manager.embed_query(embedder, vector_field_it.value().embed[fields::model_config], q,
+                                                                           remote_embedding_timeout_ms, remote_embedding_num_tries);
 
                         if(!embedding_op.success) {
                             if(!embedding_op.error["error"].get<std::string>().empty()) {
@@ -1372,8 +1376,8 @@ Option<bool> Collection::validate_and_standardize_sort_fields(const std::vector<
                         return Option<bool>(400, error);
                     }
 
-                    std::string embed_query = embedder_manager.get_query_prefix(vector_field_it.value().embed[fields::model_config]) + query;
-                    auto embedding_op = embedder->Embed(embed_query, remote_embedding_timeout_ms, remote_embedding_num_tries);
+                    auto embedding_op = embedder_manager.embed_query(embedder, vector_field_it.value().embed[fields::model_config], query,
+                                                                       remote_embedding_timeout_ms, remote_embedding_num_tries);
 
                     if(!embedding_op.success) {
                         if(!embedding_op.error["error"].get<std::string>().empty()) {
@@ -1956,8 +1960,8 @@ Option<nlohmann::json> Collection::search(std::string raw_query,
                     }
                 }
 
-                std::string embed_query = embedder_manager.get_query_prefix(search_field.embed[fields::model_config]) + query;
-                auto embedding_op = embedder->Embed(embed_query, remote_embedding_timeout_ms, remote_embedding_num_tries);
+                auto embedding_op = embedder_manager.embed_query(embedder, search_field.embed[fields::model_config], query,
+                                                                   remote_embedding_timeout_ms, remote_embedding_num_tries);
                 if(!embedding_op.success) {
                     if(!embedding_op.error["error"].get<std::string>().empty()) {
                         return Option<nlohmann::json>(400, embedding_op.error["error"].get<std::string>());
@@ -2515,6 +2519,19 @@ Option<nlohmann::json> Collection::search(std::string raw_query,
     std::string first_q = raw_query;
     expand_search_query(raw_query, offset, total, search_params, result_group_kvs, raw_search_fields, first_q);
 
+    // fetch and parse the documents of all the hits on this page in one go
+    std::vector<std::string> hit_seq_id_keys;
+    for(long result_kvs_index = start_result_index; result_kvs_index <= end_result_index; result_kvs_index++) {
+        for(const KV* field_order_kv: result_group_kvs[result_kvs_index]) {
+            hit_seq_id_keys.push_back(get_seq_id_key((uint32_t) field_order_kv->key));
+        }
+    }
+
+    std::vector<nlohmann::json> hit_documents;
+    std::vector<Option<bool>> hit_document_ops;
+    get_documents_from_store(hit_seq_id_keys, hit_documents, hit_document_ops, search_params->concurrency);
+    size_t hit_index = 0;
+
     // construct results array
     for(long result_kvs_index = start_result_index; result_kvs_index <= end_result_index; result_kvs_index++) {
         const std::vector<KV*> & kv_group = result_group_kvs[result_kvs_index];
@@ -2528,10 +2545,11 @@ Option<nlohmann::json> Collection::search(std::string raw_query,
         nlohmann::json group_key = nlohmann::json::array();
 
         for(const KV* field_order_kv: kv_group) {
-            const std::string& seq_id_key = get_seq_id_key((uint32_t) field_order_kv->key);
+            const std::string& seq_id_key = hit_seq_id_keys[hit_index];
 
-            nlohmann::json document;
-            const Option<bool> & document_op = get_document_from_store(seq_id_key, document);
+            nlohmann::json& document = hit_documents[hit_index];
+            const Option<bool>& document_op = hit_document_ops[hit_index];
+            hit_index++;
 
             if(!document_op.ok()) {
                 LOG(ERROR) << "Document fetch error. " << document_op.error();
@@ -4363,6 +4381,7 @@ void Collection::remove_document(const nlohmann::json & document, const uint32_t
 
         index->remove(seq_id, document, {}, false);
         num_documents -= 1;
+        bump_write_generation();
     }
 
     if(remove_from_store) {
@@ -4459,6 +4478,8 @@ Option<uint32_t> Collection::add_override(const override_t & override, bool writ
         override_tags[tag].insert(override.id);
     }
 
+    bump_write_generation();
+
     return Option<uint32_t>(200);
 }
 
@@ -4477,6 +4498,7 @@ Option<uint32_t> Collection::remove_override(const std::string & id) {
         }
 
         overrides.erase(id);
+        bump_write_generation();
 
         return Option<uint32_t>(200);
     }
@@ -4522,6 +4544,19 @@ uint32_t Collection::get_collection_id() const {
     return collection_id.load();
 }
 
+uint64_t Collection::get_write_generation() const {
+    return write_generation.load();
+}
+
+uint64_t Collection::get_global_write_generation() {
+    return global_write_generation.load();
+}
+
+void Collection::bump_write_generation() {
+    write_generation++;
+    global_write_generation++;
+}
+
 Option<uint32_t> Collection::doc_id_to_seq_id_with_lock(const std::string & doc_id) const {
     std::shared_lock lock(mutex);
     return doc_id_to_seq_id(doc_id);
@@ -4629,7 +4664,48 @@ Option<bool> Collection::get_document_from_store(const std::string &seq_id_key,
                                                  nlohmann::json& document, bool raw_doc) const {
     std::string json_doc_str;
     StoreStatus json_doc_status = store->get(seq_id_key, json_doc_str);
+    return parse_stored_document(seq_id_key, json_doc_status, json_doc_str, document, raw_doc);
+}
+
+void Collection::get_documents_from_store(const std::vector<std::string>& seq_id_keys,
+                                          std::vector<nlohmann::json>& documents,
+                                          std::vector<Option<bool>>& document_ops,
+                                          size_t concurrency, bool raw_doc) const {
+    std::vector<std::string> json_doc_strs;
+    std::vector<StoreStatus> json_doc_statuses;
+    store->multi_get(seq_id_keys, json_doc_strs, json_doc_statuses);
+
+    documents.clear();
+    documents.resize(seq_id_keys.size());
+
+    document_ops.clear();
+    document_ops.reserve(seq_id_keys.size());
+    for(size_t i = 0; i < seq_id_keys.size(); i++) {
+        document_ops.emplace_back(true);
+    }
+
+    auto parse_range = [&](size_t start_index, size_t end_index) {
+        for(size_t i = start_index; i < end_index; i++) {
+            document_ops[i] = parse_stored_document(seq_id_keys[i], json_doc_statuses[i], json_doc_strs[i],
+                                                    documents[i], raw_doc);
+        }
+    };
+
+    const size_t num_threads = std::min(concurrency, seq_id_keys.size() / PARALLEL_PARSE_MIN_DOCS);
+
+    if(num_threads <= 1) {
+        parse_range(0, seq_id_keys.size());
+        return ;
+    }
+
+    // each chunk parses a disjoint window of documents, so results can be written in place
+    ThreadPool* thread_pool = CollectionManager::get_instance().get_thread_pool();
+    thread_pool->parallel_for(0, seq_id_keys.size(), num_threads, parse_range, ThreadPool::HIGH);
+}
 
+Option<bool> Collection::parse_stored_document(const std::string& seq_id_key, const StoreStatus json_doc_status,
+                                               const std::string& json_doc_str, nlohmann::json& document,
+                                               bool raw_doc) const {
     if(json_doc_status != StoreStatus::FOUND) {
         const std::string& seq_id = std::to_string(get_seq_id_from_key(seq_id_key));
         if(json_doc_status == StoreStatus::NOT_FOUND) {
@@ -4731,7 +4807,12 @@ Option<bool> Collection::add_synonym(const nlohmann::json& syn_json, bool write_
         return syn_op;
     }
 
-    return synonym_index->add_synonym(name, synonym, write_to_store);
+    auto add_op = synonym_index->add_synonym(name, synonym, write_to_store);
+    if(add_op.ok()) {
+        bump_write_generation();
+    }
+
+    return add_op;
 }
 
 bool Collection::get_synonym(const std::string& id, synonym_t& synonym) {
@@ -4741,7 +4822,12 @@ bool Collection::get_synonym(const std::string& id, synonym_t& synonym) {
 
 Option<bool> Collection::remove_synonym(const std::string &id) {
     std::shared_lock lock(mutex);
-    return synonym_index->remove_synonym(name, id);
+    auto remove_op = synonym_index->remove_synonym(name, id);
+    if(remove_op.ok()) {
+        bump_write_generation();
+    }
+
+    return remove_op;
 }
 
 void Collection::synonym_reduction(const std::vector<std::string>& tokens,
@@ -4931,7 +5017,8 @@ Option<bool> Collection::batch_alter_data(const std::vector<field>& alter_fields
             field::flatten_doc(document, nested_fields, {}, true, flattened_fields);
         }
 
-        index_record record(num_found_docs, seq_id, document, index_operation_t::CREATE, DIRTY_VALUES::COERCE_OR_DROP);
+        index_record record(num_found_docs, seq_id, std::move(document), index_operation_t::CREATE,
+                            DIRTY_VALUES::COERCE_OR_DROP);
         iter_batch.emplace_back(std::move(record));
 
         // Peek and check for last record right here so that we handle batched indexing correctly
@@ -5025,6 +5112,9 @@ Option<bool> Collection::batch_alter_data(const std::vector<field>& alter_fields
     index->refresh_schemas({}, del_fields);
     index->refresh_schemas({}, garbage_embedding_fields_vec);
 
+    // searches that ran while the documents were being altered must not be served from the cache afterwards
+    bump_write_generation();
+
     auto persist_op = persist_collection_meta();
     if(!persist_op.ok()) {
         return persist_op;
@@ -6514,7 +6604,7 @@ Option<bool> Collection::truncate_after_top_k(const string &field_name, size_t k
 
 void Collection::reference_populate_sort_mapping(int *sort_order, std::vector<size_t> &geopoint_indices,
                                                  std::vector<sort_by> &sort_fields_std,
-                                                 std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32> *, 3> &field_values)
+                                                 std::array<sort_column_t *, 3> &field_values)
                                                  const {
     std::shared_lock lock(mutex);
     index->populate_sort_mapping_with_lock(sort_order, geopoint_indices, sort_fields_std, field_values);
@@ -6595,6 +6685,89 @@ void Collection::do_housekeeping() {
     index->repair_hnsw_index();
 }
 
+Option<bool> Collection::save_vector_indices(const std::string& dir_path, nlohmann::json& manifest,
+                                             size_t& max_elements) const {
+    std::shared_lock lock(mutex);
+
+    // caller must ensure that writes are paused, so every seq_id below this watermark is already in the graphs
+    const uint32_t seq_id_watermark = next_seq_id.load();
+
+    for(const auto& a_field: search_schema) {
+        if(!a_field.index || a_field.num_dim == 0) {
+            continue;
+        }
+
+        const std::string file_name = std::to_string(collection_id.load()) + "_" +
+                                      std::to_string(StringUtils::hash_wy(a_field.name.c_str(), a_field.name.size())) +
+                                      ".hnsw";
+
+        auto save_op = index->save_vector_index(a_field.name, dir_path + "/" + file_name, max_elements);
+        if(!save_op.ok()) {
+            return save_op;
+        }
+
+        if(!save_op.get()) {
+            LOG(INFO) << "Not persisting vector index of field `" << a_field.name << "` in collection " << name
+                      << " since it exceeds the vector index snapshot limit. It will be rebuilt on load.";
+            continue;
+        }
+
+        nlohmann::json entry;
+        entry["collection"] = name;
+        entry["field"] = a_field.name;
+        entry["file"] = file_name;
+        entry["num_dim"] = a_field.num_dim;
+        entry["vec_dist"] = int(a_field.vec_dist);
+        entry["hnsw_params"] = a_field.hnsw_params;
+        entry["seq_id_watermark"] = seq_id_watermark;
+        manifest.push_back(entry);
+    }
+
+    return Option<bool>(true);
+}
+
+void Collection::load_vector_indices(const std::string& dir_path, const nlohmann::json& manifest) {
+    std::shared_lock lock(mutex);
+
+    for(const auto& entry: manifest) {
+        if(!entry.is_object() || entry.value("collection", "") != name) {
+            continue;
+        }
+
+        const std::string& field_name = entry.value("field", "");
+        auto field_it = search_schema.find(field_name);
+
+        if(field_it == search_schema.end() || !field_it->index || field_it->num_dim == 0 ||
+           entry.value("num_dim", 0u) != field_it->num_dim || entry.value("vec_dist", -1) != int(field_it->vec_dist) ||
+           entry.value("hnsw_params", nlohmann::json::object()) != field_it->hnsw_params) {
+            LOG(INFO) << "Ignoring persisted vector index of field `" << field_name << "` in collection " << name
+                      << " since it does not match the schema.";
+            continue;
+        }
+
+        const uint32_t seq_id_watermark = entry.value("seq_id_watermark", 0u);
+        if(seq_id_watermark > next_seq_id.load()) {
+            LOG(INFO) << "Ignoring persisted vector index of field `" << field_name << "` in collection " << name
+                      << " since it is ahead of the stored documents.";
+            continue;
+        }
+
+        auto load_op = index->load_vector_index(field_name, dir_path + "/" + entry.value("file", ""),
+                                                seq_id_watermark);
+        if(!load_op.ok()) {
+            LOG(ERROR) << load_op.error() << " Vector index will be rebuilt.";
+            continue;
+        }
+
+        LOG(INFO) << "Restored vector index of field `" << field_name << "` in collection " << name
+                  << " with seq_id watermark " << seq_id_watermark;
+    }
+}
+
+void Collection::clear_restored_vector_watermarks() {
+    index->clear_restored_vector_watermarks();
+}
+
 Option<bool> Collection::parse_and_validate_vector_query(const std::string& vector_query_str,
                                                          vector_query_t& vector_query,
                                                          const bool is_wildcard_query,
@@ -6646,8 +6819,8 @@ Option<bool> Collection::parse_and_validate_vector_query(const std::string& vect
                 }
             }
 
-            std::string embed_query = embedder_manager.get_query_prefix(vector_field_it.value().embed[fields::model_config]) + q;
-            auto embedding_op = embedder->Embed(embed_query, remote_embedding_timeout_ms, remote_embedding_num_tries);
+            auto embedding_op = embedder_manager.embed_query(embedder, vector_field_it.value().embed[fields::model_config], q,
+                                                               remote_embedding_timeout_ms, remote_embedding_num_tries);
 
             if(!embedding_op.success) {
                 if(!embedding_op.error["error"].get<std::string>().empty()) {
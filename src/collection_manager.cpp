@@ -1,5 +1,7 @@
 #include <string>
 #include <vector>
+#include <fstream>
+#include <thread>
 #include <json.hpp>
 #include <app_metrics.h>
 #include <analytics_manager.h>
@@ -258,7 +260,8 @@ void CollectionManager::_populate_referenced_ins(const std::string& collection_m
     }
 }
 
-Option<bool> CollectionManager::load(const size_t collection_batch_size, const size_t document_batch_size) {
+Option<bool> CollectionManager::load(const size_t collection_batch_size, const size_t document_batch_size,
+                                     const std::string& vector_index_dir) {
     // This function must be idempotent, i.e. when called multiple times, must produce the same state without leaks
     LOG(INFO) << "CollectionManager::load()";
 
@@ -307,6 +310,20 @@ Option<bool> CollectionManager::load(const size_t collection_batch_size, const s
     const size_t num_collections = collection_meta_jsons.size();
     LOG(INFO) << "Found " << num_collections << " collection(s) on disk.";
 
+    nlohmann::json vector_index_manifest = nlohmann::json::array();
+    const std::string vector_index_manifest_path = vector_index_dir + "/" + VECTOR_INDEX_MANIFEST_FILE;
+
+    if(!vector_index_dir.empty() && file_exists(vector_index_manifest_path)) {
+        std::ifstream manifest_file(vector_index_manifest_path);
+        vector_index_manifest = nlohmann::json::parse(manifest_file, nullptr, false);
+        if(vector_index_manifest.is_discarded() || !vector_index_manifest.is_array()) {
+            LOG(ERROR) << "Error while parsing vector index manifest, vector indices will be rebuilt.";
+            vector_index_manifest = nlohmann::json::array();
+        } else {
+            LOG(INFO) << "Found " << vector_index_manifest.size() << " persisted vector index(es).";
+        }
+    }
+
     ThreadPool loading_pool(collection_batch_size);
 
     // Collection name -> Ref collection name -> Ref field name
@@ -333,11 +350,12 @@ Option<bool> CollectionManager::load(const size_t collection_batch_size, const s
         auto captured_store = store;
         loading_pool.enqueue([captured_store, num_collections, collection_meta, document_batch_size,
                               &m_process, &cv_process, &num_processed, &next_coll_id_status, quit = quit,
-                                     &referenced_ins, collection_name]() {
+                                     &referenced_ins, collection_name, &vector_index_dir, &vector_index_manifest]() {
 
             //auto begin = std::chrono::high_resolution_clock::now();
             Option<bool> res = load_collection(collection_meta, document_batch_size, next_coll_id_status, *quit,
-                                               referenced_ins[collection_name]);
+                                               referenced_ins[collection_name], vector_index_dir,
+                                               vector_index_manifest);
             /*long long int timeMillis =
                     std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - begin).count();
             LOG(INFO) << "Time taken for indexing: " << timeMillis << "ms";*/
@@ -2103,11 +2121,101 @@ Option<Collection*> CollectionManager::create_collection(nlohmann::json& req_jso
                                                                 model, req_json[METADATA]);
 }
 
+void CollectionManager::read_doc_range(Store* store, Collection* collection, const std::string& seq_id_prefix,
+                                       doc_load_state_t& state, const size_t range_index, const size_t batch_size,
+                                       const size_t batch_mem_threshold, const std::atomic<bool>& quit) {
+    doc_load_range_t& range = *state.ranges[range_index];
+
+    rocksdb::Slice upper_bound(range.upper_bound_key);
+    rocksdb::Iterator* iter = store->scan(range.start_key, &upper_bound);
+    std::unique_ptr<rocksdb::Iterator> iter_guard(iter);
+
+    doc_load_batch_t batch;
+    Option<bool> status(true);
+
+    // waits until the parsed document fits into the memory shared by all readers, returns false on abort
+    auto reserve_bytes = [&](size_t num_bytes) {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.cv.wait(lock, [&]() {
+            // the range that is being indexed goes on when the indexer runs out of its batches, since the memory can
+            // be held by the ranges after it, which are not indexed before it
+            return state.abort || state.num_buffered_bytes + num_bytes <= state.max_buffered_bytes ||
+                   (state.current_range == range_index && range.batches.empty());
+        });
+
+        if(state.abort) {
+            return false;
+        }
+
+        state.num_buffered_bytes += num_bytes;
+        batch.num_bytes += num_bytes;
+        return true;
+    };
+
+    auto push_batch = [&]() {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.cv.wait(lock, [&]() { return range.batches.size() < DOC_LOAD_MAX_QUEUED_BATCHES || state.abort; });
+        range.batches.push_back(std::move(batch));
+        lock.unlock();
+        state.cv.notify_all();
+
+        batch = doc_load_batch_t();
+    };
+
+    while(iter->Valid() && iter->key().starts_with(seq_id_prefix) && !quit) {
+        const uint32_t seq_id = Collection::get_seq_id_from_key(iter->key().ToString());
+        const rocksdb::Slice& doc_slice = iter->value();
+
+        // parsed document takes up about 7 times the size of its JSON
+        if(!reserve_bytes(doc_slice.size() * 7)) {
+            break;
+        }
+
+        nlohmann::json document;
+
+        try {
+            document = nlohmann::json::parse(doc_slice.data(), doc_slice.data() + doc_slice.size());
+        } catch(const std::exception& e) {
+            LOG(ERROR) << "JSON error: " << e.what();
+            status = Option<bool>(400, "Bad JSON.");
+            break;
+        }
+
+        if(collection->get_enable_nested_fields()) {
+            std::vector<field> flattened_fields;
+            field::flatten_doc(document, collection->get_nested_fields(), {}, true, flattened_fields);
+        }
+
+        auto dirty_values = DIRTY_VALUES::COERCE_OR_DROP;
+        batch.index_records.emplace_back(index_record(0, seq_id, std::move(document), CREATE, dirty_values));
+
+        if(batch.num_bytes > batch_mem_threshold || batch.index_records.size() == batch_size) {
+            push_batch();
+        }
+
+        iter->Next();
+    }
+
+    if(status.ok() && !batch.index_records.empty()) {
+        push_batch();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        range.status = std::move(status);
+        range.done = true;
+    }
+
+    state.cv.notify_all();
+}
+
 Option<bool> CollectionManager::load_collection(const nlohmann::json &collection_meta,
                                                 const size_t batch_size,
                                                 const StoreStatus& next_coll_id_status,
                                                 const std::atomic<bool>& quit,
-                                                spp::sparse_hash_map<std::string, std::string>& referenced_in) {
+                                                spp::sparse_hash_map<std::string, std::string>& referenced_in,
+                                                const std::string& vector_index_dir,
+                                                const nlohmann::json& vector_index_manifest) {
 
     auto& cm = CollectionManager::get_instance();
 
@@ -2186,91 +2294,147 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
         collection->add_synonym(collection_synonym, false);
     }
 
-    // Fetch records from the store and re-create memory index
+    // restore persisted vector graphs, so that only documents written after they were saved are added to them
+    if(!vector_index_manifest.empty()) {
+        collection->load_vector_indices(vector_index_dir, vector_index_manifest);
+    }
+
+    // Fetch records from the store and re-create memory index.
+    // The seq_id key space is split into ranges that are read and parsed concurrently by reader threads, while the
+    // parsed batches are indexed on this thread in seq_id order.
     const std::string seq_id_prefix = collection->get_seq_id_collection_prefix();
-    std::string upper_bound_key = collection->get_seq_id_collection_prefix() + "`";  // cannot inline this
-    rocksdb::Slice upper_bound(upper_bound_key);
+    const size_t num_readers = std::max<size_t>(1, std::min<size_t>(DOC_LOAD_NUM_READERS,
+                                                                    collection_next_seq_id / std::max<size_t>(1, batch_size)));
 
-    rocksdb::Iterator* iter = cm.store->scan(seq_id_prefix, &upper_bound);
-    std::unique_ptr<rocksdb::Iterator> iter_guard(iter);
+    // the readers share a memory budget, in which each of them can fill its queue and a batch in progress
+    doc_load_state_t state;
+    state.max_buffered_bytes = DOC_LOAD_MAX_BUFFERED_BYTES;
+    const size_t batch_mem_threshold = DOC_LOAD_MAX_BUFFERED_BYTES / (num_readers * (DOC_LOAD_MAX_QUEUED_BATCHES + 1));
 
-    std::vector<index_record> index_records;
+    const uint32_t range_size = (collection_next_seq_id + num_readers - 1) / num_readers;
 
+    for(size_t i = 0; i < num_readers; i++) {
+        auto range = std::make_unique<doc_load_range_t>();
+        range->start_key = (i == 0) ? seq_id_prefix : collection->get_seq_id_key(i * range_size);
+        range->upper_bound_key = (i == num_readers - 1) ? seq_id_prefix + "`" :
+                                 collection->get_seq_id_key((i + 1) * range_size);
+        state.ranges.push_back(std::move(range));
+    }
+
+    std::vector<std::thread> readers;
     size_t num_found_docs = 0;
-    size_t num_valid_docs = 0;
     size_t num_indexed_docs = 0;
-    size_t batch_doc_str_size = 0;
+    Option<bool> load_op(true);
+
+    // An exception must not skip joining the readers below, since destroying a joinable thread terminates the process.
+    try {
+        for(size_t i = 0; i < num_readers; i++) {
+            readers.emplace_back([&cm, collection, &seq_id_prefix, &state, i, batch_size, batch_mem_threshold,
+                                  &quit]() {
+                try {
+                    read_doc_range(cm.store, collection, seq_id_prefix, state, i, batch_size, batch_mem_threshold,
+                                   quit);
+                } catch(const std::exception& e) {
+                    LOG(ERROR) << "Error while reading documents: " << e.what();
+
+                    {
+                        std::unique_lock<std::mutex> lock(state.mutex);
+                        state.ranges[i]->status = Option<bool>(500, std::string("Error while reading documents: ") +
+                                                                    e.what());
+                        state.ranges[i]->done = true;
+                    }
 
-    auto begin = std::chrono::high_resolution_clock::now();
+                    state.cv.notify_all();
+                }
+            });
+        }
 
-    while(iter->Valid() && iter->key().starts_with(seq_id_prefix)) {
-        num_found_docs++;
-        const uint32_t seq_id = Collection::get_seq_id_from_key(iter->key().ToString());
+        auto begin = std::chrono::high_resolution_clock::now();
 
-        nlohmann::json document;
-        const std::string& doc_string = iter->value().ToString();
+        for(size_t i = 0; i < state.ranges.size() && load_op.ok(); i++) {
+            auto& range = *state.ranges[i];
 
-        try {
-            document = nlohmann::json::parse(doc_string);
-        } catch(const std::exception& e) {
-            LOG(ERROR) << "JSON error: " << e.what();
-            return Option<bool>(400, "Bad JSON.");
-        }
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.current_range = i;
+            }
 
-        batch_doc_str_size += doc_string.size();
+            state.cv.notify_all();
 
-        if(collection->get_enable_nested_fields()) {
-            std::vector<field> flattened_fields;
-            field::flatten_doc(document, collection->get_nested_fields(), {}, true, flattened_fields);
-        }
+            while(load_op.ok()) {
+                doc_load_batch_t batch;
 
-        auto dirty_values = DIRTY_VALUES::COERCE_OR_DROP;
+                {
+                    std::unique_lock<std::mutex> lock(state.mutex);
+                    state.cv.wait(lock, [&range]() { return !range.batches.empty() || range.done; });
+
+                    if(range.batches.empty()) {
+                        if(!range.status.ok()) {
+                            load_op = Option<bool>(range.status.code(), range.status.error());
+                        }
+                        break;
+                    }
 
-        num_valid_docs++;
+                    batch = std::move(range.batches.front());
+                    range.batches.pop_front();
+                }
 
-        index_records.emplace_back(index_record(0, seq_id, document, CREATE, dirty_values));
+                state.cv.notify_all();
 
-        // Peek and check for last record right here so that we handle batched indexing correctly
-        // Without doing this, the "last batch" would have to be indexed outside the loop.
-        iter->Next();
-        bool last_record = !(iter->Valid() && iter->key().starts_with(seq_id_prefix));
+                auto& index_records = batch.index_records;
+                num_found_docs += index_records.size();
+                size_t num_records = index_records.size();
+                size_t num_indexed = collection->batch_index_in_memory(index_records, 200, 60000, 2, false);
 
-        // if expected memory usage exceeds 250M, we index the accumulated set without caring about batch size
-        bool exceeds_batch_mem_threshold = ((batch_doc_str_size * 7) > (250 * 1014 * 1024));
+                {
+                    std::unique_lock<std::mutex> lock(state.mutex);
+                    state.num_buffered_bytes -= batch.num_bytes;
+                }
 
-        // batch must match atleast the number of shards
-         if(exceeds_batch_mem_threshold || (num_valid_docs % batch_size == 0) || last_record) {
-            size_t num_records = index_records.size();
-            size_t num_indexed = collection->batch_index_in_memory(index_records, 200, 60000, 2, false);
-            batch_doc_str_size = 0;
+                state.cv.notify_all();
 
-            if(num_indexed != num_records) {
-                const Option<std::string> & index_error_op = get_first_index_error(index_records);
-                if(!index_error_op.ok()) {
-                    return Option<bool>(400, index_error_op.get());
+                if(num_indexed != num_records) {
+                    const Option<std::string> & index_error_op = get_first_index_error(index_records);
+                    if(!index_error_op.ok()) {
+                        load_op = Option<bool>(400, index_error_op.get());
+                        break;
+                    }
                 }
-            }
 
-            index_records.clear();
-            num_indexed_docs += num_indexed;
-        }
+                num_indexed_docs += num_indexed;
 
-        if(num_found_docs % ((1 << 14)) == 0) {
-            // having a cheaper higher layer check to prevent checking clock too often
-            auto time_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::high_resolution_clock::now() - begin).count();
+                auto time_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+                        std::chrono::high_resolution_clock::now() - begin).count();
 
-            if(time_elapsed > 30) {
-                begin = std::chrono::high_resolution_clock::now();
-                LOG(INFO) << "Loaded " << num_found_docs << " documents from " << collection->get_name() << " so far.";
+                if(time_elapsed > 30) {
+                    begin = std::chrono::high_resolution_clock::now();
+                    LOG(INFO) << "Loaded " << num_found_docs << " documents from " << collection->get_name()
+                              << " so far.";
+                }
             }
         }
+    } catch(const std::exception& e) {
+        LOG(ERROR) << "Error while indexing documents of collection " << collection->get_name() << ": " << e.what();
+        load_op = Option<bool>(500, std::string("Error while indexing documents: ") + e.what());
+    }
 
-        if(quit) {
-            break;
-        }
+    // unblock readers that are waiting on a full queue or on memory
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.abort = true;
+    }
+
+    state.cv.notify_all();
+
+    for(auto& reader: readers) {
+        reader.join();
+    }
+
+    if(!load_op.ok()) {
+        return load_op;
     }
 
+    collection->clear_restored_vector_watermarks();
     cm.add_to_collections(collection);
 
     LOG(INFO) << "Indexed " << num_indexed_docs << "/" << num_found_docs
@@ -2279,6 +2443,30 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
     return Option<bool>(true);
 }
 
+Option<bool> CollectionManager::save_vector_indices(const std::string& dir_path, size_t max_elements) const {
+    std::shared_lock lock(mutex);
+
+    nlohmann::json manifest = nlohmann::json::array();
+
+    for(const auto& kv: collections) {
+        auto save_op = kv.second->save_vector_indices(dir_path, manifest, max_elements);
+        if(!save_op.ok()) {
+            return save_op;
+        }
+    }
+
+    std::ofstream manifest_file(dir_path + "/" + VECTOR_INDEX_MANIFEST_FILE);
+    manifest_file << manifest.dump();
+    manifest_file.close();
+
+    if(manifest_file.fail()) {
+        return Option<bool>(500, "Error while writing vector index manifest.");
+    }
+
+    LOG(INFO) << "Saved " << manifest.size() << " vector index(es) to " << dir_path;
+    return Option<bool>(true);
+}
+
 spp::sparse_hash_map<std::string, nlohmann::json> CollectionManager::get_presets() const {
     std::shared_lock lock(mutex);
     return preset_configs;
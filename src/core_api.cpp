@@ -19,6 +19,7 @@
 #include "conversation_manager.h"
 #include "conversation_model_manager.h"
 #include "conversation_model.h"
+#include "embedder_manager.h"
 
 using namespace std::chrono_literals;
 
@@ -407,6 +408,8 @@ bool get_stats_json(const std::shared_ptr<http_req>& req, const std::shared_ptr<
     nlohmann::json result;
     AppMetrics::get_instance().get("requests_per_second", "latency_ms", result);
     result["pending_write_batches"] = server->get_num_queued_writes();
+    result["embedding_inference"] = EmbedderManager::get_instance().get_inference_stats();
+    result["query_embedding_cache"] = EmbedderManager::get_instance().get_query_embedding_cache_stats();
 
     res->set_body(200, result.dump(2));
     return true;
@@ -418,49 +421,260 @@ bool get_status(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
     return true;
 }
 
-uint64_t hash_request(const std::shared_ptr<http_req>& req) {
+// Keyword search matches query text case insensitively and splits it on whitespace, so queries that differ only in
+// case or spacing produce the same hits.
+std::string normalize_cache_query(const std::string& q) {
+    std::string normalized;
+    normalized.reserve(q.size());
+
+    for(const char c: q) {
+        if(std::isspace(static_cast<unsigned char>(c))) {
+            if(!normalized.empty() && normalized.back() != ' ') {
+                normalized += ' ';
+            }
+        } else {
+            normalized += std::tolower(static_cast<unsigned char>(c));
+        }
+    }
+
+    if(!normalized.empty() && normalized.back() == ' ') {
+        normalized.pop_back();
+    }
+
+    return normalized;
+}
+
+// Semantic and hybrid searches embed the query text as given, and cased models embed "Apple" and "apple" differently:
+// the query is kept verbatim in the key when it searches an embedding field or comes with a vector query.
+bool is_embedded_search_query(const std::shared_ptr<http_req>& req) {
+    std::vector<std::string> query_by_values;
+
+    auto collect_params = [&](const auto& params) -> bool {
+        if(params.count("vector_query") != 0) {
+            return true;
+        }
+
+        const auto query_by_it = params.find("query_by");
+        if(query_by_it != params.end()) {
+            query_by_values.push_back(query_by_it->second);
+        }
+
+        return false;
+    };
+
+    if(collect_params(req->params)) {
+        return true;
+    }
+
+    for(const auto& embedded_params: req->embedded_params_vec) {
+        if(!embedded_params.is_object()) {
+            continue;
+        }
+
+        if(embedded_params.count("vector_query") != 0) {
+            return true;
+        }
+
+        if(embedded_params.count("query_by") != 0 && embedded_params["query_by"].is_string()) {
+            query_by_values.push_back(embedded_params["query_by"].get<std::string>());
+        }
+    }
+
+    const auto collection_it = req->params.find("collection");
+    if(query_by_values.empty() || collection_it == req->params.end()) {
+        return false;
+    }
+
+    auto collection = CollectionManager::get_instance().get_collection(collection_it->second);
+    if(collection == nullptr) {
+        return false;
+    }
+
+    const auto& embedding_fields = collection->get_embedding_fields();
+    if(embedding_fields.empty()) {
+        return false;
+    }
+
+    for(const auto& query_by: query_by_values) {
+        std::vector<std::string> query_by_fields;
+        StringUtils::split(query_by, query_by_fields, ",");
+
+        for(const auto& field_name: query_by_fields) {
+            // a wildcard can expand to an embedding field
+            if(field_name.find('*') != std::string::npos || embedding_fields.count(field_name) != 0) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Mixes the identity and write generation of the searched collections into the key: any write makes the responses
+// cached before it unreachable, instead of serving them until their TTL lapses. Join queries read other collections
+// too, so they depend on the generation of every collection.
+void append_write_generations(std::stringstream& ss, const std::set<std::string>& collection_names) {
+    CollectionManager& collectionManager = CollectionManager::get_instance();
+
+    for(const auto& collection_name: collection_names) {
+        auto collection = collectionManager.get_collection(collection_name);
+        if(collection == nullptr) {
+            ss << "|-";
+            continue;
+        }
+
+        ss << "|" << collection->get_collection_id() << ":" << collection->get_write_generation();
+    }
+
+    if(ss.str().find('$') != std::string::npos) {
+        ss << "|" << Collection::get_global_write_generation();
+    }
+}
+
+// Parameters that do not affect the response are left out of the key and the query is normalized.
+uint64_t hash_search_request(const std::shared_ptr<http_req>& req) {
     std::stringstream ss;
-    ss << req->route_hash << req->body;
+    ss << req->route_hash;
+
+    const bool normalize_query = req->params.count("conversation") == 0 && !is_embedded_search_query(req);
+
+    for(const auto& kv: req->params) {
+        if(kv.first == "use_cache" || kv.first == "cache_ttl") {
+            continue;
+        }
+
+        ss << kv.first << "=" << ((kv.first == "q" && normalize_query) ? normalize_cache_query(kv.second) : kv.second)
+           << "&";
+    }
+
+    for(const auto& embedded_params: req->embedded_params_vec) {
+        ss << embedded_params.dump();
+    }
+
+    const auto collection_it = req->params.find("collection");
+    append_write_generations(ss, {collection_it == req->params.end() ? "" : collection_it->second});
+
+    const std::string& req_str = ss.str();
+    return StringUtils::hash_wy(req_str.c_str(), req_str.size());
+}
+
+// Multi search queries are kept verbatim (they can feed a conversation), but the body is canonicalized so that key
+// order and formatting of the searches do not matter.
+uint64_t hash_multi_search_request(const std::shared_ptr<http_req>& req) {
+    std::stringstream ss;
+    ss << req->route_hash;
+
+    for(const auto& kv: req->params) {
+        if(kv.first == "use_cache" || kv.first == "cache_ttl") {
+            continue;
+        }
+
+        ss << kv.first << "=" << kv.second << "&";
+    }
+
+    for(const auto& embedded_params: req->embedded_params_vec) {
+        ss << embedded_params.dump();
+    }
+
+    std::set<std::string> collection_names;
+    const auto collection_it = req->params.find("collection");
+    const std::string common_collection = (collection_it == req->params.end()) ? "" : collection_it->second;
 
-    for(auto& kv: req->params) {
-        if(kv.first != "use_cache") {
-            ss << kv.second;
+    nlohmann::json req_json = nlohmann::json::parse(req->body, nullptr, false);
+    if(req_json.is_discarded()) {
+        ss << req->body;
+    } else {
+        ss << req_json.dump();
+    }
+
+    if(req_json.is_object() && req_json.count("searches") != 0 && req_json["searches"].is_array()) {
+        for(const auto& search: req_json["searches"]) {
+            if(search.is_object() && search.count("collection") != 0 && search["collection"].is_string()) {
+                collection_names.insert(search["collection"].get<std::string>());
+            } else {
+                collection_names.insert(common_collection);
+            }
         }
+    } else {
+        collection_names.insert(common_collection);
     }
 
+    append_write_generations(ss, collection_names);
+
     const std::string& req_str = ss.str();
     return StringUtils::hash_wy(req_str.c_str(), req_str.size());
 }
 
+// Returns the cached response for the key when it exists and has not expired.
+bool find_cached_response(const uint64_t req_hash, cached_res_t& cached_res) {
+    std::unique_lock lock(mutex);
+    auto hit_it = res_cache.find(req_hash);
+    if(hit_it == res_cache.end()) {
+        return false;
+    }
+
+    const auto& cached_value = hit_it.value();
+
+    // we still need to check that TTL has not expired
+    uint64_t seconds_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::high_resolution_clock::now() - cached_value.created_at).count();
+
+    if(seconds_elapsed >= cached_value.ttl) {
+        // Result found in cache but ttl has lapsed.
+        res_cache.erase(req_hash);
+        return false;
+    }
+
+    cached_res = cached_value;
+    return true;
+}
+
+void cache_response(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res,
+                    const uint64_t req_hash, const std::string& raw_query) {
+    //LOG(INFO) << "Adding to cache, key = " << req_hash;
+    auto now = std::chrono::high_resolution_clock::now();
+    const auto cache_ttl_it = req->params.find("cache_ttl");
+    uint32_t cache_ttl = 60;
+    if(cache_ttl_it != req->params.end() && StringUtils::is_int32_t(cache_ttl_it->second)) {
+        cache_ttl = std::stoul(cache_ttl_it->second);
+    }
+
+    cached_res_t cached_res;
+    cached_res.load(res->status_code, res->content_type_header, res->body, now, cache_ttl, req_hash);
+    cached_res.raw_query = raw_query;
+
+    std::unique_lock lock(mutex);
+    res_cache.insert(req_hash, cached_res);
+}
+
 bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
     const auto use_cache_it = req->params.find("use_cache");
     bool use_cache = (use_cache_it != req->params.end()) && (use_cache_it->second == "1" || use_cache_it->second == "true");
     uint64_t req_hash = 0;
 
+    const auto q_it = req->params.find("q");
+    const std::string raw_query = (q_it == req->params.end()) ? "" : q_it->second;
+
     if(use_cache) {
         // cache enabled, let's check if request is already in the cache
-        req_hash = hash_request(req);
+        req_hash = hash_search_request(req);
 
         //LOG(INFO) << "req_hash = " << req_hash;
 
-        std::unique_lock lock(mutex);
-        auto hit_it = res_cache.find(req_hash);
-        if(hit_it != res_cache.end()) {
+        cached_res_t cached_value;
+        if(find_cached_response(req_hash, cached_value)) {
             //LOG(INFO) << "Result found in cache.";
-            const auto& cached_value = hit_it.value();
-
-            // we still need to check that TTL has not expired
-            uint32_t ttl = cached_value.ttl;
-            uint64_t seconds_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::high_resolution_clock::now() - cached_value.created_at).count();
-
-            if(seconds_elapsed < cached_value.ttl) {
-                res->set_content(cached_value.status_code, cached_value.content_type_header, cached_value.body, true);
-                return true;
+            if(cached_value.raw_query != raw_query) {
+                // the cached response was produced by an equivalent query: echo back the query that was sent
+                nlohmann::json cached_json = nlohmann::json::parse(cached_value.body, nullptr, false);
+                if(cached_json.is_object() && cached_json.count("request_params") != 0) {
+                    cached_json["request_params"]["q"] = raw_query;
+                    cached_value.body = cached_json.dump();
+                }
             }
 
-            // Result found in cache but ttl has lapsed.
-            res_cache.erase(req_hash);
+            res->set_content(cached_value.status_code, cached_value.content_type_header, cached_value.body, true);
+            return true;
         }
     }
 
@@ -485,19 +699,7 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
 
     // we will cache only successful requests
     if(use_cache) {
-        //LOG(INFO) << "Adding to cache, key = " << req_hash;
-        auto now = std::chrono::high_resolution_clock::now();
-        const auto cache_ttl_it = req->params.find("cache_ttl");
-        uint32_t cache_ttl = 60;
-        if(cache_ttl_it != req->params.end() && StringUtils::is_int32_t(cache_ttl_it->second)) {
-            cache_ttl = std::stoul(cache_ttl_it->second);
-        }
-
-        cached_res_t cached_res;
-        cached_res.load(res->status_code, res->content_type_header, res->body, now, cache_ttl, req_hash);
-
-        std::unique_lock lock(mutex);
-        res_cache.insert(req_hash, cached_res);
+        cache_response(req, res, req_hash, raw_query);
     }
 
     return true;
@@ -510,28 +712,15 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
 
     if(use_cache) {
         // cache enabled, let's check if request is already in the cache
-        req_hash = hash_request(req);
+        req_hash = hash_multi_search_request(req);
 
         //LOG(INFO) << "req_hash = " << req_hash;
 
-        std::unique_lock lock(mutex);
-        auto hit_it = res_cache.find(req_hash);
-        if(hit_it != res_cache.end()) {
+        cached_res_t cached_value;
+        if(find_cached_response(req_hash, cached_value)) {
             //LOG(INFO) << "Result found in cache.";
-            const auto& cached_value = hit_it.value();
-
-            // we still need to check that TTL has not expired
-            uint32_t ttl = cached_value.ttl;
-            uint64_t seconds_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::high_resolution_clock::now() - cached_value.created_at).count();
-
-            if(seconds_elapsed < cached_value.ttl) {
-                res->set_content(cached_value.status_code, cached_value.content_type_header, cached_value.body, true);
-                return true;
-            }
-
-            // Result found in cache but ttl has lapsed.
-            res_cache.erase(req_hash);
+            res->set_content(cached_value.status_code, cached_value.content_type_header, cached_value.body, true);
+            return true;
         }
     }
 
@@ -910,19 +1099,7 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
 
     // we will cache only successful requests
     if(use_cache) {
-        //LOG(INFO) << "Adding to cache, key = " << req_hash;
-        auto now = std::chrono::high_resolution_clock::now();
-        const auto cache_ttl_it = req->params.find("cache_ttl");
-        uint32_t cache_ttl = 60;
-        if(cache_ttl_it != req->params.end() && StringUtils::is_int32_t(cache_ttl_it->second)) {
-            cache_ttl = std::stoul(cache_ttl_it->second);
-        }
-
-        cached_res_t cached_res;
-        cached_res.load(res->status_code, res->content_type_header, res->body, now, cache_ttl, req_hash);
-
-        std::unique_lock lock(mutex);
-        res_cache.insert(req_hash, cached_res);
+        cache_response(req, res, req_hash, "");
     }
 
     return true;
@@ -1206,35 +1383,9 @@ bool post_import_documents(const std::shared_ptr<http_req>& req, const std::shar
     //LOG(INFO) << "Import, " << "req->body_index=" << req->body_index << ", req->body.size: " << req->body.size();
     //LOG(INFO) << "req body %: " << (float(req->body_index)/req->body.size())*100;
 
+    // a trailing partial record is left in `req->body` for the next chunk
     std::vector<std::string> json_lines;
-    StringUtils::split(req->body, json_lines, "\n", false, false);
-
-    //LOG(INFO) << "json_lines.size before: " << json_lines.size() << ", req->body_index: " << req->body_index;
-
-    if(req->last_chunk_aggregate) {
-        //LOG(INFO) << "req->last_chunk_aggregate is true";
-        req->body = "";
-    } else {
-        if(!json_lines.empty()) {
-            // check if req->body had complete last record
-            bool complete_document;
-
-            try {
-                nlohmann::json document = nlohmann::json::parse(json_lines.back());
-                complete_document = document.is_object();
-            } catch(const std::exception& e) {
-                complete_document = false;
-            }
-
-            if(!complete_document) {
-                // eject partial record
-                req->body = json_lines.back();
-                json_lines.pop_back();
-            } else {
-                req->body = "";
-            }
-        }
-    }
+    StringUtils::split_json_lines(req->body, json_lines, req->last_chunk_aggregate);
 
     //LOG(INFO) << "json_lines.size after: " << json_lines.size() << ", stream_proceed: " << stream_proceed;
     //LOG(INFO) << "json_lines.size: " << json_lines.size() << ", req->res_state: " << req->res_state;
@@ -1284,7 +1435,8 @@ bool post_import_documents(const std::shared_ptr<http_req>& req, const std::shar
     return true;
 }
 
-bool post_add_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
+static bool parse_add_document_params(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res,
+                                      size_t& remote_embedding_timeout_ms, size_t& remote_embedding_num_tries) {
     const char *ACTION = "action";
     const char *DIRTY_VALUES_PARAM = "dirty_values";
 
@@ -1302,29 +1454,58 @@ bool post_add_document(const std::shared_ptr<http_req>& req, const std::shared_p
         req->params[DIRTY_VALUES_PARAM] = "";  // set it empty as default will depend on whether schema is enabled
     }
 
+    remote_embedding_timeout_ms = 60000;
+    remote_embedding_num_tries = 2;
 
-    CollectionManager & collectionManager = CollectionManager::get_instance();
-    auto collection = collectionManager.get_collection(req->params["collection"]);
+    if(req->params.count("remote_embedding_timeout_ms") != 0) {
+        remote_embedding_timeout_ms = std::stoul(req->params["remote_embedding_timeout_ms"]);
+    }
 
-    if(collection == nullptr) {
-        res->set_404();
-        return false;
+    if(req->params.count("remote_embedding_num_tries") != 0) {
+        remote_embedding_num_tries = std::stoul(req->params["remote_embedding_num_tries"]);
     }
 
-    const index_operation_t operation = get_index_operation(req->params[ACTION]);
-    const auto& dirty_values = collection->parse_dirty_values_option(req->params[DIRTY_VALUES_PARAM]);
+    return true;
+}
 
-    size_t remote_embedding_timeout_ms = 60000;
-    size_t remote_embedding_num_tries = 2;
+static void set_add_document_error(nlohmann::json& res_doc, const std::shared_ptr<http_res>& res) {
+    res->status_code = res_doc["code"].get<size_t>();
+    // erase keys from res_doc except error and embedding_error
+    for(auto it = res_doc.begin(); it != res_doc.end(); ) {
+        if(it.key() != "error" && it.key() != "embedding_error") {
+            it = res_doc.erase(it);
+        } else {
+            ++it;
+        }
+    }
 
-    if(req->params.count("remote_embedding_timeout_ms") != 0) {
-        remote_embedding_timeout_ms = std::stoul(req->params["remote_embedding_timeout_ms"]);
+    // rename error to message if not empty and exists
+    if(res_doc.count("error") != 0 && !res_doc["error"].get<std::string>().empty()) {
+        res_doc["message"] = res_doc["error"];
+        res_doc.erase("error");
     }
 
-    if(req->params.count("remote_embedding_num_tries") != 0) {
-        remote_embedding_num_tries = std::stoul(req->params["remote_embedding_num_tries"]);
+    res->body = res_doc.dump();
+}
+
+bool post_add_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
+    size_t remote_embedding_timeout_ms, remote_embedding_num_tries;
+
+    if(!parse_add_document_params(req, res, remote_embedding_timeout_ms, remote_embedding_num_tries)) {
+        return false;
     }
 
+    CollectionManager & collectionManager = CollectionManager::get_instance();
+    auto collection = collectionManager.get_collection(req->params["collection"]);
+
+    if(collection == nullptr) {
+        res->set_404();
+        return false;
+    }
+
+    const index_operation_t operation = get_index_operation(req->params["action"]);
+    const auto& dirty_values = collection->parse_dirty_values_option(req->params["dirty_values"]);
+
     nlohmann::json document;
     std::vector<std::string> json_lines = {req->body};
     const nlohmann::json& inserted_doc_op = collection->add_many(json_lines, document, operation, "", dirty_values,
@@ -1342,28 +1523,72 @@ bool post_add_document(const std::shared_ptr<http_req>& req, const std::shared_p
             return false;
         }
 
-        res->status_code = res_doc["code"].get<size_t>();
-        // erase keys from res_doc except error and embedding_error
-        for(auto it = res_doc.begin(); it != res_doc.end(); ) {
-            if(it.key() != "error" && it.key() != "embedding_error") {
-                it = res_doc.erase(it);
-            } else {
-                ++it;
-            }
+        set_add_document_error(res_doc, res);
+        return false;
+    }
+
+    res->set_201(document.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore));
+    return true;
+}
+
+void post_add_documents_coalesced(const std::vector<std::shared_ptr<http_req>>& reqs,
+                                  const std::vector<std::shared_ptr<http_res>>& ress) {
+    size_t remote_embedding_timeout_ms, remote_embedding_num_tries;
+
+    // the requests have the same parameters, so they all fail or pass their validation together
+    if(!parse_add_document_params(reqs[0], ress[0], remote_embedding_timeout_ms, remote_embedding_num_tries)) {
+        for(size_t i = 1; i < ress.size(); i++) {
+            ress[i]->status_code = ress[0]->status_code;
+            ress[i]->body = ress[0]->body;
         }
 
-        // rename error to message if not empty and exists
-        if(res_doc.count("error") != 0 && !res_doc["error"].get<std::string>().empty()) {
-            res_doc["message"] = res_doc["error"];
-            res_doc.erase("error");
+        return ;
+    }
+
+    CollectionManager & collectionManager = CollectionManager::get_instance();
+    auto collection = collectionManager.get_collection(reqs[0]->params["collection"]);
+
+    if(collection == nullptr) {
+        for(const auto& res: ress) {
+            res->set_404();
         }
 
-        res->body = res_doc.dump();
-        return false;
+        return ;
     }
 
-    res->set_201(document.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore));
-    return true;
+    const index_operation_t operation = get_index_operation(reqs[0]->params["action"]);
+    const auto& dirty_values = collection->parse_dirty_values_option(reqs[0]->params["dirty_values"]);
+
+    std::vector<std::string> json_lines;
+    json_lines.reserve(reqs.size());
+
+    for(const auto& req: reqs) {
+        json_lines.push_back(req->body);
+    }
+
+    nlohmann::json document;
+    collection->add_many(json_lines, document, operation, "", dirty_values, true, false, 200,
+                         remote_embedding_timeout_ms, remote_embedding_num_tries);
+
+    // every line now holds the outcome of its document
+    for(size_t i = 0; i < json_lines.size(); i++) {
+        nlohmann::json res_doc = nlohmann::json::parse(json_lines[i], nullptr, false);
+
+        if(res_doc.is_discarded()) {
+            ress[i]->set_400("Bad JSON.");
+            continue;
+        }
+
+        if(!res_doc["success"].get<bool>()) {
+            set_add_document_error(res_doc, ress[i]);
+            continue;
+        }
+
+        nlohmann::json& added_doc = res_doc["document"];
+        Collection::remove_flat_fields(added_doc);
+        Collection::remove_reference_helper_fields(added_doc);
+        ress[i]->set_201(added_doc.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore));
+    }
 }
 
 bool patch_update_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
@@ -53,9 +53,10 @@ Option<bool> EmbedderManager::validate_and_init_remote_model(const nlohmann::jso
     }
 
     std::unique_lock<std::mutex> lock(text_embedders_mutex);
-    std::string model_key = is_remote_model(model_name) ? RemoteEmbedder::get_model_key(model_config) : model_name;
+    std::string model_key = get_text_embedder_key(model_config);
     auto text_embedder_it = text_embedders.find(model_key);
     if(text_embedder_it == text_embedders.end()) {
+        query_embedding_cache.erase_model(model_key);
         text_embedders.emplace(model_key, std::make_shared<TextEmbedder>(model_config, num_dims, has_custom_dims));
     }
 
@@ -135,6 +136,7 @@ Option<bool> EmbedderManager::validate_and_init_local_model(const nlohmann::json
     }
 
     num_dims = embedder->get_num_dim();
+    query_embedding_cache.erase_model(model_name);
     text_embedders.emplace(model_name, embedder);
 
     // if model is clip, generate image embedder
@@ -147,8 +149,7 @@ Option<bool> EmbedderManager::validate_and_init_local_model(const nlohmann::json
 
 Option<TextEmbedder*> EmbedderManager::get_text_embedder(const nlohmann::json& model_config) {
     std::unique_lock<std::mutex> lock(text_embedders_mutex);
-    const std::string& model_name = model_config.at("model_name");
-    std::string model_key = is_remote_model(model_name) ? RemoteEmbedder::get_model_key(model_config) : model_name;
+    std::string model_key = get_text_embedder_key(model_config);
     auto text_embedder_it = text_embedders.find(model_key);
 
     if(text_embedder_it == text_embedders.end()) {
@@ -179,11 +180,64 @@ void EmbedderManager::delete_text_embedder(const std::string& model_path) {
     if (public_models.find(model_path) != public_models.end()) {
         public_models.erase(model_path);
     }
+
+    query_embedding_cache.erase_model(model_path);
 }
 
 void EmbedderManager::delete_all_text_embedders() {
     std::unique_lock<std::mutex> lock(text_embedders_mutex);
     text_embedders.clear();
+    query_embedding_cache.clear();
+}
+
+std::string EmbedderManager::get_text_embedder_key(const nlohmann::json& model_config) {
+    const std::string& model_name = model_config.at("model_name");
+    return is_remote_model(model_name) ? RemoteEmbedder::get_model_key(model_config) : model_name;
+}
+
+embedding_res_t EmbedderManager::embed_query(TextEmbedder* embedder, const nlohmann::json& model_config,
+                                             const std::string& query, const size_t remote_embedding_timeout_ms,
+                                             const size_t remote_embedding_num_tries) {
+    // the tokenizers of local models collapse whitespace, so queries that only differ in it can share an embedding,
+    // while a remote model is sent the query exactly as given
+    const std::string embed_query = get_query_prefix(model_config) +
+                                    (embedder->is_remote() ? query : query_embedding_cache_t::normalize_query(query));
+    const std::string model_key = get_text_embedder_key(model_config);
+
+    std::vector<float> embedding;
+    if(query_embedding_cache.find(model_key, embed_query, embedding)) {
+        return embedding_res_t(embedding);
+    }
+
+    auto embedding_op = embedder->Embed(embed_query, remote_embedding_timeout_ms, remote_embedding_num_tries);
+
+    // errors are not cached: remote ones are often transient
+    if(embedding_op.success) {
+        query_embedding_cache.insert(model_key, embed_query, embedding_op.embedding);
+    }
+
+    return embedding_op;
+}
+
+void EmbedderManager::set_query_embedding_cache_max_bytes(size_t max_bytes) {
+    query_embedding_cache.set_max_bytes(max_bytes);
+}
+
+nlohmann::json EmbedderManager::get_query_embedding_cache_stats() const {
+    return query_embedding_cache.get_stats();
+}
+
+nlohmann::json EmbedderManager::get_inference_stats() {
+    std::unique_lock<std::mutex> lock(text_embedders_mutex);
+    nlohmann::json stats = nlohmann::json::object();
+
+    for(const auto& kv: text_embedders) {
+        if(!kv.second->is_remote()) {
+            stats[kv.first] = kv.second->get_inference_stats();
+        }
+    }
+
+    return stats;
 }
 
 void EmbedderManager::delete_image_embedder(const std::string& model_path) {
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include "facet_column.h"
+
+void facet_column_t::upsert(uint32_t seq_id, const std::vector<uint32_t>& facet_ids) {
+    if(seq_id >= lengths.size()) {
+        // grow geometrically so that sequential inserts are amortized
+        size_t new_capacity = std::max<size_t>({MIN_CAPACITY, lengths.size() + (lengths.size() >> 1), size_t(seq_id) + 1});
+        offsets.resize(new_capacity, 0);
+        lengths.resize(new_capacity, 0);
+    }
+
+    if(lengths[seq_id] != 0) {
+        num_dead_values += lengths[seq_id];
+    } else if(!facet_ids.empty()) {
+        num_docs++;
+    }
+
+    if(facet_ids.empty()) {
+        if(lengths[seq_id] != 0) {
+            num_docs--;
+        }
+
+        lengths[seq_id] = 0;
+        return ;
+    }
+
+    if(facet_ids.size() == lengths[seq_id]) {
+        // overwrite in place
+        num_dead_values -= lengths[seq_id];
+        std::copy(facet_ids.begin(), facet_ids.end(), values.begin() + offsets[seq_id]);
+    } else {
+        offsets[seq_id] = values.size();
+        lengths[seq_id] = facet_ids.size();
+        values.insert(values.end(), facet_ids.begin(), facet_ids.end());
+    }
+
+    for(auto facet_id: facet_ids) {
+        min_facet_id = std::min(min_facet_id, facet_id);
+        max_facet_id = std::max(max_facet_id, facet_id);
+    }
+
+    if(num_dead_values > values.size() / 2) {
+        compact();
+    }
+}
+
+void facet_column_t::erase(uint32_t seq_id) {
+    if(!contains(seq_id)) {
+        return ;
+    }
+
+    num_dead_values += lengths[seq_id];
+    lengths[seq_id] = 0;
+    num_docs--;
+
+    if(num_dead_values > values.size() / 2) {
+        compact();
+    }
+}
+
+void facet_column_t::compact() {
+    std::vector<uint32_t> live_values;
+    live_values.reserve(values.size() - num_dead_values);
+
+    for(size_t seq_id = 0; seq_id < lengths.size(); seq_id++) {
+        if(lengths[seq_id] == 0) {
+            continue;
+        }
+
+        const uint32_t offset = live_values.size();
+        live_values.insert(live_values.end(), values.begin() + offsets[seq_id],
+                           values.begin() + offsets[seq_id] + lengths[seq_id]);
+        offsets[seq_id] = offset;
+    }
+
+    values = std::move(live_values);
+    num_dead_values = 0;
+}
+
+void facet_column_t::clear() {
+    offsets.clear();
+    lengths.clear();
+    values.clear();
+    num_docs = 0;
+    num_dead_values = 0;
+    min_facet_id = std::numeric_limits<uint32_t>::max();
+    max_facet_id = 0;
+}
@@ -2,6 +2,7 @@
 #include <tokenizer.h>
 #include "string_utils.h"
 #include "array_utils.h"
+#include "threadpool.h"
 
 void facet_index_t::initialize(const std::string& field) {
     const auto facet_field_map_it = facet_field_map.find(field);
@@ -94,14 +95,7 @@ void facet_index_t::insert(const std::string& field_name,
                 auto facet_count_it = fvalue_index_it->second.facet_count_it;
 
                 if(facet_count_it->facet_id == facet_id) {
-                    auto& count_map = facet_index.count_map;
-                    auto old_count = facet_count_it->count;
-                    facet_count_it->count = ids_t::num_ids(fvalue_index_it->second.seq_ids);
-                    auto new_count = facet_count_it->count;
-
-                    // Relocate `curr` to a new sorted location within count list:
-                    auto curr = facet_count_it;
-                    update_count_nodes(count_list, count_map, old_count, new_count, curr);
+                    record_count(facet_index, facet_count_it, ids_t::num_ids(fvalue_index_it->second.seq_ids));
                 } else {
                     LOG(ERROR) << "Wrong reference stored for facet " << fvalue.facet_value << " with facet_id " << facet_id;
                 }
@@ -200,6 +194,57 @@ void facet_index_t::update_count_nodes(std::list<facet_count_t>& count_list,
     }
 }
 
+void facet_index_t::record_count(facet_doc_ids_list_t& facet_index,
+                                 std::list<facet_count_t>::iterator facet_count_it, uint32_t new_count) {
+    // writes hold the field's lock stripe exclusively (`field_locks_t::lock_field()`), while reads apply the pending
+    // counts under the same stripe held in shared mode, so the two never run at the same time
+    if(new_count == facet_count_it->count) {
+        facet_index.pending_counts.erase(&*facet_count_it);
+    } else {
+        facet_index.pending_counts[&*facet_count_it] = {facet_count_it, new_count};
+    }
+}
+
+void facet_index_t::apply_pending_counts(facet_doc_ids_list_t& facet_index) {
+    std::unique_lock<std::mutex> lock(facet_index.pending_counts_mutex);
+
+    auto& pending_counts = facet_index.pending_counts;
+    if(pending_counts.empty()) {
+        return ;
+    }
+
+    auto& count_list = facet_index.counts;
+    auto& count_map = facet_index.count_map;
+
+    if(count_list.size() >= PENDING_COUNTS_RESORT_MIN_VALUES &&
+       pending_counts.size() * PENDING_COUNTS_RESORT_RATIO > count_list.size()) {
+        for(auto& kv: pending_counts) {
+            kv.second.first->count = kv.second.second;
+        }
+
+        count_list.sort([](const facet_count_t& a, const facet_count_t& b) {
+            return a.count > b.count;
+        });
+
+        // the anchor of a count is the last node having that count
+        count_map.clear();
+        for(auto it = count_list.begin(); it != count_list.end(); ++it) {
+            count_map[it->count] = it;
+        }
+    } else {
+        // every node that is not moved yet is still at the position of its current count, which is what
+        // `update_count_nodes` relies on
+        for(auto& kv: pending_counts) {
+            auto curr = kv.second.first;
+            auto old_count = curr->count;
+            curr->count = kv.second.second;
+            update_count_nodes(count_list, count_map, old_count, curr->count, curr);
+        }
+    }
+
+    pending_counts.clear();
+}
+
 bool facet_index_t::contains(const std::string& field_name) {
     const auto& facet_field_it = facet_field_map.find(field_name);
     if(facet_field_it == facet_field_map.end()) {
@@ -273,17 +318,21 @@ void facet_index_t::remove(const nlohmann::json& doc, const field& afield, const
         void*& ids = fvalue_it->second.seq_ids;
         if(ids && ids_t::contains(ids, seq_id)) {
             ids_t::erase(ids, seq_id);
-            auto& count_list = facet_field_it->second.counts;
             auto curr = fvalue_it->second.facet_count_it;
-            auto old_count = curr->count;
-            curr->count = ids_t::num_ids(ids);
-            auto new_count = curr->count;
 
-            // move the node lower in the count list
-            auto& count_map = facet_field_it->second.count_map;
-            update_count_nodes(count_list, count_map, old_count, new_count, curr);
+            if(ids_t::num_ids(ids) != 0) {
+                record_count(facet_field_it->second, curr, ids_t::num_ids(ids));
+            } else {
+                // the node has to leave the count list right away, so it is moved out of its sorted position first
+                auto& count_list = facet_field_it->second.counts;
+                auto& count_map = facet_field_it->second.count_map;
+                facet_field_it->second.pending_counts.erase(&*curr);
+
+                auto old_count = curr->count;
+                curr->count = 0;
+                auto new_count = curr->count;
+                update_count_nodes(count_list, count_map, old_count, new_count, curr);
 
-            if(ids_t::num_ids(ids) == 0) {
                 ids_t::destroy_list(ids);
                 dead_fvalues.push_back(fvalue_it->first);
 
@@ -325,7 +374,8 @@ size_t facet_index_t::intersect(facet& a_facet, const field& facet_field,
                                 const std::vector<char>& symbols_to_index, const std::vector<char>& token_separators,
                                 const uint32_t* result_ids, size_t result_ids_len,
                                 size_t max_facet_count, std::map<std::string, docid_count_t>& found,
-                                bool is_wildcard_no_filter_query, const std::string& sort_order) {
+                                bool is_wildcard_no_filter_query, const std::string& sort_order,
+                                ThreadPool* thread_pool, size_t num_tasks) {
     //LOG (INFO) << "intersecting field " << field;
 
     const auto& facet_field_it = facet_field_map.find(a_facet.field_name);
@@ -333,6 +383,8 @@ size_t facet_index_t::intersect(facet& a_facet, const field& facet_field,
         return 0;
     }
 
+    apply_pending_counts(facet_field_it->second);
+
     const auto& facet_index_map = facet_field_it->second.fvalue_seq_ids;
     const auto& counter_list = facet_field_it->second.counts;
 
@@ -343,95 +395,257 @@ size_t facet_index_t::intersect(facet& a_facet, const field& facet_field,
     size_t max_facets = is_wildcard_no_filter_query ? std::min((size_t)max_facet_count, counter_list.size()) :
                         std::min((size_t)2 * max_facet_count, counter_list.size());
 
-    auto intersect_fn = [&] (std::list<facet_count_t>::const_iterator facet_count_it) {
-        uint32_t count = 0;
-        uint32_t doc_id = 0;
-        if(has_facet_query) {
-            bool found_search_token = false;
-            auto facet_str = facet_count_it->facet_value;
-            std::vector<std::string> facet_tokens;
-            if(facet_field.is_string()) {
-                Tokenizer(facet_str, true, false, facet_field.locale,
-                          symbols_to_index, token_separators).tokenize(facet_tokens);
-            } else {
-                facet_tokens.push_back(facet_str);
-            }
+    // Counting a value by merging its ids with `result_ids` costs at least the length of the shorter list, which adds
+    // up over many values. Once the merges done so far have cost as much as materializing the result ids as a bitmap,
+    // switch to the bitmap: after that, every value costs only one probe per id.
+    const size_t bitmap_cost = is_wildcard_no_filter_query ? SIZE_MAX : result_bitmap_cost(result_ids, result_ids_len);
+    const uint32_t max_result_id = (result_ids_len == 0) ? 0 : result_ids[result_ids_len - 1];
+    std::vector<uint64_t> result_bitmap;
+    size_t merge_cost = 0;
+
+    auto build_result_bitmap = [&]() {
+        result_bitmap.resize((max_result_id >> 6) + 1);
+        for(size_t i = 0; i < result_ids_len; i++) {
+            result_bitmap[result_ids[i] >> 6] |= (1ULL << (result_ids[i] & 63));
+        }
+    };
 
-            for(const auto& searched_tokens : fvalue_searched_tokens) {
-                bool found_all_search_tokens = true;
-                for (const auto &searched_token: searched_tokens) {
-                    bool facet_tokens_found = false;
-                    for(const auto& token : facet_tokens) {
-                        if (token.compare(0, searched_token.size(), searched_token) == 0) {
-                            facet_tokens_found = true;
-                            break;
-                        }
-                    }
-                    if(!facet_tokens_found) {
-                        found_all_search_tokens = false;
+    // returns the searched tokens that the facet value matches, or nullptr if it matches none of them
+    auto match_searched_tokens = [&](const std::string& facet_str) -> const std::vector<std::string>* {
+        std::vector<std::string> facet_tokens;
+        if(facet_field.is_string()) {
+            Tokenizer(facet_str, true, false, facet_field.locale,
+                      symbols_to_index, token_separators).tokenize(facet_tokens);
+        } else {
+            facet_tokens.push_back(facet_str);
+        }
+
+        for(const auto& searched_tokens : fvalue_searched_tokens) {
+            bool found_all_search_tokens = true;
+            for (const auto &searched_token: searched_tokens) {
+                bool facet_tokens_found = false;
+                for(const auto& token : facet_tokens) {
+                    if (token.compare(0, searched_token.size(), searched_token) == 0) {
+                        facet_tokens_found = true;
+                        break;
                     }
                 }
-
-                if (found_all_search_tokens) {
-                    a_facet.fvalue_tokens[facet_count_it->facet_value] = searched_tokens;
-                    found_search_token = true;
-                    break;
+                if(!facet_tokens_found) {
+                    found_all_search_tokens = false;
                 }
             }
 
-            if(!found_search_token) {
-                return;
+            if (found_all_search_tokens) {
+                return &searched_tokens;
             }
         }
 
-        auto ids = facet_index_map.at(facet_count_it->facet_value).seq_ids;
+        return nullptr;
+    };
+
+    // counts the result ids that hold the facet value, through `bitmap` when it is given
+    auto count_fn = [&](const facet_count_t& facet_count, const uint64_t* bitmap, size_t& cost,
+                        docid_count_t& value_count) {
+        auto ids = facet_index_map.at(facet_count.facet_value).seq_ids;
         if (!ids) {
             return;
         }
 
+        uint32_t count = 0;
+
         if (is_wildcard_no_filter_query) {
-            count = facet_count_it->count;
+            count = facet_count.count;
         } else {
             auto val_count = ids_t::num_ids(ids);
             bool estimate_facet_count = (estimate_facets && val_count > 300);
-            count = ids_t::intersect_count(ids, result_ids, result_ids_len, estimate_facet_count, facet_sample_interval);
+
+            if(bitmap != nullptr) {
+                count = ids_t::intersect_count(ids, bitmap, max_result_id, estimate_facet_count, facet_sample_interval);
+            } else {
+                count = ids_t::intersect_count(ids, result_ids, result_ids_len,
+                                               estimate_facet_count, facet_sample_interval);
+                cost += merge_count_cost(val_count, result_ids_len);
+            }
         }
 
         if (count) {
-            doc_id = ids_t::first_id(ids);
-            found[facet_count_it->facet_value] = {doc_id, count};
+            value_count = {ids_t::first_id(ids), count};
         }
     };
 
-    if(sort_order.empty()) {
-        for (auto facet_count_it = counter_list.begin(); facet_count_it != counter_list.end();
-             ++facet_count_it) {
-            //LOG(INFO) << "checking ids in facet_value " << facet_count.facet_value << " having total count "
-            //           << facet_count.count << ", is_wildcard_no_filter_query: " << is_wildcard_no_filter_query;
+    // values are visited in the order of their counts, or in the order of the values when sorting alphabetically
+    auto list_it = counter_list.begin();
+    auto map_it = facet_index_map.begin();
+    auto map_rit = facet_index_map.rbegin();
 
-            intersect_fn(facet_count_it);
-            if (found.size() == max_facets) {
-                break;
+    auto next_value = [&](std::list<facet_count_t>::const_iterator& facet_count_it) {
+        if(sort_order.empty()) {
+            if(list_it == counter_list.end()) {
+                return false;
+            }
+
+            facet_count_it = list_it++;
+        } else if(sort_order == "asc") {
+            if(map_it == facet_index_map.end()) {
+                return false;
             }
+
+            facet_count_it = map_it->second.facet_count_it;
+            ++map_it;
+        } else if(sort_order == "desc") {
+            if(map_rit == facet_index_map.rend()) {
+                return false;
+            }
+
+            facet_count_it = map_rit->second.facet_count_it;
+            ++map_rit;
+        } else {
+            return false;
         }
-    } else {
-        if(sort_order == "asc") {
-            for(auto facet_index_map_it = facet_index_map.begin();
-                facet_index_map_it != facet_index_map.end(); ++facet_index_map_it) {
 
-                intersect_fn(facet_index_map_it->second.facet_count_it);
-                if (found.size() == max_facets) {
-                    break;
+        return true;
+    };
+
+    if(thread_pool != nullptr && num_tasks > 1 && !is_wildcard_no_filter_query &&
+       counter_list.size() > VALUE_BLOCK_SIZE) {
+        // Tasks claim blocks of values in visiting order. The results of the blocks are merged in that same order and
+        // cut off where the sequential walk below would have stopped, so the counts are the same either way. Tasks
+        // stop claiming blocks once the blocks completed so far have found enough values.
+        struct value_result_t {
+            std::list<facet_count_t>::const_iterator facet_count_it;
+            docid_count_t value_count;
+            const std::vector<std::string>* searched_tokens;
+        };
+
+        struct block_t {
+            std::vector<value_result_t> results;
+            bool done = false;
+        };
+
+        // many values get visited, so the bitmap pays for itself
+        if(bitmap_cost != SIZE_MAX) {
+            build_result_bitmap();
+        }
+
+        std::mutex blocks_mutex;
+        std::deque<block_t> blocks;
+        size_t num_done_blocks = 0;
+        size_t num_found = 0;
+        bool enough_found = false;
+
+        auto task_fn = [&]() {
+            std::vector<std::list<facet_count_t>::const_iterator> block_values;
+
+            while(true) {
+                block_t* block;
+                block_values.clear();
+
+                {
+                    std::unique_lock<std::mutex> lock(blocks_mutex);
+                    std::list<facet_count_t>::const_iterator facet_count_it;
+
+                    while(!enough_found && block_values.size() < VALUE_BLOCK_SIZE && next_value(facet_count_it)) {
+                        block_values.push_back(facet_count_it);
+                    }
+
+                    if(block_values.empty()) {
+                        return;
+                    }
+
+                    block = &blocks.emplace_back();
                 }
+
+                size_t cost = 0;
+
+                for(auto facet_count_it: block_values) {
+                    const std::vector<std::string>* searched_tokens = nullptr;
+                    if(has_facet_query) {
+                        searched_tokens = match_searched_tokens(facet_count_it->facet_value);
+                        if(searched_tokens == nullptr) {
+                            continue;
+                        }
+                    }
+
+                    docid_count_t value_count{0, 0};
+                    count_fn(*facet_count_it, result_bitmap.empty() ? nullptr : result_bitmap.data(),
+                             cost, value_count);
+
+                    if(value_count.count != 0 || searched_tokens != nullptr) {
+                        block->results.push_back({facet_count_it, value_count, searched_tokens});
+                    }
+                }
+
+                std::unique_lock<std::mutex> lock(blocks_mutex);
+                block->done = true;
+
+                while(num_done_blocks < blocks.size() && blocks[num_done_blocks].done) {
+                    for(const auto& result: blocks[num_done_blocks].results) {
+                        num_found += (result.value_count.count != 0);
+                    }
+
+                    num_done_blocks++;
+                }
+
+                enough_found = (max_facets != 0 && num_found >= max_facets);
             }
-        } else if(sort_order == "desc") {
-            for(auto facet_index_map_it = facet_index_map.rbegin();
-                facet_index_map_it != facet_index_map.rend(); ++facet_index_map_it) {
+        };
+
+        ThreadPool::task_group_t value_group(thread_pool, ThreadPool::HIGH);
+        for(size_t i = 0; i < num_tasks; i++) {
+            value_group.run(task_fn);
+        }
+
+        value_group.wait();
+
+        bool reached_max_facets = false;
+
+        for(size_t i = 0; i < blocks.size() && !reached_max_facets; i++) {
+            for(const auto& result: blocks[i].results) {
+                const auto& facet_value = result.facet_count_it->facet_value;
 
-                intersect_fn(facet_index_map_it->second.facet_count_it);
-                if (found.size() == max_facets) {
-                    break;
+                if(result.searched_tokens != nullptr) {
+                    a_facet.fvalue_tokens[facet_value] = *result.searched_tokens;
                 }
+
+                if(result.value_count.count != 0) {
+                    found[facet_value] = result.value_count;
+                    if(found.size() == max_facets) {
+                        reached_max_facets = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        return found.size();
+    }
+
+    std::list<facet_count_t>::const_iterator facet_count_it;
+
+    while(next_value(facet_count_it)) {
+        //LOG(INFO) << "checking ids in facet_value " << facet_count.facet_value << " having total count "
+        //           << facet_count.count << ", is_wildcard_no_filter_query: " << is_wildcard_no_filter_query;
+
+        if(has_facet_query) {
+            auto searched_tokens = match_searched_tokens(facet_count_it->facet_value);
+            if(searched_tokens == nullptr) {
+                continue;
+            }
+
+            a_facet.fvalue_tokens[facet_count_it->facet_value] = *searched_tokens;
+        }
+
+        if(result_bitmap.empty() && bitmap_cost != SIZE_MAX && merge_cost >= bitmap_cost) {
+            build_result_bitmap();
+        }
+
+        docid_count_t value_count{0, 0};
+        count_fn(*facet_count_it, result_bitmap.empty() ? nullptr : result_bitmap.data(), merge_cost, value_count);
+
+        if(value_count.count != 0) {
+            found[facet_count_it->facet_value] = value_count;
+            if(found.size() == max_facets) {
+                break;
             }
         }
     }
@@ -439,6 +653,80 @@ size_t facet_index_t::intersect(facet& a_facet, const field& facet_field,
     return found.size();
 }
 
+size_t facet_index_t::merge_count_cost(size_t num_value_ids, size_t result_ids_len) {
+    if(num_value_ids < ids_t::COMPACT_LIST_THRESHOLD_LENGTH) {
+        // compact lists binary search the result ids
+        size_t log_len = 1;
+        while((size_t(1) << log_len) < result_ids_len) {
+            log_len++;
+        }
+
+        return num_value_ids * log_len;
+    }
+
+    return num_value_ids + result_ids_len;
+}
+
+size_t facet_index_t::result_bitmap_cost(const uint32_t* result_ids, size_t result_ids_len) {
+    if(result_ids_len == 0) {
+        return SIZE_MAX;
+    }
+
+    const size_t num_words = (result_ids[result_ids_len - 1] >> 6) + 1;
+    if(num_words > result_ids_len * MAX_RESULT_BITMAP_WORDS_PER_ID) {
+        return SIZE_MAX;
+    }
+
+    return num_words + result_ids_len;
+}
+
+bool facet_index_t::is_value_index_cheaper(const std::string& field_name, const uint32_t* result_ids,
+                                           size_t result_ids_len, size_t max_facet_count, size_t total_docs,
+                                           size_t* value_cost) {
+    const auto facet_field_it = facet_field_map.find(field_name);
+    if(facet_field_it == facet_field_map.end() || !facet_field_it->second.has_value_index) {
+        return false;
+    }
+
+    auto& facet_index = facet_field_it->second;
+    if(!facet_index.has_hash_index || facet_index.seq_id_hashes == nullptr) {
+        return true;
+    }
+
+    apply_pending_counts(facet_index);
+
+    const size_t hash_cost = result_ids_len * HASH_COUNT_COST;
+
+    // `intersect` walks the values in the order of their counts until it has found twice the number of facet values
+    // requested: assuming that results are spread evenly, a value with `n` ids contains `n * results / docs` of them
+    const size_t bitmap_cost = result_bitmap_cost(result_ids, result_ids_len);
+    const size_t max_facets = 2 * max_facet_count;
+    const double result_ratio = double(result_ids_len) / std::max<size_t>(1, total_docs);
+
+    size_t cost = 0;
+    double expected_num_found = 0;
+
+    for(auto it = facet_index.counts.begin(); it != facet_index.counts.end() && expected_num_found < max_facets; ++it) {
+        cost += VALUE_VISIT_COST + ((bitmap_cost == SIZE_MAX) ? merge_count_cost(it->count, result_ids_len) :
+                                                                it->count);
+        if(cost >= hash_cost) {
+            break;
+        }
+
+        expected_num_found += std::min(1.0, it->count * result_ratio);
+    }
+
+    if(bitmap_cost != SIZE_MAX) {
+        cost += bitmap_cost;
+    }
+
+    if(value_cost != nullptr) {
+        *value_cost = cost;
+    }
+
+    return cost < hash_cost;
+}
+
 facet_index_t::~facet_index_t() {
     facet_field_map.clear();    
 }
@@ -481,10 +769,10 @@ void facet_index_t::handle_index_change(const std::string& field_name, size_t to
     // If a field is an id-like field (cardinality_ratio < 5) we will then remove value based index.
 
     auto& facet_index = facet_field_map.at(field_name);
-    posting_list_t*& fhash_index = facet_index.seq_id_hashes;
+    facet_column_t*& fhash_index = facet_index.seq_id_hashes;
 
     if(fhash_index == nullptr && (facet_count > facet_index_threshold) && total_num_docs < 1000000) {
-        fhash_index = new posting_list_t(256);
+        fhash_index = new facet_column_t();
         std::map<uint32_t, std::vector<uint32_t>> seq_id_index_map;
 
         if(get_facet_indexes(field_name, seq_id_index_map)) {
@@ -507,6 +795,8 @@ void facet_index_t::handle_index_change(const std::string& field_name, size_t to
             }
             fvalue_seq_ids.clear();
             facet_index.counts.clear();
+            facet_index.count_map.clear();
+            facet_index.pending_counts.clear();
             facet_index.has_value_index = false;
         }
     }
@@ -522,7 +812,7 @@ bool facet_index_t::has_value_index(const std::string &field_name) {
     return facet_index_it != facet_field_map.end() && facet_index_it->second.has_value_index;
 }
 
-posting_list_t* facet_index_t::get_facet_hash_index(const std::string &field_name) {
+facet_column_t* facet_index_t::get_facet_hash_index(const std::string &field_name) {
     auto facet_index_it = facet_field_map.find(field_name);
     if(facet_index_it != facet_field_map.end()) {
         return facet_index_it->second.seq_id_hashes;
@@ -573,6 +863,7 @@ size_t facet_index_t::facet_node_count(const string &field_name, const string &f
         return 0;
     }
 
+    apply_pending_counts(facet_field_map_it->second);
     return facet_field_map_it->second.fvalue_seq_ids[fvalue].facet_count_it->count;
 }
 
@@ -608,6 +899,7 @@ void facet_index_t::check_for_high_cardinality(const string& field_name, size_t
         fvalue_seq_ids.clear();
         facet_field_map_it->second.counts.clear();
         facet_field_map_it->second.count_map.clear();
+        facet_field_map_it->second.pending_counts.clear();
         facet_field_map_it->second.has_value_index = false;
         //LOG(INFO) << "Dropped value index for field " << field_name;
     }
@@ -330,10 +330,18 @@ Option<bool> field::json_field_to_field(bool enable_nested_fields, nlohmann::jso
             return Option<bool>(400, "Property `" + fields::hnsw_params + ".M` must be a positive integer.");
         }
 
+        if(field_json[fields::hnsw_params].count("quantization") != 0 &&
+           (!field_json[fields::hnsw_params]["quantization"].is_string() ||
+            (field_json[fields::hnsw_params]["quantization"] != "none" &&
+             field_json[fields::hnsw_params]["quantization"] != "int8"))) {
+            return Option<bool>(400, "Property `" + fields::hnsw_params + ".quantization` must be `none` or `int8`.");
+        }
+
         // remove unrelated properties except for m ef_construction and M
         auto it = field_json[fields::hnsw_params].begin();
         while(it != field_json[fields::hnsw_params].end()) {
-            if(it.key() != "max_elements" && it.key() != "ef_construction" && it.key() != "M" && it.key() != "ef") {
+            if(it.key() != "max_elements" && it.key() != "ef_construction" && it.key() != "M" && it.key() != "ef" &&
+               it.key() != "quantization") {
                 it = field_json[fields::hnsw_params].erase(it);
             } else {
                 ++it;
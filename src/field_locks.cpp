@@ -0,0 +1,36 @@
+#include "field_locks.h"
+#include "filter.h"
+
+field_locks_t::shared_lock_t::shared_lock_t(const field_locks_t& locks, const stripe_set_t& stripes):
+        locks(locks), stripes(stripes) {
+    for(size_t i = 0; i < NUM_STRIPES; i++) {
+        if(stripes.test(i)) {
+            locks.stripe_mutexes[i].lock_shared();
+        }
+    }
+}
+
+field_locks_t::shared_lock_t::~shared_lock_t() {
+    for(size_t i = NUM_STRIPES; i > 0; i--) {
+        if(stripes.test(i - 1)) {
+            locks.stripe_mutexes[i - 1].unlock_shared();
+        }
+    }
+}
+
+bool field_locks_t::add_filter_fields(const filter_node_t* filter_node, stripe_set_t& stripes) {
+    if(filter_node == nullptr) {
+        return true;
+    }
+
+    if(filter_node->isOperator) {
+        return add_filter_fields(filter_node->left, stripes) && add_filter_fields(filter_node->right, stripes);
+    }
+
+    if(!filter_node->filter_exp.referenced_collection_name.empty()) {
+        return false;
+    }
+
+    add_field(filter_node->filter_exp.field_name, stripes);
+    return true;
+}
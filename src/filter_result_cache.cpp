@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <iterator>
+#include "filter.h"
+#include "filter_result_cache.h"
+
+bool filter_cache_key_t::build(const filter_node_t* filter_node, filter_cache_key_t& cache_key) {
+    if (filter_node == nullptr) {
+        return false;
+    }
+
+    if (filter_node->isOperator) {
+        filter_cache_key_t left_key, right_key;
+        if (!build(filter_node->left, left_key) || !build(filter_node->right, right_key)) {
+            return false;
+        }
+
+        if (right_key.key < left_key.key) {
+            std::swap(left_key, right_key);
+        }
+
+        cache_key.key = (filter_node->filter_operator == AND ? "&(" : "|(") + left_key.key + "," + right_key.key + ")";
+
+        cache_key.fields = std::move(left_key.fields);
+        cache_key.fields.insert(cache_key.fields.end(), right_key.fields.begin(), right_key.fields.end());
+
+        cache_key.depends_on_all_ids = left_key.depends_on_all_ids || right_key.depends_on_all_ids;
+        return true;
+    }
+
+    const filter& a_filter = filter_node->filter_exp;
+    if (!a_filter.referenced_collection_name.empty()) {
+        return false;
+    }
+
+    // values are length prefixed so that no combination of them can collide with another filter
+    std::string& key = cache_key.key;
+    key = "[" + std::to_string(a_filter.field_name.size()) + ":" + a_filter.field_name;
+    key += a_filter.apply_not_equals ? "!" : "=";
+
+    cache_key.depends_on_all_ids = a_filter.apply_not_equals;
+
+    for (const auto& comparator: a_filter.comparators) {
+        key += std::to_string(comparator) + ";";
+        cache_key.depends_on_all_ids = cache_key.depends_on_all_ids || comparator == NOT_EQUALS;
+    }
+
+    for (const auto& value: a_filter.values) {
+        key += std::to_string(value.size()) + ":" + value;
+    }
+
+    for (const auto& param: a_filter.params) {
+        key += param.dump();
+    }
+
+    key += "]";
+
+    cache_key.fields = {a_filter.field_name};
+    return true;
+}
+
+filter_result_cache_t::filter_result_cache_t(size_t max_bytes): max_bytes(max_bytes) {
+
+}
+
+size_t filter_result_cache_t::get_entry_bytes(const std::string& key, entry_t& entry) {
+    // key is held by both the map and the LRU list
+    size_t entry_bytes = 2 * key.size() + entry.ids.getSizeInBytes() + sizeof(entry_t);
+    for (const auto& field: entry.fields) {
+        entry_bytes += field.size();
+    }
+
+    return entry_bytes;
+}
+
+void filter_result_cache_t::erase(std::unordered_map<std::string, std::unique_ptr<entry_t>>::iterator it) {
+    num_bytes -= it->second->num_bytes;
+    lru.erase(it->second->lru_it);
+    entries.erase(it);
+}
+
+void filter_result_cache_t::apply_deletes(entry_t& entry) {
+    if (entry.num_deletes_applied == deleted_ids.size()) {
+        return;
+    }
+
+    std::vector<uint32_t> pending(deleted_ids.begin() + entry.num_deletes_applied, deleted_ids.end());
+    std::sort(pending.begin(), pending.end());
+
+    // most of the deleted ids are usually not part of the entry, so take a set difference
+    const uint32_t ids_length = entry.ids.getLength();
+    std::unique_ptr<uint32_t[]> ids(entry.ids.uncompress());
+    std::vector<uint32_t> remaining_ids;
+    remaining_ids.reserve(ids_length);
+
+    std::set_difference(ids.get(), ids.get() + ids_length, pending.begin(), pending.end(),
+                        std::back_inserter(remaining_ids));
+
+    if (remaining_ids.size() != ids_length) {
+        entry.ids.load(remaining_ids.data(), remaining_ids.size());
+
+        const size_t entry_bytes = get_entry_bytes(*entry.lru_it, entry);
+        num_bytes = num_bytes - entry.num_bytes + entry_bytes;
+        entry.num_bytes = entry_bytes;
+    }
+
+    entry.num_deletes_applied = deleted_ids.size();
+}
+
+bool filter_result_cache_t::find(const std::string& key, uint32_t*& ids, uint32_t& ids_length) {
+    std::unique_lock lock(mutex);
+
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return false;
+    }
+
+    auto& entry = *it->second;
+    apply_deletes(entry);
+
+    if (entry.ids.getLength() == 0) {
+        erase(it);
+        return false;
+    }
+
+    lru.splice(lru.begin(), lru, entry.lru_it);
+
+    ids_length = entry.ids.getLength();
+    ids = entry.ids.uncompress();
+    return true;
+}
+
+void filter_result_cache_t::insert(const filter_cache_key_t& cache_key, const uint32_t* ids, uint32_t ids_length) {
+    if (max_bytes == 0 || cache_key.key.empty()) {
+        return;
+    }
+
+    // compressed outside of the lock
+    auto entry = std::make_unique<entry_t>();
+    entry->ids.load(ids, ids_length);
+    entry->fields = cache_key.fields;
+    entry->depends_on_all_ids = cache_key.depends_on_all_ids;
+    entry->num_bytes = get_entry_bytes(cache_key.key, *entry);
+
+    std::unique_lock lock(mutex);
+
+    auto existing_it = entries.find(cache_key.key);
+    if (existing_it != entries.end()) {
+        erase(existing_it);
+    }
+
+    if (entry->num_bytes > max_bytes / MAX_ENTRY_SHARE) {
+        return;
+    }
+
+    while (!lru.empty() && num_bytes + entry->num_bytes > max_bytes) {
+        erase(entries.find(lru.back()));
+    }
+
+    entry->num_deletes_applied = deleted_ids.size();
+    num_bytes += entry->num_bytes;
+
+    lru.push_front(cache_key.key);
+    entry->lru_it = lru.begin();
+    entries.emplace(cache_key.key, std::move(entry));
+}
+
+void filter_result_cache_t::remove_id(uint32_t seq_id) {
+    std::unique_lock lock(mutex);
+
+    if (entries.empty()) {
+        deleted_ids.clear();
+        return;
+    }
+
+    deleted_ids.push_back(seq_id);
+
+    if (deleted_ids.size() >= MAX_PENDING_DELETES) {
+        for (auto& kv: entries) {
+            apply_deletes(*kv.second);
+            kv.second->num_deletes_applied = 0;
+        }
+
+        deleted_ids.clear();
+    }
+}
+
+void filter_result_cache_t::invalidate(const std::unordered_set<std::string>& written_fields, const bool ids_added) {
+    std::unique_lock lock(mutex);
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        const auto& entry = *it->second;
+        bool is_stale = ids_added && entry.depends_on_all_ids;
+
+        for (size_t i = 0; !is_stale && i < entry.fields.size(); i++) {
+            is_stale = written_fields.count(entry.fields[i]) != 0;
+        }
+
+        if (is_stale) {
+            num_bytes -= it->second->num_bytes;
+            lru.erase(it->second->lru_it);
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void filter_result_cache_t::clear() {
+    std::unique_lock lock(mutex);
+    entries.clear();
+    lru.clear();
+    deleted_ids.clear();
+    num_bytes = 0;
+}
+
+size_t filter_result_cache_t::size() const {
+    std::unique_lock lock(mutex);
+    return entries.size();
+}
+
+size_t filter_result_cache_t::get_num_bytes() const {
+    std::unique_lock lock(mutex);
+    return num_bytes;
+}
@@ -1212,7 +1212,7 @@ void filter_result_iterator_t::init() {
                 size_t max_candidates = 4;
                 size_t min_len_1typo = 0;
                 size_t min_len_2typo = 0;
-                std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values{};
+                std::array<sort_column_t*, 3> field_values{};
                 const std::vector<size_t> geopoint_indices;
 
                 auto fuzzy_search_fields_op = index->fuzzy_search_fields(fq_fields, value_tokens, {}, text_match_type_t::max_score,
@@ -1776,10 +1776,34 @@ filter_result_iterator_t::filter_result_iterator_t(const std::string& collection
         timeout_info = std::make_unique<filter_result_iterator_timeout_info>(search_begin, search_stop);
     }
 
+    init_tree();
+}
+
+filter_result_iterator_t::filter_result_iterator_t(const std::string& collection_name, const Index *const index,
+                                                   const filter_node_t *const filter_node,
+                                                   const filter_result_iterator_t* parent) :
+        collection_name(collection_name),
+        index(index),
+        filter_node(filter_node),
+        is_subtree(parent != nullptr) {
+    if (filter_node == nullptr) {
+        validity = invalid;
+        return;
+    }
+
+    init_tree();
+}
+
+void filter_result_iterator_t::init_tree() {
+    // A cached subtree needs neither its child nodes nor any lookups in the index.
+    if (init_from_cache()) {
+        return;
+    }
+
     // Generate the iterator tree and then initialize each node.
     if (filter_node->isOperator) {
-        left_it = new filter_result_iterator_t(collection_name, index, filter_node->left);
-        right_it = new filter_result_iterator_t(collection_name, index, filter_node->right);
+        left_it = new filter_result_iterator_t(collection_name, index, filter_node->left, this);
+        right_it = new filter_result_iterator_t(collection_name, index, filter_node->right, this);
     }
 
     init();
@@ -1787,6 +1811,37 @@ filter_result_iterator_t::filter_result_iterator_t(const std::string& collection
     if (!validity) {
         this->approx_filter_ids_length = 0;
     }
+
+    cache_filter_result();
+}
+
+bool filter_result_iterator_t::init_from_cache() {
+    if (index == nullptr || !filter_cache_key_t::build(filter_node, cache_key)) {
+        cache_key = filter_cache_key_t();
+        return false;
+    }
+
+    if (!index->filter_cache.find(cache_key.key, filter_result.docs, filter_result.count)) {
+        return false;
+    }
+
+    result_index = 0;
+    seq_id = filter_result.docs[result_index];
+    is_filter_result_initialized = true;
+    is_filter_result_cached = true;
+    approx_filter_ids_length = filter_result.count;
+    return true;
+}
+
+void filter_result_iterator_t::cache_filter_result() {
+    if (cache_key.key.empty() || is_filter_result_cached || !is_filter_result_initialized || validity != valid ||
+        filter_result.count == 0 || filter_result.coll_to_references != nullptr ||
+        (is_subtree && filter_result.count < filter_result_cache_t::MIN_SUBTREE_IDS)) {
+        return;
+    }
+
+    index->filter_cache.insert(cache_key, filter_result.docs, filter_result.count);
+    is_filter_result_cached = true;
 }
 
 filter_result_iterator_t::~filter_result_iterator_t() {
@@ -1839,6 +1894,10 @@ filter_result_iterator_t& filter_result_iterator_t::operator=(filter_result_iter
     status = std::move(obj.status);
     is_filter_result_initialized = obj.is_filter_result_initialized;
 
+    cache_key = std::move(obj.cache_key);
+    is_filter_result_cached = obj.is_filter_result_cached;
+    is_subtree = obj.is_subtree;
+
     approx_filter_ids_length = obj.approx_filter_ids_length;
 
     return *this;
@@ -2041,6 +2100,8 @@ void filter_result_iterator_t::compute_iterators() {
         left_it = nullptr;
         delete right_it;
         right_it = nullptr;
+
+        cache_filter_result();
         return;
     }
 
@@ -2151,6 +2212,8 @@ void filter_result_iterator_t::compute_iterators() {
     seq_id = filter_result.docs[result_index];
     is_filter_result_initialized = true;
     approx_filter_ids_length = filter_result.count;
+
+    cache_filter_result();
 }
 
 bool filter_result_iterator_t::is_timed_out() {
@@ -763,3 +763,44 @@ size_t id_list_t::intersect_count(const uint32_t *res_ids, size_t res_ids_len,
 
     return std::min<size_t>(ids_length, count);
 }
+
+size_t id_list_t::intersect_count(const uint64_t* res_bitmap, uint32_t max_res_id,
+                                  bool estimate_facets, size_t facet_sample_interval) {
+    // when estimating, only every n-th id of the list is probed and the count is scaled back up
+    const size_t step = estimate_facets ? std::max<size_t>(1, facet_sample_interval) : 1;
+
+    size_t count = 0;
+    size_t next_sample_index = 0;
+    size_t block_start_index = 0;
+
+    std::vector<uint32_t> block_ids(BLOCK_MAX_ELEMENTS);
+
+    for(block_t* block = &root_block; block != nullptr; block = block->next) {
+        const uint32_t block_len = block->size();
+        if(block_len > block_ids.size()) {
+            block_ids.resize(block_len);
+        }
+
+        block->ids.uncompress_into(block_ids.data());
+
+        if(block_len != 0 && block_ids[0] > max_res_id) {
+            // ids of this and the following blocks are all larger than the largest result id
+            break;
+        }
+
+        size_t i = next_sample_index - block_start_index;
+        for(; i < block_len; i += step) {
+            const uint32_t id = block_ids[i];
+            count += (id <= max_res_id) & (res_bitmap[std::min(id, max_res_id) >> 6] >> (id & 63));
+        }
+
+        block_start_index += block_len;
+        next_sample_index = block_start_index + (i - block_len);
+    }
+
+    if(estimate_facets) {
+        count = count * step;
+    }
+
+    return std::min<size_t>(ids_length, count);
+}
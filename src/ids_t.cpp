@@ -168,6 +168,16 @@ size_t compact_id_list_t::intersect_count(const uint32_t* res_ids, size_t res_id
     return count;
 }
 
+size_t compact_id_list_t::intersect_count(const uint64_t* res_bitmap, uint32_t max_res_id) {
+    size_t count = 0;
+
+    for(size_t i = 0; i < length && ids[i] <= max_res_id; i++) {
+        count += (res_bitmap[ids[i] >> 6] >> (ids[i] & 63)) & 1;
+    }
+
+    return count;
+}
+
 /* posting operations */
 
 void ids_t::upsert(void*& obj, uint32_t id) {
@@ -376,6 +386,17 @@ size_t ids_t::intersect_count(void*& obj, const uint32_t* result_ids, size_t res
     }
 }
 
+size_t ids_t::intersect_count(void*& obj, const uint64_t* result_bitmap, uint32_t max_result_id,
+                              bool estimate_facets, size_t facet_sample_mod_value) {
+    if(IS_COMPACT_IDS(obj)) {
+        compact_id_list_t* list = COMPACT_IDS_PTR(obj);
+        return list->intersect_count(result_bitmap, max_result_id);
+    } else {
+        id_list_t* list = (id_list_t*)(obj);
+        return list->intersect_count(result_bitmap, max_result_id, estimate_facets, facet_sample_mod_value);
+    }
+}
+
 void* ids_t::create(const std::vector<uint32_t>& ids) {
     if(ids.size() < COMPACT_LIST_THRESHOLD_LENGTH) {
         return SET_COMPACT_IDS(compact_id_list_t::create(ids.size(), ids));
@@ -2,10 +2,12 @@
 
 #include <memory>
 #include <numeric>
+#include <cmath>
 #include <chrono>
 #include <set>
 #include <unordered_map>
 #include <random>
+#include <thread>
 #include <art.h>
 #include <array_utils.h>
 #include <match_score.h>
@@ -44,13 +46,26 @@
                 }
 #define FACET_INDEX_THRESHOLD 1000000000
 
-spp::sparse_hash_map<uint32_t, int64_t, Hasher32> Index::text_match_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t, Hasher32> Index::seq_id_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t, Hasher32> Index::eval_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t, Hasher32> Index::geo_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t, Hasher32> Index::str_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t, Hasher32> Index::vector_distance_sentinel_value;
-spp::sparse_hash_map<uint32_t, int64_t, Hasher32> Index::vector_query_sentinel_value;
+sort_column_t Index::text_match_sentinel_value;
+sort_column_t Index::seq_id_sentinel_value;
+sort_column_t Index::eval_sentinel_value;
+sort_column_t Index::geo_sentinel_value;
+sort_column_t Index::str_sentinel_value;
+sort_column_t Index::vector_distance_sentinel_value;
+sort_column_t Index::vector_query_sentinel_value;
+
+uint8_t Index::get_sort_column_width(const field& a_field) {
+    if(a_field.is_bool()) {
+        return sort_column_t::WIDTH_8;
+    }
+
+    if(a_field.is_int32()) {
+        return sort_column_t::WIDTH_32;
+    }
+
+    // int64, float (stored as sortable int64) and packed geo points
+    return sort_column_t::WIDTH_64;
+}
 
 Index::Index(const std::string& name, const uint32_t collection_id, const Store* store,
              SynonymIndex* synonym_index, ThreadPool* thread_pool,
@@ -68,7 +83,8 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
         }
 
         if(a_field.num_dim > 0) {
-            auto hnsw_index = new hnsw_index_t(a_field.num_dim, 1024, a_field.vec_dist, a_field.hnsw_params["M"].get<uint32_t>(), a_field.hnsw_params["ef_construction"].get<uint32_t>());
+            auto hnsw_index = new hnsw_index_t(a_field.num_dim, 1024, a_field.vec_dist, a_field.hnsw_params["M"].get<uint32_t>(), a_field.hnsw_params["ef_construction"].get<uint32_t>(),
+                                               hnsw_index_t::is_int8_quantized(a_field.hnsw_params));
             vector_index.emplace(a_field.name, hnsw_index);
             continue;
         }
@@ -100,7 +116,7 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
                 adi_tree_t* tree = new adi_tree_t();
                 str_sort_index.emplace(a_field.name, tree);
             } else if(a_field.type != field_types::GEOPOINT_ARRAY) {
-                auto doc_to_score = new spp::sparse_hash_map<uint32_t, int64_t, Hasher32>();
+                auto doc_to_score = new sort_column_t(get_sort_column_width(a_field));
                 sort_index.emplace(a_field.name, doc_to_score);
             }
         }
@@ -120,7 +136,7 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
             array_mapped_infix_t infix_sets(ARRAY_INFIX_DIM);
 
             for(auto& infix_set: infix_sets) {
-                infix_set = new tsl::htrie_set<char>();
+                infix_set = new trigram_index_t();
             }
 
             infix_index.emplace(a_field.name, infix_sets);
@@ -520,12 +536,7 @@ void Index::validate_and_preprocess(Index *index,
             if(index_rec.doc.count(default_sorting_field) == 0) {
                 auto default_sorting_field_it = index->sort_index.find(default_sorting_field);
                 if(default_sorting_field_it != index->sort_index.end()) {
-                    auto seq_id_it = default_sorting_field_it->second->find(index_rec.seq_id);
-                    if(seq_id_it != default_sorting_field_it->second->end()) {
-                        points = seq_id_it->second;
-                    } else {
-                        points = INT64_MIN;
-                    }
+                    points = default_sorting_field_it->second->get(index_rec.seq_id, INT64_MIN);
                 } else {
                     points = INT64_MIN;
                 }
@@ -558,24 +569,24 @@ batch_memory_index(Index *index,
                                  const bool do_validation, const size_t remote_embedding_batch_size,
                                  const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries, const bool generate_embeddings, 
                                  const bool use_addition_fields, const tsl::htrie_map<char, field>& addition_fields) {
-    const size_t concurrency = 4;
-    const size_t num_threads = std::min(concurrency, iter_batch.size());
+    // every task gets enough records to be worth scheduling, and tasks are capped at the number of pool threads
+    const size_t pool_threads = (index->thread_pool == nullptr) ? 1 : index->thread_pool->get_num_threads();
+    const size_t num_threads = std::min(std::max<size_t>(1, pool_threads),
+                                        (iter_batch.size() + MIN_RECORDS_PER_PREPROCESS_TASK - 1) /
+                                        MIN_RECORDS_PER_PREPROCESS_TASK);
     const size_t window_size = (num_threads == 0) ? 0 :
                                (iter_batch.size() + num_threads - 1) / num_threads;  // rounds up
     const auto& indexable_schema = use_addition_fields ? addition_fields : actual_search_schema;
     
 
     size_t num_indexed = 0;
-    size_t num_processed = 0;
-    std::mutex m_process;
-    std::condition_variable cv_process;
-
-    size_t num_queued = 0;
     size_t batch_index = 0;
 
     // local is need to propogate the thread local inside threads launched below
     auto local_write_log_index = write_log_index;
 
+    ThreadPool::task_group_t validate_group(index->thread_pool);
+
     for(size_t thread_id = 0; thread_id < num_threads && batch_index < iter_batch.size(); thread_id++) {
         size_t batch_len = window_size;
 
@@ -583,29 +594,22 @@ batch_memory_index(Index *index,
             batch_len = iter_batch.size() - batch_index;
         }
 
-        num_queued++;
-
-        index->thread_pool->enqueue([&, batch_index, batch_len]() {
+        validate_group.run([&, batch_index, batch_len]() {
             write_log_index = local_write_log_index;
             validate_and_preprocess(index, iter_batch, batch_index, batch_len, default_sorting_field, actual_search_schema,
                                     embedding_fields, fallback_field_type, token_separators, symbols_to_index, do_validation, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries, generate_embeddings);
-
-            std::unique_lock<std::mutex> lock(m_process);
-            num_processed++;
-
-            cv_process.notify_one();
         });
 
         batch_index += batch_len;
     }
 
-    {
-        std::unique_lock<std::mutex> lock_process(m_process);
-        cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
-    }
+    validate_group.wait();
 
     std::unordered_set<std::string> found_fields;
 
+    // fields whose filter results can change because of this batch
+    std::unordered_set<std::string> written_fields;
+
     for(size_t i = 0; i < iter_batch.size(); i++) {
         auto& index_rec = iter_batch[i];
 
@@ -616,6 +620,10 @@ batch_memory_index(Index *index,
 
         if(index_rec.is_update) {
             index->remove(index_rec.seq_id, index_rec.del_doc, {}, index_rec.is_update);
+
+            for(const auto& kv: index_rec.del_doc.items()) {
+                written_fields.insert(kv.key());
+            }
         } else if(index_rec.indexed.ok()) {
             num_indexed++;
         }
@@ -625,8 +633,13 @@ batch_memory_index(Index *index,
         }
     }
 
-    num_queued = num_processed = 0;
-    std::unique_lock ulock(index->mutex);
+    written_fields.insert(found_fields.begin(), found_fields.end());
+
+    // Writes of other batches are kept out by `write_mutex`, while searches are kept out only of the fields that are
+    // being indexed: each field task takes the lock of its own field while writing to it.
+    std::unique_lock write_lock(index->write_mutex);
+    std::shared_lock slock(index->mutex);
+    ThreadPool::task_group_t index_group(index->thread_pool);
 
     for(const auto& field_name: found_fields) {
         //LOG(INFO) << "field name: " << field_name;
@@ -634,13 +647,12 @@ batch_memory_index(Index *index,
             continue;
         }
 
-        num_queued++;
-
-        index->thread_pool->enqueue([&]() {
+        index_group.run([&]() {
             write_log_index = local_write_log_index;
 
             const field& f = (field_name == "id") ?
                              field("id", field_types::STRING, false) : indexable_schema.at(field_name);
+
             try {
                 index->index_field_in_memory(f, iter_batch);
             } catch(std::exception& e) {
@@ -649,17 +661,14 @@ batch_memory_index(Index *index,
                     record.index_failure(500, "Unhandled Typesense error in index batch, check logs for details.");
                 }
             }
-
-            std::unique_lock<std::mutex> lock(m_process);
-            num_processed++;
-            cv_process.notify_one();
         });
     }
 
-    {
-        std::unique_lock<std::mutex> lock_process(m_process);
-        cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
-    }
+    index_group.wait();
+
+    // Done while still holding the write lock: searches that ran between removing the old values of updated documents
+    // and indexing the new ones could have cached an intermediate state.
+    index->filter_cache.invalidate(written_fields, num_indexed != 0);
 
     return num_indexed;
 }
@@ -668,6 +677,8 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
     // indexes a given field of all documents in the batch
 
     if(afield.name == "id") {
+        auto field_lock = field_locks.lock_field(afield.name);
+
         for(const auto& record: iter_batch) {
             if(!record.indexed.ok()) {
                 // some records could have been invalidated upstream
@@ -700,11 +711,6 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
         std::unordered_map<facet_value_id_t, std::vector<uint32_t>, facet_value_id_t::Hash> fvalue_to_seq_ids;
         std::unordered_map<uint32_t, std::vector<facet_value_id_t>> seq_id_to_fvalues;
 
-        size_t total_num_docs = seq_ids->num_ids();
-        if(afield.facet && total_num_docs > 10*1000 && search_schema.size() > 100) {
-            facet_index_v4->check_for_high_cardinality(afield.name, total_num_docs);
-        }
-
         for(const auto& record: iter_batch) {
             if(!record.indexed.ok()) {
                 // some records could have been invalidated upstream
@@ -804,17 +810,29 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
 
             for(auto& token_offsets: field_index_it->second.offsets) {
                 token_to_doc_offsets[token_offsets.first].emplace_back(seq_id, record.points, token_offsets.second);
+            }
+        }
 
-                if(afield.infix) {
-                    auto strhash = StringUtils::hash_wy(token_offsets.first.c_str(), token_offsets.first.size());
-                    const auto& infix_sets = infix_index.at(afield.name);
-                    infix_sets[strhash % 4]->insert(token_offsets.first);
+        {
+            auto field_lock = field_locks.lock_field(afield.name);
+
+            size_t total_num_docs = seq_ids->num_ids();
+            if(afield.facet && total_num_docs > 10*1000 && search_schema.size() > 100) {
+                facet_index_v4->check_for_high_cardinality(afield.name, total_num_docs);
+            }
+
+            facet_index_v4->insert(afield.name, fvalue_to_seq_ids, seq_id_to_fvalues, afield.is_string());
+
+            if(afield.infix) {
+                const auto& infix_sets = infix_index.at(afield.name);
+                for(const auto& token_to_doc: token_to_doc_offsets) {
+                    const std::string& token = token_to_doc.first;
+                    auto strhash = StringUtils::hash_wy(token.c_str(), token.size());
+                    infix_sets[strhash % 4]->insert(token);
                 }
             }
         }
 
-        facet_index_v4->insert(afield.name, fvalue_to_seq_ids, seq_id_to_fvalues, afield.is_string());
-
         auto tree_it = search_index.find(afield.faceted_name());
         if(tree_it == search_index.end()) {
             return;
@@ -822,18 +840,41 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
 
         art_tree *t = tree_it->second;
 
-        for(auto& token_to_doc: token_to_doc_offsets) {
-            const std::string& token = token_to_doc.first;
-            std::vector<art_document>& documents = token_to_doc.second;
+        // Every document of the batch has already been turned into token postings above, so the lock is only held
+        // while they are written into the tree. Large batches are written in slices: a search waits for at most one
+        // slice, and may see some tokens of a document before others, much like it can see some fields of a document
+        // before others.
+        auto token_it = token_to_doc_offsets.begin();
+
+        while(token_it != token_to_doc_offsets.end()) {
+            {
+                auto field_lock = field_locks.lock_field(afield.name);
+                size_t num_postings = 0;
+
+                while(token_it != token_to_doc_offsets.end() && num_postings < MAX_POSTINGS_PER_WRITE_SLICE) {
+                    const std::string& token = token_it->first;
+                    std::vector<art_document>& documents = token_it->second;
+
+                    const auto *key = (const unsigned char *) token.c_str();
+                    int key_len = (int) token.length() + 1;  // for the terminating \0 char
 
-            const auto *key = (const unsigned char *) token.c_str();
-            int key_len = (int) token.length() + 1;  // for the terminating \0 char
+                    //LOG(INFO) << "key: " << key << ", art_doc.id: " << art_doc.id;
+                    art_inserts(t, key, key_len, max_score, documents);
 
-            //LOG(INFO) << "key: " << key << ", art_doc.id: " << art_doc.id;
-            art_inserts(t, key, key_len, max_score, documents);
+                    num_postings += documents.size();
+                    ++token_it;
+                }
+            }
+
+            if(token_it != token_to_doc_offsets.end()) {
+                // let the searches that queued up behind the slice go first
+                std::this_thread::yield();
+            }
         }
     }
 
+    auto field_lock = field_locks.lock_field(afield.name);
+
     if(!afield.is_string()) {
         if (afield.type == field_types::INT32) {
             auto num_tree = afield.range_index ? nullptr : numerical_index.at(afield.name);
@@ -949,7 +990,9 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
         } else if(afield.is_array()) {
             // handle vector index first
             if(afield.type == field_types::FLOAT_ARRAY && afield.num_dim > 0) {
-                auto vec_index = vector_index[afield.name]->vecdex;
+                auto field_vector_index = vector_index[afield.name];
+                auto vec_index = field_vector_index->vecdex;
+                const uint32_t restored_seq_id_watermark = field_vector_index->restored_seq_id_watermark;
                 size_t curr_ele_count = vec_index->getCurrentElementCount();
                 if(curr_ele_count + iter_batch.size() > vec_index->getMaxElements()) {
                     vec_index->resizeIndex((curr_ele_count + iter_batch.size()) * 1.3);
@@ -958,13 +1001,12 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
                 const size_t num_threads = std::min<size_t>(4, iter_batch.size());
                 const size_t window_size = (num_threads == 0) ? 0 :
                                            (iter_batch.size() + num_threads - 1) / num_threads;  // rounds up
-                size_t num_processed = 0;
-                std::mutex m_process;
-                std::condition_variable cv_process;
-
-                size_t num_queued = 0;
                 size_t result_index = 0;
 
+                // runs nested inside the field fan-out of batch_memory_index(), so wait on a task group to let this
+                // thread work on the batches instead of parking a worker
+                ThreadPool::task_group_t vector_group(thread_pool);
+
                 for(size_t thread_id = 0; thread_id < num_threads && result_index < iter_batch.size(); thread_id++) {
                     size_t batch_len = window_size;
 
@@ -972,15 +1014,15 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
                         batch_len = iter_batch.size() - result_index;
                     }
 
-                    num_queued++;
-
-                    thread_pool->enqueue([thread_id, &afield, &vec_index, &records = iter_batch,
-                                          result_index, batch_len, &num_processed, &m_process, &cv_process]() {
+                    vector_group.run([&afield, field_vector_index, &records = iter_batch, restored_seq_id_watermark,
+                                      result_index, batch_len]() {
 
                         size_t batch_counter = 0;
                         while(batch_counter < batch_len) {
                             auto& record = records[result_index + batch_counter];
-                            if(record.doc.count(afield.name) == 0 || !record.indexed.ok()) {
+                            if(record.doc.count(afield.name) == 0 || !record.indexed.ok() ||
+                               record.seq_id < restored_seq_id_watermark) {
+                                // vectors below the watermark are already present in the restored graph
                                 batch_counter++;
                                 continue;
                             }
@@ -993,9 +1035,9 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
                                     if(afield.vec_dist == cosine) {
                                         std::vector<float> normalized_vals(afield.num_dim);
                                         hnsw_index_t::normalize_vector(float_vals, normalized_vals);
-                                        vec_index->addPoint(normalized_vals.data(), (size_t)record.seq_id, true);
+                                        field_vector_index->add_point(normalized_vals.data(), record.seq_id);
                                     } else {
-                                        vec_index->addPoint(float_vals.data(), (size_t)record.seq_id, true);
+                                        field_vector_index->add_point(float_vals.data(), record.seq_id);
                                     }
                                 }
                             } catch(const std::exception &e) {
@@ -1004,17 +1046,12 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
 
                             batch_counter++;
                         }
-
-                        std::unique_lock<std::mutex> lock(m_process);
-                        num_processed++;
-                        cv_process.notify_one();
                     });
 
                     result_index += batch_len;
                 }
 
-                std::unique_lock<std::mutex> lock_process(m_process);
-                cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
+                vector_group.wait();
                 return;
             }
 
@@ -1308,33 +1345,115 @@ void Index::compute_facet_stats(facet &a_facet, int64_t raw_value, const std::st
     }
 }
 
-int64_t Index::get_doc_val_from_sort_index(sort_index_iterator sort_index_it, uint32_t doc_seq_id) const {
+void Index::compute_facet_stats(facet &a_facet, const std::vector<int64_t>& sort_values, const field& facet_field) {
+    if(sort_values.empty()) {
+        return ;
+    }
 
-    if(sort_index_it != sort_index.end()){
-        auto doc_id_val_map = sort_index_it->second;
-        auto doc_seq_id_it = doc_id_val_map->find(doc_seq_id);
+    // plain loops over a contiguous array, so that the compiler can vectorize them
+    double sum = 0;
+
+    if(facet_field.is_float()) {
+        float min_val = std::numeric_limits<float>::max();
+        float max_val = -std::numeric_limits<float>::max();
+
+        for(auto sort_value: sort_values) {
+            float val = int64_t_to_float(sort_value);
+            min_val = std::min(min_val, val);
+            max_val = std::max(max_val, val);
+            sum += val;
+        }
+
+        a_facet.stats.fvmin = std::min<double>(a_facet.stats.fvmin, min_val);
+        a_facet.stats.fvmax = std::max<double>(a_facet.stats.fvmax, max_val);
+    } else {
+        int64_t min_val = INT64_MAX;
+        int64_t max_val = INT64_MIN;
 
-        if(doc_seq_id_it != doc_id_val_map->end()){
-            return doc_seq_id_it->second;
+        for(auto sort_value: sort_values) {
+            min_val = std::min(min_val, sort_value);
+            max_val = std::max(max_val, sort_value);
+            sum += sort_value;
         }
+
+        a_facet.stats.fvmin = std::min<double>(a_facet.stats.fvmin, min_val);
+        a_facet.stats.fvmax = std::max<double>(a_facet.stats.fvmax, max_val);
+    }
+
+    a_facet.stats.fvsum += sum;
+    a_facet.stats.fvcount += sort_values.size();
+}
+
+bool Index::add_sort_stripes(const std::vector<sort_by>& sort_fields_std, field_locks_t::stripe_set_t& stripes) {
+    for(const auto& sort_field: sort_fields_std) {
+        if(!sort_field.eval_expressions.empty() || !sort_field.reference_collection_name.empty()) {
+            // filters of eval expressions and joined sort fields can read any field
+            return false;
+        }
+
+        field_locks_t::add_field(sort_field.name, stripes);
+    }
+
+    return true;
+}
+
+field_locks_t::stripe_set_t Index::get_search_stripes(const std::vector<search_field_t>& the_fields,
+                                                      const filter_node_t* filter_tree_root,
+                                                      const std::vector<facet>& facets,
+                                                      const std::vector<sort_by>& sort_fields_std,
+                                                      const std::vector<std::string>& group_by_fields,
+                                                      const vector_query_t& vector_query,
+                                                      const std::string& default_sorting_field) {
+    field_locks_t::stripe_set_t stripes;
+
+    // seq_ids are read by every search
+    field_locks_t::add_field("id", stripes);
+    field_locks_t::add_field(default_sorting_field, stripes);
+
+    for(const auto& search_field: the_fields) {
+        field_locks_t::add_field(search_field.name, stripes);
+        field_locks_t::add_field(search_field.str_name, stripes);
+    }
+
+    for(const auto& a_facet: facets) {
+        field_locks_t::add_field(a_facet.field_name, stripes);
+        field_locks_t::add_field(a_facet.sort_field, stripes);
+    }
+
+    if(!add_sort_stripes(sort_fields_std, stripes)) {
+        return field_locks_t::all_stripes();
+    }
+
+    for(const auto& group_by_field: group_by_fields) {
+        field_locks_t::add_field(group_by_field, stripes);
+    }
+
+    field_locks_t::add_field(vector_query.field_name, stripes);
+
+    if(!field_locks_t::add_filter_fields(filter_tree_root, stripes)) {
+        return field_locks_t::all_stripes();
+    }
+
+    return stripes;
+}
+
+int64_t Index::get_doc_val_from_sort_index(sort_index_iterator sort_index_it, uint32_t doc_seq_id) const {
+
+    if(sort_index_it != sort_index.end()){
+        return sort_index_it->second->get(doc_seq_id, INT64_MAX);
     }
 
     return INT64_MAX;
 }
 
-std::vector<group_by_field_it_t> Index::get_group_by_field_iterators(const std::vector<std::string>& group_by_fields,
-                                                                     bool is_reverse) const {
+std::vector<group_by_field_it_t> Index::get_group_by_field_iterators(const std::vector<std::string>& group_by_fields) const {
     std::vector<group_by_field_it_t> group_by_field_it_vec;
     for (const auto &field_name: group_by_fields) {
         if (!facet_index_v4->has_hash_index(field_name)) {
             continue;
         }
-        auto facet_index = facet_index_v4->get_facet_hash_index(field_name);
-        auto facet_index_it = is_reverse ? facet_index->new_rev_iterator() : facet_index->new_iterator();
 
-        group_by_field_it_t group_by_field_it_struct {field_name, std::move(facet_index_it),
-                                                      search_schema.at(field_name).is_array()};
-        group_by_field_it_vec.emplace_back(std::move(group_by_field_it_struct));
+        group_by_field_it_vec.push_back({field_name, facet_index_v4->get_facet_hash_index(field_name)});
     }
     return group_by_field_it_vec;
 }
@@ -1354,6 +1473,12 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
 
     std::vector<group_by_field_it_t> group_by_field_it_vec;
 
+    struct flat_facet_count_t {
+        uint32_t count = 0;
+        uint32_t doc_id = 0;
+        uint32_t array_pos = 0;
+    };
+
     size_t total_docs = seq_ids->num_ids();
     // assumed that facet fields have already been validated upstream
     for(auto& a_facet : facets) {
@@ -1380,6 +1505,45 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
 
         bool facet_value_index_exists = facet_index_v4->has_value_index(facet_field.name);
 
+        // Single valued numerical fields are also stored in a sort column: their stats and range counts are computed
+        // straight from the numerical values of the results, without going through facet values or hashes.
+        const sort_column_t* facet_sort_column = (!facet_field.is_array() && sort_index_it != sort_index.end()) ?
+                                                 sort_index_it->second : nullptr;
+        const bool compute_stats_per_value = should_compute_stats && facet_sort_column == nullptr;
+
+        if(facet_sort_column != nullptr && (should_compute_stats || (a_facet.is_range_query && group_limit == 0))) {
+            std::vector<int64_t> sort_values;
+            facet_sort_column->gather(result_ids, results_size, sort_values);
+
+            if(should_compute_stats) {
+                compute_facet_stats(a_facet, sort_values, facet_field);
+            }
+
+            if(a_facet.is_range_query && group_limit == 0) {
+                // range counts are scaled up by the sample percent afterwards, so count the same sample of the
+                // results as the hash based path does
+                if(estimate_facets) {
+                    std::vector<uint32_t> sampled_ids;
+                    sampled_ids.reserve(results_size / facet_sample_mod_value + 1);
+                    for(size_t i = 0; i < results_size; i += facet_sample_mod_value) {
+                        sampled_ids.push_back(result_ids[i]);
+                    }
+
+                    sort_values.clear();
+                    facet_sort_column->gather(sampled_ids.data(), sampled_ids.size(), sort_values);
+                }
+
+                for(auto doc_val: sort_values) {
+                    std::pair<int64_t , std::string> range_pair {};
+                    if(a_facet.get_range(doc_val, range_pair)) {
+                        a_facet.result_map[range_pair.first].count += 1;
+                    }
+                }
+
+                continue;
+            }
+        }
+
 #ifdef TEST_BUILD
         if(facet_index_type == VALUE) {
 #else
@@ -1396,7 +1560,8 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                                       facet_infos[findex].fvalue_searched_tokens,
                                       symbols_to_index, token_separators,
                                       result_ids, results_size, max_facet_count, facet_results,
-                                      is_wildcard_no_filter_query, sort_order);
+                                      is_wildcard_no_filter_query, sort_order,
+                                      thread_pool, facet_infos[findex].num_value_tasks);
 
             for(const auto& kv : facet_results) {
                 //range facet processing
@@ -1420,13 +1585,13 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                     facet_count.doc_id = kv.second.doc_id;
                 }
 
-                if(should_compute_stats) {
+                if(compute_stats_per_value) {
                     //LOG(INFO) << "Computing facet stats for facet value" << kv.first;
                     compute_facet_stats(a_facet, kv.first, facet_field.type, kv.second.count);
                 }
             }
 
-            if(should_compute_stats) {
+            if(compute_stats_per_value) {
                 auto numerical_index_it = numerical_index.find(a_facet.field_name);
                 if(numerical_index_it != numerical_index.end()) {
                     auto min_max_pair = numerical_index_it->second->get_min_max(result_ids,
@@ -1449,17 +1614,25 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
 
             const auto& fhash_int64_map = facet_index_v4->get_fhash_int64_map(a_facet.field_name);
 
-            const auto facet_field_is_array = facet_field.is_array();
             const auto facet_field_is_int64 = facet_field.is_int64();
 
-            const auto& facet_index = facet_index_v4->get_facet_hash_index(facet_field.name);
-            posting_list_t::iterator_t facet_index_it = facet_index->new_iterator();
-            std::vector<uint32_t> facet_hashes(1);
+            const auto facet_column = facet_index_v4->get_facet_hash_index(facet_field.name);
 
             if (group_limit != 0) {
                 group_by_field_it_vec = get_group_by_field_iterators(group_by_fields);
             }
 
+            // Plain counts of a field whose facet hashes span a narrow range (numerical values, low cardinality
+            // strings) are kept in a flat array indexed by the hash and moved into `result_map` once at the end.
+            const uint32_t min_facet_hash = facet_column->get_min_facet_id();
+            const uint32_t max_facet_hash = facet_column->get_max_facet_id();
+            const bool use_flat_counts = (group_limit == 0) && !a_facet.is_range_query && a_facet.sort_field.empty() &&
+                                         min_facet_hash <= max_facet_hash &&
+                                         size_t(max_facet_hash - min_facet_hash) < 2 * results_size;
+
+            std::vector<flat_facet_count_t> flat_counts(use_flat_counts ? (max_facet_hash - min_facet_hash + 1) : 0);
+            bool facet_cutoff = false;
+
             for(size_t i = 0; i < results_size; i++) {
                 // if sampling is enabled, we will skip a portion of the results to speed up things
                 if(estimate_facets) {
@@ -1469,42 +1642,37 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                 }
 
                 uint32_t doc_seq_id = result_ids[i];
-                facet_index_it.skip_to(doc_seq_id);
-
-                if(!facet_index_it.valid()) {
-                    break;
-                }
+                const uint32_t* facet_hashes = nullptr;
+                const uint32_t num_facet_hashes = facet_column->get(doc_seq_id, facet_hashes);
 
-                if(facet_index_it.id() != doc_seq_id) {
+                if(num_facet_hashes == 0) {
                     continue;
                 }
 
-                facet_hashes.clear();
-                if(facet_field_is_array) {
-                    posting_list_t::get_offsets(facet_index_it, facet_hashes);
-                } else {
-                    facet_hashes.push_back(facet_index_it.offset());
-                }
-
                 uint64_t distinct_id = 0;
                 if(group_limit) {
                     distinct_id = 1;
                     for(auto& kv : group_by_field_it_vec) {
-                        get_distinct_id(kv.it, doc_seq_id, kv.is_array, group_missing_values, distinct_id, false);
+                        get_distinct_id(kv.column, doc_seq_id, group_missing_values, distinct_id);
                     }
                 }
                 //LOG(INFO) << "facet_hash_count " << facet_hash_count;
                 if(((i + 1) % 16384) == 0) {
-                    RETURN_CIRCUIT_BREAKER
+                    if ((std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().
+                        time_since_epoch()).count() - search_begin_us) > search_stop_us) {
+                        search_cutoff = true;
+                        facet_cutoff = true;
+                        break;
+                    }
                 }
 
                 std::set<uint32_t> unique_facet_hashes;
 
-                for(size_t j = 0; j < facet_hashes.size(); j++) {
+                for(size_t j = 0; j < num_facet_hashes; j++) {
                     const auto& fhash = facet_hashes[j];
 
                     // explicitly check for value of facet_hashes to avoid set lookup/insert for non-array faceting
-                    if(facet_hashes.size() > 1) {
+                    if(num_facet_hashes > 1) {
                         if(unique_facet_hashes.count(fhash) != 0) {
                             continue;
                         } else {
@@ -1512,7 +1680,7 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                         }
                     }
 
-                    if(should_compute_stats) {
+                    if(compute_stats_per_value) {
                         int64_t val = fhash;
                         if(facet_field_is_int64) {
                             if(fhash_int64_map.find(fhash) != fhash_int64_map.end()) {
@@ -1539,26 +1707,48 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                             }
                         }
                     } else if(!use_facet_query || fquery_hashes.find(fhash) != fquery_hashes.end()) {
-                        facet_count_t& facet_count = a_facet.result_map[fhash];
-                        //LOG(INFO) << "field: " << a_facet.field_name << ", doc id: " << doc_seq_id << ", hash: " <<  fhash;
-                        facet_count.doc_id = doc_seq_id;
-                        facet_count.array_pos = j;
-                        if(group_limit) {
-                            a_facet.hash_groups[fhash].emplace(distinct_id);
+                        if(use_flat_counts) {
+                            auto& flat_count = flat_counts[fhash - min_facet_hash];
+                            flat_count.count += 1;
+                            flat_count.doc_id = doc_seq_id;
+                            flat_count.array_pos = j;
                         } else {
-                            facet_count.count += 1;
+                            facet_count_t& facet_count = a_facet.result_map[fhash];
+                            //LOG(INFO) << "field: " << a_facet.field_name << ", doc id: " << doc_seq_id << ", hash: " <<  fhash;
+                            facet_count.doc_id = doc_seq_id;
+                            facet_count.array_pos = j;
+                            if(group_limit) {
+                                a_facet.hash_groups[fhash].emplace(distinct_id);
+                            } else {
+                                facet_count.count += 1;
+                            }
+                            if(!a_facet.sort_field.empty()) {
+                                facet_count.sort_field_val = get_doc_val_from_sort_index(facet_sort_index_it, doc_seq_id);
+                                //LOG(INFO) << "found sort_field val " << facet_count.sort_field;
+                            }
                         }
                         if(use_facet_query) {
                             //LOG (INFO) << "adding hash tokens for hash " << fhash;
                             a_facet.hash_tokens[fhash] = fquery_hashes.at(fhash);
                         }
-                        if(!a_facet.sort_field.empty()) {
-                            facet_count.sort_field_val = get_doc_val_from_sort_index(facet_sort_index_it, doc_seq_id);
-                            //LOG(INFO) << "found sort_field val " << facet_count.sort_field;
-                        }
                     }
                 }
             }
+
+            for(size_t k = 0; k < flat_counts.size(); k++) {
+                if(flat_counts[k].count == 0) {
+                    continue;
+                }
+
+                facet_count_t& facet_count = a_facet.result_map[min_facet_hash + k];
+                facet_count.count = flat_counts[k].count;
+                facet_count.doc_id = flat_counts[k].doc_id;
+                facet_count.array_pos = flat_counts[k].array_pos;
+            }
+
+            if(facet_cutoff) {
+                return ;
+            }
         }
     }
 }
@@ -1606,7 +1796,7 @@ Option<bool> Index::search_all_candidates(const size_t num_search_fields,
                                           const size_t max_candidates,
                                           int syn_orig_num_tokens,
                                           const int* sort_order,
-                                          std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values,
+                                          std::array<sort_column_t*, 3>& field_values,
                                           const std::vector<size_t>& geopoint_indices,
                                           std::set<uint64>& query_hashes,
                                           std::vector<uint32_t>& id_buff, const std::string& collection_name) const {
@@ -1654,7 +1844,7 @@ Option<bool> Index::search_all_candidates(const size_t num_search_fields,
                                                              searched_queries, qtoken_set, dropped_tokens,
                                                              group_limit, group_by_fields, group_missing_values,
                                                              prioritize_exact_match, prioritize_token_position,
-                                                             prioritize_num_matching_fields,
+                                                             prioritize_num_matching_fields, exhaustive_search,
                                                              filter_result_iterator,
                                                              total_cost, syn_orig_num_tokens,
                                                              exclude_token_ids, exclude_token_ids_size, excluded_group_ids,
@@ -1685,6 +1875,14 @@ Option<bool> Index::do_filtering_with_lock(filter_node_t* const filter_tree_root
                                            const std::string& collection_name) const {
     std::shared_lock lock(mutex);
 
+    field_locks_t::stripe_set_t stripes;
+    field_locks_t::add_field("id", stripes);
+    if(!field_locks_t::add_filter_fields(filter_tree_root, stripes)) {
+        stripes = field_locks_t::all_stripes();
+    }
+
+    field_locks_t::shared_lock_t field_lock(field_locks, stripes);
+
     auto filter_result_iterator = filter_result_iterator_t(collection_name, this, filter_tree_root,
                                                            search_begin_us, search_stop_us);
     auto filter_init_op = filter_result_iterator.init_status();
@@ -1745,6 +1943,15 @@ Option<bool> Index::do_reference_filtering_with_lock(filter_node_t* const filter
                                                      const std::string& reference_helper_field_name) const {
     std::shared_lock lock(mutex);
 
+    field_locks_t::stripe_set_t stripes;
+    field_locks_t::add_field("id", stripes);
+    field_locks_t::add_field(reference_helper_field_name, stripes);
+    if(!field_locks_t::add_filter_fields(filter_tree_root, stripes)) {
+        stripes = field_locks_t::all_stripes();
+    }
+
+    field_locks_t::shared_lock_t field_lock(field_locks, stripes);
+
     auto ref_filter_result_iterator = filter_result_iterator_t(ref_collection_name, this, filter_tree_root,
                                                                search_begin_us, search_stop_us);
     auto filter_init_op = ref_filter_result_iterator.init_status();
@@ -2440,6 +2647,25 @@ void Index::process_filter_overrides(const std::vector<const override_t*>& filte
                                      bool enable_typos_for_numerical_tokens) const {
     std::shared_lock lock(mutex);
 
+    // dynamic overrides look up query tokens in the fields named by the placeholders of their rules
+    field_locks_t::stripe_set_t stripes;
+    for(auto& override : filter_overrides) {
+        if(!override->rule.dynamic_query) {
+            continue;
+        }
+
+        std::vector<std::string> rule_parts;
+        StringUtils::split(override->rule.normalized_query, rule_parts, " ");
+
+        for(const auto& rule_part: rule_parts) {
+            if(rule_part.size() > 2 && rule_part.front() == '{' && rule_part.back() == '}') {
+                field_locks_t::add_field(rule_part.substr(1, rule_part.size() - 2), stripes);
+            }
+        }
+    }
+
+    field_locks_t::shared_lock_t field_lock(field_locks, stripes);
+
     for (auto& override : filter_overrides) {
         if (!override->rule.dynamic_query) {
             // Simple static filtering: add to filter_by and rewrite query if needed.
@@ -2567,7 +2793,7 @@ bool Index::check_for_overrides(const token_ordering& token_order, const string&
 
             uint32_t* filter_ids = nullptr;
             filter_result_iterator_t filter_result_it(filter_ids, 0);
-            std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values{};
+            std::array<sort_column_t*, 3> field_values{};
             const std::vector<size_t> geopoint_indices;
             tsl::htrie_map<char, token_leaf> qtoken_set;
 
@@ -2666,21 +2892,26 @@ Option<bool> Index::search_infix(const std::string& query, const std::string& fi
             auto op_search_stop_ms = parent_search_stop_ms/2;
 
             std::vector<art_leaf*> this_leaves;
-            std::string key_buffer;
             size_t num_iterated = 0;
 
-            for(auto it = infix_set->begin(); it != infix_set->end(); it++) {
-                it.key(key_buffer);
+            const size_t max_extra_len = (max_extra_prefix > SIZE_MAX - max_extra_suffix) ? SIZE_MAX :
+                                         (max_extra_prefix + max_extra_suffix);
+
+            // only the tokens that have all the trigrams of the query are visited
+            infix_set->for_each_candidate(query, [&](const std::string& token) {
                 num_iterated++;
 
-                auto start_index = key_buffer.find(query);
-                if(start_index != std::string::npos && start_index <= max_extra_prefix &&
-                   (key_buffer.size() - (start_index + query.size())) <= max_extra_suffix) {
-                    art_leaf* l = (art_leaf *) art_search(search_tree,
-                                                          (const unsigned char *) key_buffer.c_str(),
-                                                          key_buffer.size()+1);
-                    if(l != nullptr) {
-                        this_leaves.push_back(l);
+                // tokens with too many extra characters can be ruled out from their length alone
+                if(token.size() >= query.size() && token.size() - query.size() <= max_extra_len) {
+                    auto start_index = token.find(query);
+                    if(start_index != std::string::npos && start_index <= max_extra_prefix &&
+                       (token.size() - (start_index + query.size())) <= max_extra_suffix) {
+                        art_leaf* l = (art_leaf *) art_search(search_tree,
+                                                              (const unsigned char *) token.c_str(),
+                                                              token.size()+1);
+                        if(l != nullptr) {
+                            this_leaves.push_back(l);
+                        }
                     }
                 }
 
@@ -2689,10 +2920,12 @@ Option<bool> Index::search_infix(const std::string& query, const std::string& fi
                     if ((std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().
                         time_since_epoch()).count() - search_begin_us) > op_search_stop_ms) {
                         search_cutoff = true;
-                        break;
+                        return false;
                     }
                 }
-            }
+
+                return true;
+            });
 
             std::unique_lock<std::mutex> lock(m_process);
             leaves.insert(leaves.end(), this_leaves.begin(), this_leaves.end());
@@ -2713,6 +2946,83 @@ Option<bool> Index::search_infix(const std::string& query, const std::string& fi
     return Option<bool>(true);
 }
 
+vector_search_plan_t Index::plan_filtered_vector_search(size_t num_filter_ids, size_t num_vectors, size_t k,
+                                                        size_t ef) {
+    vector_search_plan_t plan;
+    const size_t num_candidates = std::max(k, ef);
+
+    if(num_filter_ids == 0 || num_vectors == 0) {
+        plan.strategy = vector_search_plan_t::flat;
+        plan.ef = num_candidates;
+        return plan;
+    }
+
+    const double selectivity = std::min(1.0, double(num_filter_ids) / num_vectors);
+    plan.ef = std::ceil(num_candidates / selectivity);
+
+    if(selectivity >= BROAD_VECTOR_FILTER_SELECTIVITY) {
+        plan.strategy = vector_search_plan_t::iterator_filtered_hnsw;
+    } else if(num_filter_ids <= plan.ef * HNSW_DISTANCES_PER_EF) {
+        // the exact search computes a distance per filtered id, the graph search about HNSW_DISTANCES_PER_EF per
+        // entry of its candidate list
+        plan.strategy = vector_search_plan_t::flat;
+    } else {
+        plan.strategy = vector_search_plan_t::ids_filtered_hnsw;
+    }
+
+    return plan;
+}
+
+std::vector<std::pair<float, size_t>> Index::search_filtered_vectors(hnsw_index_t* field_vector_index,
+                                                                     const float* query, size_t k, size_t ef,
+                                                                     filter_result_iterator_t* filter_result_iterator,
+                                                                     const uint32_t* excluded_ids,
+                                                                     size_t excluded_ids_length,
+                                                                     bool& search_cutoff) {
+    if(filter_result_iterator->approx_filter_ids_length == 0) {
+        // not filtered
+        VectorFilterFunctor filterFunctor(filter_result_iterator, excluded_ids, excluded_ids_length);
+        return field_vector_index->search_knn(query, k, ef, &filterFunctor);
+    }
+
+    const size_t num_vectors = field_vector_index->vecdex->getCurrentElementCount() -
+                               field_vector_index->vecdex->getDeletedCount();
+
+    // the upper bound of the filter's ids is enough to tell whether it is broad
+    auto plan = plan_filtered_vector_search(filter_result_iterator->approx_filter_ids_length, num_vectors, k, ef);
+
+    if(plan.strategy == vector_search_plan_t::iterator_filtered_hnsw) {
+        VectorFilterFunctor filterFunctor(filter_result_iterator, excluded_ids, excluded_ids_length);
+        return field_vector_index->search_knn(query, k, plan.ef, &filterFunctor);
+    }
+
+    filter_result_iterator->reset();
+    uint32_t* filter_ids = nullptr;
+    uint32_t filter_ids_length = filter_result_iterator->to_filter_id_array(filter_ids);
+    search_cutoff = search_cutoff || filter_result_iterator->validity == filter_result_iterator_t::timed_out;
+    filter_result_iterator->reset();
+
+    if(excluded_ids_length != 0) {
+        uint32_t* included_ids = nullptr;
+        filter_ids_length = ArrayUtils::exclude_scalar(filter_ids, filter_ids_length, excluded_ids, excluded_ids_length,
+                                                       &included_ids);
+        delete [] filter_ids;
+        filter_ids = included_ids;
+    }
+
+    std::unique_ptr<uint32_t[]> filter_ids_guard(filter_ids);
+
+    // planned again on the exact number of ids
+    plan = plan_filtered_vector_search(filter_ids_length, num_vectors, k, ef);
+
+    if(plan.strategy == vector_search_plan_t::flat) {
+        return field_vector_index->flat_search_knn(query, filter_ids, filter_ids_length, k);
+    }
+
+    VectorFilterIdsFunctor filterFunctor(filter_ids, filter_ids_length);
+    return field_vector_index->search_knn(query, k, plan.ef, &filterFunctor);
+}
+
 Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::vector<search_field_t>& the_fields,
                    const text_match_type_t match_type,
                    filter_node_t*& filter_tree_root, std::vector<facet>& facets, facet_query_t& facet_query,
@@ -2745,6 +3055,11 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                    bool enable_lazy_filter) const {
     std::shared_lock lock(mutex);
 
+    // batches being indexed hold only the fields that they write: wait just for the ones read here
+    field_locks_t::shared_lock_t field_lock(field_locks, get_search_stripes(the_fields, filter_tree_root, facets,
+                                                                            sort_fields_std, group_by_fields,
+                                                                            vector_query, default_sorting_field));
+
     auto filter_result_iterator = new filter_result_iterator_t(collection_name, this, filter_tree_root,
                                                                search_begin_us, search_stop_us);
     std::unique_ptr<filter_result_iterator_t> filter_iterator_guard(filter_result_iterator);
@@ -2799,7 +3114,7 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
     handle_exclusion(num_search_fields, field_query_tokens, the_fields, exclude_token_ids, exclude_token_ids_size);
 
     int sort_order[3];  // 1 or -1 based on DESC or ASC respectively
-    std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values;
+    std::array<sort_column_t*, 3> field_values;
     std::vector<size_t> geopoint_indices;
     populate_sort_mapping(sort_order, geopoint_indices, sort_fields_std, field_values);
 
@@ -2852,7 +3167,7 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
 
             std::vector<group_by_field_it_t> group_by_field_it_vec;
             if (group_limit != 0) {
-                group_by_field_it_vec = get_group_by_field_iterators(group_by_fields, true);
+                group_by_field_it_vec = get_group_by_field_iterators(group_by_fields);
             }
 
             while (it.valid()) {
@@ -2861,7 +3176,7 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                 if (group_limit != 0) {
                     distinct_id = 1;
                     for(auto& kv : group_by_field_it_vec) {
-                        get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id, true);
+                        get_distinct_id(kv.column, seq_id, group_missing_values, distinct_id);
                     }
                     if(excluded_group_ids.count(distinct_id) != 0) {
                        continue;
@@ -2906,6 +3221,14 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
 
             std::vector<std::pair<float, single_filter_result_t>> dist_results;
 
+            std::vector<float> normalized_q;
+            const float* query = vector_query.values.data();
+            if(field_vector_index->distance_type == cosine) {
+                normalized_q.resize(vector_query.values.size());
+                hnsw_index_t::normalize_vector(vector_query.values, normalized_q);
+                query = normalized_q.data();
+            }
+
             uint32_t filter_id_count = 0;
             while (!no_filters_provided &&
                     filter_id_count < vector_query.flat_search_cutoff && filter_result_iterator->validity == filter_result_iterator_t::valid) {
@@ -2915,22 +3238,14 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                 std::vector<float> values;
 
                 try {
-                    values = field_vector_index->vecdex->getDataByLabel<float>(seq_id);
+                    values = field_vector_index->get_vector(seq_id);
                 } catch(...) {
                     // likely not found
                     continue;
                 }
 
-                float dist;
-                if(field_vector_index->distance_type == cosine) {
-                    std::vector<float> normalized_q(vector_query.values.size());
-                    hnsw_index_t::normalize_vector(vector_query.values, normalized_q);
-                    dist = field_vector_index->space->get_dist_func()(normalized_q.data(), values.data(),
-                                                                      &field_vector_index->num_dim);
-                } else {
-                    dist = field_vector_index->space->get_dist_func()(vector_query.values.data(), values.data(),
-                                                                      &field_vector_index->num_dim);
-                }
+                float dist = field_vector_index->space->get_dist_func()(query, values.data(),
+                                                                        &field_vector_index->num_dim);
 
                 dist_results.emplace_back(dist, filter_result);
                 filter_id_count++;
@@ -2942,15 +3257,13 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                 (filter_id_count >= vector_query.flat_search_cutoff && filter_result_iterator->validity == filter_result_iterator_t::valid)) {
                 dist_results.clear();
 
-                VectorFilterFunctor filterFunctor(filter_result_iterator);
-
                 std::vector<std::pair<float, size_t>> pairs;
-                if(field_vector_index->distance_type == cosine) {
-                    std::vector<float> normalized_q(vector_query.values.size());
-                    hnsw_index_t::normalize_vector(vector_query.values, normalized_q);
-                    pairs = field_vector_index->vecdex->searchKnnCloserFirst(normalized_q.data(), k, vector_query.ef, &filterFunctor);
+                if(no_filters_provided) {
+                    VectorFilterFunctor filterFunctor(filter_result_iterator);
+                    pairs = field_vector_index->search_knn(query, k, vector_query.ef, &filterFunctor);
                 } else {
-                    pairs = field_vector_index->vecdex->searchKnnCloserFirst(vector_query.values.data(), k, vector_query.ef, &filterFunctor);
+                    pairs = search_filtered_vectors(field_vector_index, query, k, vector_query.ef,
+                                                    filter_result_iterator, nullptr, 0, search_cutoff);
                 }
 
                 std::sort(pairs.begin(), pairs.end(), [](auto& x, auto& y) {
@@ -3002,7 +3315,7 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                 if (group_limit != 0) {
                     distinct_id = 1;
                     for(auto &kv : group_by_field_it_vec) {
-                        get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id);
+                        get_distinct_id(kv.column, seq_id, group_missing_values, distinct_id);
                     }
 
                     if(excluded_group_ids.count(distinct_id) != 0) {
@@ -3329,7 +3642,6 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                 const float VECTOR_SEARCH_WEIGHT = vector_query.alpha;
                 const float TEXT_MATCH_WEIGHT = 1.0 - VECTOR_SEARCH_WEIGHT;
 
-                VectorFilterFunctor filterFunctor(filter_result_iterator, excluded_result_ids, excluded_result_ids_size);
                 auto& field_vector_index = vector_index.at(vector_query.field_name);
 
                 std::vector<std::pair<float, size_t>> dist_labels;
@@ -3339,9 +3651,13 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                 if(field_vector_index->distance_type == cosine) {
                     std::vector<float> normalized_q(vector_query.values.size());
                     hnsw_index_t::normalize_vector(vector_query.values, normalized_q);
-                    dist_labels = field_vector_index->vecdex->searchKnnCloserFirst(normalized_q.data(), k, vector_query.ef, &filterFunctor);
+                    dist_labels = search_filtered_vectors(field_vector_index, normalized_q.data(), k, vector_query.ef,
+                                                          filter_result_iterator, excluded_result_ids,
+                                                          excluded_result_ids_size, search_cutoff);
                 } else {
-                    dist_labels = field_vector_index->vecdex->searchKnnCloserFirst(vector_query.values.data(), k, vector_query.ef, &filterFunctor);
+                    dist_labels = search_filtered_vectors(field_vector_index, vector_query.values.data(), k,
+                                                          vector_query.ef, filter_result_iterator, excluded_result_ids,
+                                                          excluded_result_ids_size, search_cutoff);
                 }
                 filter_result_iterator->reset();
                 search_cutoff = search_cutoff || filter_result_iterator->validity == filter_result_iterator_t::timed_out;
@@ -3472,7 +3788,7 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                             distinct_id = 1;
 
                             for(auto& kv : group_by_field_it_vec) {
-                                get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id);
+                                get_distinct_id(kv.column, seq_id, group_missing_values, distinct_id);
                             }
 
                             if(excluded_group_ids.count(distinct_id) != 0) {
@@ -3525,32 +3841,64 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
 
         const size_t window_size = (num_threads == 0) ? 0 :
                                    (all_result_ids_len + num_threads - 1) / num_threads;  // rounds up
-        size_t num_processed = 0;
         std::mutex m_process;
-        std::condition_variable cv_process;
 
         std::vector<facet_info_t> facet_infos(facets.size());
         compute_facet_infos(facets, facet_query, facet_query_num_typos, all_result_ids, all_result_ids_len,
                             group_by_fields, group_limit, is_wildcard_no_filter_query,
-                            max_candidates, facet_infos, facet_index_type);
+                            max_candidates, max_facet_values, facet_infos, facet_index_type);
 
         std::vector<std::vector<facet>> facet_batches(num_threads);
         std::vector<std::vector<facet>> value_facets(concurrency);
         size_t num_value_facets = 0;
 
+        // Hash based facets are counted over `num_threads` windows of the result ids. Value based facets are counted
+        // over all of the results: the heaviest ones are placed first, each on the least loaded thread, and a facet
+        // that costs more than an even share of the total work also splits its values across several tasks.
+        std::vector<size_t> value_facet_indices;
+        size_t total_facet_cost = 0;
+
         for(size_t i = 0; i < facets.size(); i++) {
-            const auto& this_facet = facets[i];
+            total_facet_cost += facet_infos[i].cost;
 #ifdef TEST_BUILD
             if(facet_index_type == VALUE) {
 #else
             if(facet_infos[i].use_value_index) {
 #endif
-                // value based faceting on a single thread
-                value_facets[num_value_facets % num_threads].emplace_back(this_facet.field_name, this_facet.orig_index,
-                                          this_facet.facet_range_map,
+                value_facet_indices.push_back(i);
+            }
+        }
+
+        std::sort(value_facet_indices.begin(), value_facet_indices.end(), [&facet_infos](size_t a, size_t b) {
+            return facet_infos[a].cost > facet_infos[b].cost;
+        });
+
+        const size_t facet_task_cost = std::max(facet_index_t::MIN_FACET_TASK_COST,
+                                                total_facet_cost / std::max<size_t>(1, concurrency));
+        std::vector<size_t> value_thread_costs(concurrency, 0);
+
+        for(auto i: value_facet_indices) {
+            const auto& this_facet = facets[i];
+            facet_infos[i].num_value_tasks = std::max<size_t>(1, std::min(concurrency,
+                                                                          facet_infos[i].cost / facet_task_cost));
+
+            auto min_cost_it = std::min_element(value_thread_costs.begin(), value_thread_costs.end());
+            *min_cost_it += facet_infos[i].cost / facet_infos[i].num_value_tasks;
+
+            value_facets[min_cost_it - value_thread_costs.begin()].emplace_back(this_facet.field_name,
+                                          this_facet.orig_index, this_facet.facet_range_map,
                                           this_facet.is_range_query, this_facet.is_sort_by_alpha,
                                           this_facet.sort_order, this_facet.sort_field);
-                num_value_facets++;
+            num_value_facets++;
+        }
+
+        for(size_t i = 0; i < facets.size(); i++) {
+            const auto& this_facet = facets[i];
+#ifdef TEST_BUILD
+            if(facet_index_type == VALUE) {
+#else
+            if(facet_infos[i].use_value_index) {
+#endif
                 continue;
             }
 
@@ -3561,13 +3909,14 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
             }
         }
 
-        size_t num_queued = 0;
         size_t result_index = 0;
 
         const auto parent_search_begin = search_begin_us;
         const auto parent_search_stop_ms = search_stop_us;
         auto parent_search_cutoff = search_cutoff;
 
+        ThreadPool::task_group_t facet_group(thread_pool, ThreadPool::HIGH);
+
         //auto beginF = std::chrono::high_resolution_clock::now();
 
         for(size_t thread_id = 0; thread_id < num_threads && result_index < all_result_ids_len; thread_id++) {
@@ -3582,14 +3931,13 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
             }
 
             uint32_t* batch_result_ids = all_result_ids + result_index;
-            num_queued++;
-
-            thread_pool->enqueue([this, thread_id, &facets, &facet_batches, &facet_query, group_limit, group_by_fields,
-                                         batch_result_ids, batch_res_len, &facet_infos, max_facet_values,
-                                         is_wildcard_no_filter_query, estimate_facets,
-                                         facet_sample_percent, group_missing_values,
-                                         &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
-                                         &num_processed, &m_process, &cv_process, facet_index_type]() {
+
+            facet_group.run([this, thread_id, &facets, &facet_batches, &facet_query, group_limit, group_by_fields,
+                                    batch_result_ids, batch_res_len, &facet_infos, max_facet_values,
+                                    is_wildcard_no_filter_query, estimate_facets,
+                                    facet_sample_percent, group_missing_values,
+                                    &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
+                                    &m_process, facet_index_type]() {
                 search_begin_us = parent_search_begin;
                 search_stop_us = parent_search_stop_ms;
                 search_cutoff = false;
@@ -3608,9 +3956,7 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                     aggregate_facet(group_limit, this_facet, acc_facet);
                 }
 
-                num_processed++;
                 parent_search_cutoff = parent_search_cutoff || search_cutoff;
-                cv_process.notify_one();
             });
 
             result_index += batch_res_len;
@@ -3622,14 +3968,12 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                 continue;
             }
 
-            num_queued++;
-
-            thread_pool->enqueue([this, thread_id, &facets, &value_facets, &facet_query, group_limit, group_by_fields,
-                                         all_result_ids, all_result_ids_len, &facet_infos, max_facet_values,
-                                         is_wildcard_no_filter_query, estimate_facets,
-                                         facet_sample_percent, group_missing_values,
-                                         &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
-                                         &num_processed, &m_process, &cv_process, facet_index_type]() {
+            facet_group.run([this, thread_id, &facets, &value_facets, &facet_query, group_limit, group_by_fields,
+                                    all_result_ids, all_result_ids_len, &facet_infos, max_facet_values,
+                                    is_wildcard_no_filter_query, estimate_facets,
+                                    facet_sample_percent, group_missing_values,
+                                    &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
+                                    &m_process, facet_index_type]() {
                 search_begin_us = parent_search_begin;
                 search_stop_us = parent_search_stop_ms;
                 search_cutoff = false;
@@ -3648,14 +3992,11 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
                     aggregate_facet(group_limit, this_facet, acc_facet);
                 }
 
-                num_processed++;
                 parent_search_cutoff = parent_search_cutoff || search_cutoff;
-                cv_process.notify_one();
             });
         }
 
-        std::unique_lock<std::mutex> lock_process(m_process);
-        cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
+        facet_group.wait();
         search_cutoff = parent_search_cutoff;
 
         for(auto & acc_facet: facets) {
@@ -3685,7 +4026,7 @@ Option<bool> Index::search(std::vector<query_tokens_t>& field_query_tokens, cons
     compute_facet_infos(facets, facet_query, facet_query_num_typos,
                         &included_ids_vec[0], included_ids_vec.size(), group_by_fields,
                         group_limit, is_wildcard_no_filter_query,
-                        max_candidates, facet_infos, facet_index_type);
+                        max_candidates, max_facet_values, facet_infos, facet_index_type);
     do_facets(facets, facet_query, estimate_facets, facet_sample_percent,
               facet_infos, group_limit, group_by_fields, group_missing_values, &included_ids_vec[0], 
               included_ids_vec.size(), max_facet_values, is_wildcard_no_filter_query,
@@ -3800,7 +4141,7 @@ void Index::process_curated_ids(const std::vector<std::pair<uint32_t, uint32_t>>
         for(auto seq_id: included_ids_vec) {
             uint64_t distinct_id = 1;
             for(auto& kv : group_by_field_it_vec) {
-                get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id);
+                get_distinct_id(kv.column, seq_id, group_missing_values, distinct_id);
             }
 
             excluded_group_ids.emplace(distinct_id);
@@ -3902,7 +4243,7 @@ Option<bool> Index::fuzzy_search_fields(const std::vector<search_field_t>& the_f
                                         size_t min_len_2typo,
                                         int syn_orig_num_tokens,
                                         const int* sort_order,
-                                        std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values,
+                                        std::array<sort_column_t*, 3>& field_values,
                                         const std::vector<size_t>& geopoint_indices,
                                         const std::string& collection_name,
                                         bool enable_typos_for_numerical_tokens) const {
@@ -4322,12 +4663,13 @@ Option<bool> Index::search_across_fields(const std::vector<token_t>& query_token
                                          const bool prioritize_exact_match,
                                          const bool prioritize_token_position,
                                          const bool prioritize_num_matching_fields,
+                                         const bool exhaustive_search,
                                          filter_result_iterator_t* const filter_result_iterator,
                                          const uint32_t total_cost, const int syn_orig_num_tokens,
                                          const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
                                          const std::unordered_set<uint32_t>& excluded_group_ids,
                                          const int* sort_order,
-                                         std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values,
+                                         std::array<sort_column_t*, 3>& field_values,
                                          const std::vector<size_t>& geopoint_indices,
                                          std::vector<uint32_t>& id_buff,
                                          uint32_t*& all_result_ids, size_t& all_result_ids_len,
@@ -4449,6 +4791,17 @@ Option<bool> Index::search_across_fields(const std::vector<token_t>& query_token
 
     auto group_by_field_it_vec = get_group_by_field_iterators(group_by_fields);
 
+    // Dynamic pruning: once the topster is full, a document whose text match upper bound is below the weakest
+    // entry of the topster cannot enter it, so scoring it can be skipped. This is only exact when the text match is
+    // the primary sort key and there is no grouping. Dropped tokens can add matches in further fields, so their
+    // presence also disables pruning.
+    const bool prune_by_text_match = !exhaustive_search && topster != nullptr && group_limit == 0 &&
+                                     dropped_tokens.empty() && !sort_fields.empty() &&
+                                     field_values[0] == &text_match_sentinel_value;
+    const bool single_exact_query_token = (total_cost == 0 && query_tokens.size() == 1);
+    std::vector<uint32_t> field_num_tokens(num_search_fields);
+    std::vector<uint32_t> field_min_positions(num_search_fields);
+
     or_iterator_t::intersect(token_its, istate,
                              [&](single_filter_result_t& filter_result, const std::vector<or_iterator_t>& its) {
         auto& seq_id = filter_result.seq_id;
@@ -4458,6 +4811,52 @@ Option<bool> Index::search_across_fields(const std::vector<token_t>& query_token
             return ;
         }
 
+        if(prune_by_text_match && topster->MAX_SIZE != 0 && topster->size >= topster->MAX_SIZE) {
+            std::fill(field_num_tokens.begin(), field_num_tokens.end(), 0);
+            std::fill(field_min_positions.begin(), field_min_positions.end(), UINT32_MAX);
+
+            for(const auto& token_fields_iters: its) {
+                for(const auto& field_iter: token_fields_iters.get_its()) {
+                    if(field_iter.valid() && field_iter.id() == seq_id) {
+                        const auto fi = field_iter.get_field_id();
+                        field_num_tokens[fi]++;
+                        field_min_positions[fi] = std::min(field_min_positions[fi], field_iter.block_min_position());
+                    }
+                }
+            }
+
+            uint64_t max_field_match_score = 0;
+            int64_t max_field_weight = 0;
+            size_t num_fields = 0;
+
+            for(size_t fi = 0; fi < num_search_fields; fi++) {
+                if(field_num_tokens[fi] == 0) {
+                    continue;
+                }
+
+                num_fields++;
+                max_field_weight = std::max<int64_t>(max_field_weight, the_fields[fi].weight);
+                max_field_match_score = std::max(max_field_match_score,
+                                                 field_match_score_upper_bound(field_num_tokens[fi],
+                                                                               query_tokens.size(),
+                                                                               syn_orig_num_tokens, total_cost,
+                                                                               field_min_positions[fi],
+                                                                               prioritize_exact_match,
+                                                                               single_exact_query_token,
+                                                                               prioritize_token_position));
+            }
+
+            const size_t max_query_len = (syn_orig_num_tokens != -1) ? syn_orig_num_tokens : query_tokens.size();
+            const uint64_t score_upper_bound = aggregate_text_match_score(match_type, max_query_len,
+                                                                          max_field_match_score, max_field_weight,
+                                                                          prioritize_num_matching_fields ? num_fields : 0);
+
+            if(int64_t(score_upper_bound) < topster->getKV(0)->scores[0]) {
+                result_ids.push_back(seq_id);
+                return ;
+            }
+        }
+
         auto references = std::move(filter_result.reference_filter_results);
         //LOG(INFO) << "seq_id: " << seq_id;
         // Convert [token -> fields] orientation to [field -> tokens] orientation
@@ -4541,7 +4940,7 @@ Option<bool> Index::search_across_fields(const std::vector<token_t>& query_token
         if(group_limit != 0) {
             distinct_id = 1;
             for(auto& kv : group_by_field_it_vec) {
-                get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id);
+                get_distinct_id(kv.column, seq_id, group_missing_values, distinct_id);
             }
 
             if(excluded_group_ids.count(distinct_id) != 0) {
@@ -4560,39 +4959,12 @@ Option<bool> Index::search_across_fields(const std::vector<token_t>& query_token
             return;
         }
 
-        query_len = std::min<size_t>(15, query_len);
-
-        // NOTE: `query_len` is total tokens matched across fields.
-        // Within a field, only a subset can match
-
-        // MAX_SCORE
-        // [ sign | tokens_matched | max_field_score | max_field_weight | num_matching_fields ]
-        // [   1  |        4       |        48       |       8          |         3           ]  (64 bits)
-
-        // MAX_WEIGHT
-        // [ sign | tokens_matched | max_field_weight | max_field_score  | num_matching_fields ]
-        // [   1  |        4       |        8         |      48          |         3           ]  (64 bits)
-
-        auto max_field_weight = std::min<size_t>(FIELD_MAX_WEIGHT, best_field_weight);
-        num_matching_fields = std::min<size_t>(7, num_matching_fields);
-
         if(!prioritize_num_matching_fields) {
             num_matching_fields = 0;
         }
 
-        uint64_t aggregated_score = match_type == max_score ?
-                                    ((int64_t(query_len) << 59) |
-                                    (int64_t(best_field_match_score) << 11) |
-                                    (int64_t(max_field_weight) << 3) |
-                                    (int64_t(num_matching_fields) << 0))
-
-                                    :
-
-                                    ((int64_t(query_len) << 59) |
-                                     (int64_t(max_field_weight) << 51) |
-                                     (int64_t(best_field_match_score) << 3) |
-                                     (int64_t(num_matching_fields) << 0))
-                                    ;
+        uint64_t aggregated_score = aggregate_text_match_score(match_type, query_len, best_field_match_score,
+                                                               best_field_weight, num_matching_fields);
 
         /*LOG(INFO) << "seq_id: " << seq_id << ", query_len: " << query_len
                   << ", syn_orig_num_tokens: " << syn_orig_num_tokens
@@ -4659,7 +5031,7 @@ Option<bool> Index::search_across_fields(const std::vector<token_t>& query_token
 }
 
 Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields, const int* sort_order,
-                                        std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values,
+                                        std::array<sort_column_t*, 3> field_values,
                                         const std::vector<size_t>& geopoint_indices,
                                         uint32_t seq_id, const std::map<basic_string<char>, reference_filter_result_t>& references,
                                         std::vector<uint32_t>& filter_indexes, int64_t max_field_match_score, int64_t* scores,
@@ -4676,10 +5048,8 @@ Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields,
         GeoPoint::unpack_lat_lng(sort_fields[i].geopoint, reference_lat_lng);
 
         if(geopoints != nullptr) {
-            auto it = geopoints->find(seq_id);
-
-            if(it != geopoints->end()) {
-                int64_t packed_latlng = it->second;
+            if(geopoints->contains(seq_id)) {
+                int64_t packed_latlng = geopoints->at(seq_id);
                 S2LatLng s2_lat_lng;
                 GeoPoint::unpack_lat_lng(packed_latlng, s2_lat_lng);
                 dist = GeoPoint::distance(s2_lat_lng, reference_lat_lng);
@@ -4870,7 +5240,7 @@ Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields,
         } else if(field_values[0] == &vector_query_sentinel_value) {
             scores[0] = float_to_int64_t(2.0f);
             try {
-                const auto& values = sort_fields[0].vector_query.vector_index->vecdex->getDataByLabel<float>(seq_id);
+                const auto& values = sort_fields[0].vector_query.vector_index->get_vector(seq_id);
                 const auto& dist_func = sort_fields[0].vector_query.vector_index->space->get_dist_func();
                 float dist = dist_func(sort_fields[0].vector_query.query.values.data(), values.data(), &sort_fields[0].vector_query.vector_index->num_dim);
                 
@@ -4880,8 +5250,8 @@ Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields,
                 // do nothing
             }
         } else {
-            auto it = field_values[0]->find(sort_fields[0].reference_collection_name.empty() ? seq_id : ref_seq_id);
-            scores[0] = (it == field_values[0]->end()) ? default_score : it->second;
+            scores[0] = field_values[0]->get(sort_fields[0].reference_collection_name.empty() ? seq_id : ref_seq_id,
+                                            default_score);
 
             if(scores[0] == INT64_MIN && sort_fields[0].missing_values == sort_by::missing_values_t::first) {
                 // By default, missing numerical value are always going to be sorted to be at the end
@@ -5045,7 +5415,7 @@ Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields,
         } else if(field_values[1] == &vector_query_sentinel_value) {
             scores[1] = float_to_int64_t(2.0f);
             try {
-                const auto& values = sort_fields[1].vector_query.vector_index->vecdex->getDataByLabel<float>(seq_id);
+                const auto& values = sort_fields[1].vector_query.vector_index->get_vector(seq_id);
                 const auto& dist_func = sort_fields[1].vector_query.vector_index->space->get_dist_func();
                 float dist = dist_func(sort_fields[1].vector_query.query.values.data(), values.data(), &sort_fields[1].vector_query.vector_index->num_dim);
                 
@@ -5056,8 +5426,8 @@ Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields,
             }
 
         } else {
-            auto it = field_values[1]->find(sort_fields[1].reference_collection_name.empty() ? seq_id : ref_seq_id);
-            scores[1] = (it == field_values[1]->end()) ? default_score : it->second;
+            scores[1] = field_values[1]->get(sort_fields[1].reference_collection_name.empty() ? seq_id : ref_seq_id,
+                                            default_score);
             if(scores[1] == INT64_MIN && sort_fields[1].missing_values == sort_by::missing_values_t::first) {
                 bool is_asc = (sort_order[1] == -1);
                 scores[1] = is_asc ? (INT64_MIN + 1) : INT64_MAX;
@@ -5217,7 +5587,7 @@ Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields,
         } else if(field_values[2] == &vector_query_sentinel_value) {
             scores[2] = float_to_int64_t(2.0f);
             try {
-                const auto& values = sort_fields[2].vector_query.vector_index->vecdex->getDataByLabel<float>(seq_id);
+                const auto& values = sort_fields[2].vector_query.vector_index->get_vector(seq_id);
                 const auto& dist_func = sort_fields[2].vector_query.vector_index->space->get_dist_func();
                 float dist = dist_func(sort_fields[2].vector_query.query.values.data(), values.data(), &sort_fields[2].vector_query.vector_index->num_dim);
                 
@@ -5227,8 +5597,8 @@ Option<bool> Index::compute_sort_scores(const std::vector<sort_by>& sort_fields,
                 // do nothing
             }
         } else {
-            auto it = field_values[2]->find(sort_fields[2].reference_collection_name.empty() ? seq_id : ref_seq_id);
-            scores[2] = (it == field_values[2]->end()) ? default_score : it->second;
+            scores[2] = field_values[2]->get(sort_fields[2].reference_collection_name.empty() ? seq_id : ref_seq_id,
+                                            default_score);
             if(scores[2] == INT64_MIN && sort_fields[2].missing_values == sort_by::missing_values_t::first) {
                 bool is_asc = (sort_order[2] == -1);
                 scores[2] = is_asc ? (INT64_MIN + 1) : INT64_MAX;
@@ -5251,7 +5621,7 @@ Option<bool> Index::do_phrase_search(const size_t num_search_fields, const std::
                                      const bool group_missing_values,
                                      Topster* actual_topster,
                                      const int sort_order[3],
-                                     std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values,
+                                     std::array<sort_column_t*, 3> field_values,
                                      const std::vector<size_t>& geopoint_indices,
                                      const std::vector<uint32_t>& curated_ids_sorted,
                                      filter_result_iterator_t*& filter_result_iterator,
@@ -5398,7 +5768,7 @@ Option<bool> Index::do_phrase_search(const size_t num_search_fields, const std::
         if(group_limit != 0) {
             distinct_id = 1;
             for(auto& kv : group_by_field_it_vec) {
-                get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id);
+                get_distinct_id(kv.column, seq_id, group_missing_values, distinct_id);
             }
 
             if(excluded_group_ids.count(distinct_id) != 0) {
@@ -5452,7 +5822,7 @@ Option<bool> Index::do_synonym_search(const std::vector<search_field_t>& the_fie
                                       filter_result_iterator_t* const filter_result_iterator,
                                       std::set<uint64>& query_hashes,
                                       const int* sort_order,
-                                      std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values,
+                                      std::array<sort_column_t*, 3>& field_values,
                                       const std::vector<size_t>& geopoint_indices,
                                       tsl::htrie_map<char, token_leaf>& qtoken_set,
                                       const std::string& collection_name) const {
@@ -5492,7 +5862,7 @@ Option<bool> Index::do_infix_search(const size_t num_search_fields, const std::v
                                     const std::vector<token_t>& query_tokens, Topster* actual_topster,
                                     filter_result_iterator_t* const filter_result_iterator,
                                     const int sort_order[3],
-                                    std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values,
+                                    std::array<sort_column_t*, 3> field_values,
                                     const std::vector<size_t>& geopoint_indices,
                                     const std::vector<uint32_t>& curated_ids_sorted,
                                     const std::unordered_set<uint32_t>& excluded_group_ids,
@@ -5573,7 +5943,7 @@ Option<bool> Index::do_infix_search(const size_t num_search_fields, const std::v
                     if(group_limit != 0) {
                         distinct_id = 1;
                         for(auto& kv : group_by_field_it_vec) {
-                            get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id);
+                            get_distinct_id(kv.column, seq_id, group_missing_values, distinct_id);
                         }
 
                         if(excluded_group_ids.count(distinct_id) != 0) {
@@ -5669,7 +6039,7 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
                                 uint32_t* all_result_ids, const size_t& all_result_ids_len,
                                 const std::vector<std::string>& group_by_fields,
                                 const size_t group_limit, const bool is_wildcard_no_filter_query,
-                                const size_t max_candidates,
+                                const size_t max_candidates, const size_t max_facet_count,
                                 std::vector<facet_info_t>& facet_infos, facet_index_type_t facet_index_type) const {
 
     if(all_result_ids_len == 0) {
@@ -5689,13 +6059,30 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
                                                     facet_field.type != field_types::STRING_ARRAY &&
                                                     facet_field.type != field_types::BOOL_ARRAY);
 
+        // counting through the hash index looks up every result id, unless the value index turns out to be cheaper
+        facet_infos[findex].cost = all_result_ids_len * facet_index_t::HASH_COUNT_COST;
+
+        // the value index stops counting after twice the requested number of values, walking them in the order of
+        // their counts over all documents: that finds the top values of the results only when the field has few
+        // values or the results cover most of the documents, so the costs are compared just in those cases
         size_t num_facet_values = facet_index_v4->get_facet_count(facet_field.name);
+        const bool value_index_finds_top_values = (all_result_ids_len > 1000 && num_facet_values < 250) ||
+                                                  (all_result_ids_len > 1000 && all_result_ids_len * 2 > total_docs);
+
         facet_infos[findex].use_value_index = (group_limit == 0) && (a_facet.sort_field.empty()) &&
                                                 ( is_wildcard_no_filter_query ||
-                                                (all_result_ids_len > 1000 && num_facet_values < 250) ||
-                                                (all_result_ids_len > 1000 && all_result_ids_len * 2 > total_docs) ||
+                                                (value_index_finds_top_values &&
+                                                 facet_index_v4->is_value_index_cheaper(facet_field.name,
+                                                                                        all_result_ids, all_result_ids_len,
+                                                                                        max_facet_count, total_docs,
+                                                                                        &facet_infos[findex].cost)) ||
                                                 (a_facet.is_sort_by_alpha));
 
+        if(facet_infos[findex].use_value_index && is_wildcard_no_filter_query) {
+            // counts are read off the value index as they are
+            facet_infos[findex].cost = max_facet_count * facet_index_t::VALUE_VISIT_COST;
+        }
+
         bool facet_value_index_exists = facet_index_v4->has_value_index(facet_field.name);
 
         if(a_facet.field_name == facet_query.field_name && !facet_query.query.empty()) {
@@ -5741,7 +6128,7 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
             std::copy(all_result_ids, all_result_ids + all_result_ids_len, filter_ids);
             filter_result_iterator_t filter_result_it(filter_ids, all_result_ids_len);
             tsl::htrie_map<char, token_leaf> qtoken_set;
-            std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values{};
+            std::array<sort_column_t*, 3> field_values{};
             const std::vector<size_t> geopoint_indices;
 
             auto fuzzy_search_fields_op = fuzzy_search_fields(fq_fields, qtokens, {}, text_match_type_t::max_score, nullptr, 0,
@@ -5812,20 +6199,17 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
                             continue;
                         }
 
-                        std::vector<uint32_t> facet_hashes;
-                        auto facet_index = facet_index_v4->get_facet_hash_index(a_facet.field_name);
-                        posting_list_t::iterator_t facet_index_it = facet_index->new_iterator();
-                        facet_index_it.skip_to(seq_id);
-
-                        if(facet_index_it.valid()) {
-                            posting_list_t::get_offsets(facet_index_it, facet_hashes);
+                        const uint32_t* facet_hashes = nullptr;
+                        auto facet_column = facet_index_v4->get_facet_hash_index(a_facet.field_name);
+                        const uint32_t num_facet_hashes = facet_column->get(seq_id, facet_hashes);
 
+                        if(num_facet_hashes != 0) {
                             if(facet_field.is_array()) {
                                 std::vector<size_t> array_indices;
                                 posting_t::get_matching_array_indices(posting_lists, seq_id, array_indices);
 
                                 for(size_t array_index: array_indices) {
-                                    if(array_index < facet_hashes.size()) {
+                                    if(array_index < num_facet_hashes) {
                                         uint32_t hash = facet_hashes[array_index];
 
                                         /*LOG(INFO) << "seq_id: " << seq_id << ", hash: " << hash << ", array index: "
@@ -5890,7 +6274,7 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
                                     filter_result_iterator_t* const filter_result_iterator,
                                     const size_t concurrency,
                                     const int* sort_order,
-                                    std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values,
+                                    std::array<sort_column_t*, 3>& field_values,
                                     const std::vector<size_t>& geopoint_indices,
                                     const std::string& collection_name) const {
 
@@ -5910,10 +6294,7 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
     Topster* topsters[num_threads];
     std::vector<posting_list_t::iterator_t> plists;
 
-    size_t num_processed = 0;
     std::mutex m_process;
-    std::condition_variable cv_process;
-
     size_t num_queued = 0;
 
     const auto parent_search_begin = search_begin_us;
@@ -5922,6 +6303,8 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
     uint32_t excluded_result_index = 0;
     Option<bool>* compute_sort_score_statuses[num_threads];
 
+    ThreadPool::task_group_t search_group(thread_pool, ThreadPool::HIGH);
+
     for(size_t thread_id = 0; thread_id < num_threads &&
                                     filter_result_iterator->validity == filter_result_iterator_t::valid; thread_id++) {
         auto batch_result = new filter_result_t();
@@ -5938,14 +6321,14 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
         topsters[thread_id] = new Topster(topster->MAX_SIZE, topster->distinct);
         auto& compute_sort_score_status = compute_sort_score_statuses[thread_id] = nullptr;
 
-        thread_pool->enqueue([this, &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
-                              thread_id, &sort_fields, &searched_queries,
-                              &group_limit, &group_by_fields, group_missing_values, 
-                              &topsters, &tgroups_processed, &excluded_group_ids,
-                              &sort_order, field_values, &geopoint_indices, &plists,
-                              check_for_circuit_break,
-                              batch_result,
-                              &num_processed, &m_process, &cv_process, &compute_sort_score_status, collection_name]() {
+        search_group.run([this, &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
+                          thread_id, &sort_fields, &searched_queries,
+                          &group_limit, &group_by_fields, group_missing_values,
+                          &topsters, &tgroups_processed, &excluded_group_ids,
+                          &sort_order, field_values, &geopoint_indices, &plists,
+                          check_for_circuit_break,
+                          batch_result,
+                          &m_process, &compute_sort_score_status, collection_name]() {
             std::unique_ptr<filter_result_t> batch_result_guard(batch_result);
 
             search_begin_us = parent_search_begin;
@@ -5986,7 +6369,7 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
                 if(group_limit != 0) {
                     distinct_id = 1;
                     for(auto& kv : group_by_field_it_vec) {
-                        get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id);
+                        get_distinct_id(kv.column, seq_id, group_missing_values, distinct_id);
                     }
 
                     if(excluded_group_ids.count(distinct_id) != 0) {
@@ -6007,24 +6390,21 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
             }
 
             std::unique_lock<std::mutex> lock(m_process);
-            num_processed++;
             parent_search_cutoff = parent_search_cutoff || search_cutoff;
-            cv_process.notify_one();
         });
     }
 
-    std::unique_lock<std::mutex> lock_process(m_process);
-    cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
+    search_group.wait();
 
     search_cutoff = parent_search_cutoff || filter_result_iterator->validity == filter_result_iterator_t::timed_out;
 
-    for(size_t thread_id = 0; thread_id < num_processed; thread_id++) {
+    for(size_t thread_id = 0; thread_id < num_queued; thread_id++) {
         if (compute_sort_score_statuses[thread_id] != nullptr) {
             auto& status = compute_sort_score_statuses[thread_id];
             auto return_value = Option<bool>(status->code(), status->error());
 
             // Cleanup the remaining threads.
-            for (size_t i = thread_id; i < num_processed; i++) {
+            for (size_t i = thread_id; i < num_queued; i++) {
                 delete compute_sort_score_statuses[i];
                 delete topsters[i];
             }
@@ -6049,7 +6429,7 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
         auto partial_result = new filter_result_t();
         std::unique_ptr<filter_result_t> partial_result_guard(partial_result);
 
-        filter_result_iterator->get_n_ids(window_size * num_processed,
+        filter_result_iterator->get_n_ids(window_size * num_queued,
                                           excluded_result_index, nullptr, 0, partial_result, true);
         all_result_ids_len = partial_result->count;
         all_result_ids = partial_result->docs;
@@ -6064,7 +6444,7 @@ Option<bool> Index::search_wildcard(filter_node_t const* const& filter_tree_root
 
 void Index::populate_sort_mapping(int* sort_order, std::vector<size_t>& geopoint_indices,
                                   std::vector<sort_by>& sort_fields_std,
-                                  std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values) const {
+                                  std::array<sort_column_t*, 3>& field_values) const {
     for (size_t i = 0; i < sort_fields_std.size(); i++) {
         if (!sort_fields_std[i].reference_collection_name.empty()) {
             auto& cm = CollectionManager::get_instance();
@@ -6075,7 +6455,7 @@ void Index::populate_sort_mapping(int* sort_order, std::vector<size_t>& geopoint
             std::vector<sort_by> ref_sort_fields_std;
             ref_sort_fields_std.emplace_back(sort_fields_std[i]);
             ref_sort_fields_std.front().reference_collection_name.clear();
-            std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> ref_field_values;
+            std::array<sort_column_t*, 3> ref_field_values;
             ref_collection->reference_populate_sort_mapping(ref_sort_order, ref_geopoint_indices,
                                                             ref_sort_fields_std, ref_field_values);
 
@@ -6140,8 +6520,15 @@ void Index::populate_sort_mapping(int* sort_order, std::vector<size_t>& geopoint
 
 void Index::populate_sort_mapping_with_lock(int* sort_order, std::vector<size_t>& geopoint_indices,
                                             std::vector<sort_by>& sort_fields_std,
-                                            std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3>& field_values) const {
+                                            std::array<sort_column_t*, 3>& field_values) const {
     std::shared_lock lock(mutex);
+
+    field_locks_t::stripe_set_t stripes;
+    if(!add_sort_stripes(sort_fields_std, stripes)) {
+        stripes = field_locks_t::all_stripes();
+    }
+
+    field_locks_t::shared_lock_t field_lock(field_locks, stripes);
     populate_sort_mapping(sort_order, geopoint_indices, sort_fields_std, field_values);
 }
 
@@ -6288,13 +6675,85 @@ int64_t Index::score_results2(const std::vector<sort_by> & sort_fields, const ui
     return 0;
 }
 
+uint64_t Index::field_match_score_upper_bound(size_t num_field_tokens, size_t num_query_tokens,
+                                              int syn_orig_num_tokens, uint32_t total_cost,
+                                              uint32_t min_position, bool prioritize_exact_match,
+                                              bool single_exact_query_token, bool prioritize_token_position) {
+    // Mirrors score_results2(), but with every document dependent component replaced by its best possible value.
+    // Token positions get truncated before the offset score is computed, so the offset score is not bounded by
+    // `min_position` and is always assumed to be the best one.
+
+    if(num_field_tokens <= 1) {
+        // a verbatim single token match requires the token to be at the first position of the field
+        const uint8_t is_verbatim_match = uint8_t(prioritize_exact_match && single_exact_query_token &&
+                                                  min_position <= 1);
+        size_t words_present = (num_query_tokens == 1 && syn_orig_num_tokens != -1) ? syn_orig_num_tokens : 1;
+        size_t distance = (num_query_tokens == 1 && syn_orig_num_tokens != -1) ? syn_orig_num_tokens-1 : 0;
+        size_t max_offset = prioritize_token_position ? 0 : 255;
+        Match single_token_match = Match(words_present, distance, max_offset, is_verbatim_match);
+        return single_token_match.get_match_score(total_cost, words_present);
+    }
+
+    uint64_t words_present = num_field_tokens;
+    uint64_t unique_words = num_field_tokens;
+    uint64_t proximity = 100;
+
+    if(syn_orig_num_tokens != -1 && num_query_tokens == num_field_tokens) {
+        words_present = unique_words = syn_orig_num_tokens;
+        proximity = 100 - (syn_orig_num_tokens - 1);
+    }
+
+    return (
+        ((words_present & 0xFF) << 40) |
+        ((unique_words & 0xFF) << 32) |
+        (uint64_t(255 - total_cost) << 24) |
+        ((proximity & 0xFF) << 16) |
+        (uint64_t(prioritize_exact_match ? 1 : 0) << 8) |
+        (uint64_t(prioritize_token_position ? 255 : 0) << 0)
+    );
+}
+
+uint64_t Index::aggregate_text_match_score(text_match_type_t match_type, size_t query_len,
+                                           int64_t best_field_match_score, int64_t best_field_weight,
+                                           size_t num_matching_fields) {
+    query_len = std::min<size_t>(15, query_len);
+
+    // NOTE: `query_len` is total tokens matched across fields.
+    // Within a field, only a subset can match
+
+    // MAX_SCORE
+    // [ sign | tokens_matched | max_field_score | max_field_weight | num_matching_fields ]
+    // [   1  |        4       |        48       |       8          |         3           ]  (64 bits)
+
+    // MAX_WEIGHT
+    // [ sign | tokens_matched | max_field_weight | max_field_score  | num_matching_fields ]
+    // [   1  |        4       |        8         |      48          |         3           ]  (64 bits)
+
+    auto max_field_weight = std::min<size_t>(FIELD_MAX_WEIGHT, best_field_weight);
+    num_matching_fields = std::min<size_t>(7, num_matching_fields);
+
+    return match_type == max_score ?
+           ((int64_t(query_len) << 59) |
+            (int64_t(best_field_match_score) << 11) |
+            (int64_t(max_field_weight) << 3) |
+            (int64_t(num_matching_fields) << 0))
+
+           :
+
+           ((int64_t(query_len) << 59) |
+            (int64_t(max_field_weight) << 51) |
+            (int64_t(best_field_match_score) << 3) |
+            (int64_t(num_matching_fields) << 0))
+           ;
+}
+
 void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16_t & query_index,
                           const uint8_t & field_id, const bool field_is_array, const uint32_t total_cost,
                           Topster* topster,
                           const std::vector<art_leaf *> &query_suggestion,
                           spp::sparse_hash_map<uint64_t, uint32_t>& groups_processed,
                           const uint32_t seq_id, const int sort_order[3],
-                          std::array<spp::sparse_hash_map<uint32_t, int64_t, Hasher32>*, 3> field_values,
+                          std::array<sort_column_t*, 3> field_values,
                           const std::vector<size_t>& geopoint_indices,
                           const size_t group_limit, const std::vector<std::string>& group_by_fields,
                           const bool group_missing_values,
@@ -6314,10 +6773,8 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         GeoPoint::unpack_lat_lng(sort_fields[i].geopoint, reference_lat_lng);
 
         if(geopoints != nullptr) {
-            auto it = geopoints->find(seq_id);
-
-            if(it != geopoints->end()) {
-                int64_t packed_latlng = it->second;
+            if(geopoints->contains(seq_id)) {
+                int64_t packed_latlng = geopoints->at(seq_id);
                 S2LatLng s2_lat_lng;
                 GeoPoint::unpack_lat_lng(packed_latlng, s2_lat_lng);
                 dist = GeoPoint::distance(s2_lat_lng, reference_lat_lng);
@@ -6438,8 +6895,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         } else if(field_values[0] == &str_sentinel_value) {
             scores[0] = str_sort_index.at(sort_fields[0].name)->rank(seq_id);
         } else {
-            auto it = field_values[0]->find(seq_id);
-            scores[0] = (it == field_values[0]->end()) ? default_score : it->second;
+            scores[0] = field_values[0]->get(seq_id, default_score);
         }
 
         if (sort_order[0] == -1) {
@@ -6458,8 +6914,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         } else if(field_values[1] == &str_sentinel_value) {
             scores[1] = str_sort_index.at(sort_fields[1].name)->rank(seq_id);
         } else {
-            auto it = field_values[1]->find(seq_id);
-            scores[1] = (it == field_values[1]->end()) ? default_score : it->second;
+            scores[1] = field_values[1]->get(seq_id, default_score);
         }
 
         if (sort_order[1] == -1) {
@@ -6478,8 +6933,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         } else if(field_values[2] == &str_sentinel_value) {
             scores[2] = str_sort_index.at(sort_fields[2].name)->rank(seq_id);
         } else {
-            auto it = field_values[2]->find(seq_id);
-            scores[2] = (it == field_values[2]->end()) ? default_score : it->second;
+            scores[2] = field_values[2]->get(seq_id, default_score);
         }
 
         if (sort_order[2] == -1) {
@@ -6494,7 +6948,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         auto group_by_field_it_vec = get_group_by_field_iterators(group_by_fields);
 
         for(auto& kv : group_by_field_it_vec) {
-            get_distinct_id(kv.it, seq_id, kv.is_array, group_missing_values, distinct_id);
+            get_distinct_id(kv.column, seq_id, group_missing_values, distinct_id);
         }
     }
 
@@ -6509,41 +6963,20 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
     //LOG(INFO) << "Time taken for results iteration: " << timeNanos << "ms";
 }
 
-void Index::get_distinct_id(posting_list_t::iterator_t& facet_index_it, const uint32_t seq_id, const bool is_array,
-                            const bool group_missing_values, uint64_t& distinct_id, bool is_reverse) const {
-    if (!facet_index_it.valid()) {
-        if (!group_missing_values) {
-            distinct_id = seq_id;
-        }
-        return;
-    }
+void Index::get_distinct_id(const facet_column_t* facet_column, const uint32_t seq_id,
+                            const bool group_missing_values, uint64_t& distinct_id) const {
     // calculate hash from group_by_fields
-    if(!is_reverse) {
-        facet_index_it.skip_to(seq_id);
-    } else {
-        facet_index_it.skip_to_rev(seq_id);
-    }
+    const uint32_t* facet_hashes = nullptr;
+    const uint32_t num_facet_hashes = facet_column->get(seq_id, facet_hashes);
 
-    if (facet_index_it.valid() && facet_index_it.id() == seq_id) {
-        if (is_array) {
-            //LOG(INFO) << "combining hashes for facet array ";
-            std::vector<uint32_t> facet_hashes;
-            posting_list_t::get_offsets(facet_index_it, facet_hashes);
-            for (size_t i = 0; i < facet_hashes.size(); i++) {
-                distinct_id = StringUtils::hash_combine(distinct_id, facet_hashes[i]);
-            }
-        } else {
-            //LOG(INFO) << "combining hashes for facet ";
-            distinct_id = StringUtils::hash_combine(distinct_id, facet_index_it.offset());
-        }
+    for (uint32_t i = 0; i < num_facet_hashes; i++) {
+        distinct_id = StringUtils::hash_combine(distinct_id, facet_hashes[i]);
     }
 
     //LOG(INFO) << "seq_id: " << seq_id << ", distinct_id: " << distinct_id;
     if (distinct_id == 1 && !group_missing_values) {
         distinct_id = seq_id;
     }
-
-    return;
 }
 
 inline uint32_t Index::next_suggestion2(const std::vector<tok_candidates>& token_candidates_vec,
@@ -6728,7 +7161,7 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
     } else if(search_field.num_dim) {
         if(!is_update) {
             // since vector index supports upsert natively, we should not attempt to delete for update
-            vector_index[search_field.name]->vecdex->markDelete(seq_id);
+            vector_index[search_field.name]->mark_delete(seq_id);
         }
     } else if(search_field.is_float()) {
         const std::vector<float>& values = search_field.is_single_float() ?
@@ -6810,7 +7243,9 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
 
 Option<uint32_t> Index::remove(const uint32_t seq_id, const nlohmann::json & document,
                                const std::vector<field>& del_fields, const bool is_update) {
-    std::unique_lock lock(mutex);
+    // like the indexing of a batch, only the field being removed from is kept away from searches
+    std::unique_lock write_lock(write_mutex);
+    std::shared_lock lock(mutex);
 
     // The exception during removal is mostly because of an edge case with auto schema detection:
     // Value indexed as Type T but later if field is dropped and reindexed in another type X,
@@ -6824,6 +7259,8 @@ Option<uint32_t> Index::remove(const uint32_t seq_id, const nlohmann::json & doc
                 continue;
             }
 
+            auto field_lock = field_locks.lock_field(the_field.name);
+
             try {
                 remove_field(seq_id, document, the_field.name, is_update);
             } catch(const std::exception& e) {
@@ -6834,6 +7271,8 @@ Option<uint32_t> Index::remove(const uint32_t seq_id, const nlohmann::json & doc
     } else {
         for(auto it = document.begin(); it != document.end(); ++it) {
             const std::string& field_name = it.key();
+            auto field_lock = field_locks.lock_field(field_name);
+
             try {
                 remove_field(seq_id, document, field_name, is_update);
             } catch(const std::exception& e) {
@@ -6844,7 +7283,16 @@ Option<uint32_t> Index::remove(const uint32_t seq_id, const nlohmann::json & doc
     }
 
     if(!is_update) {
+        auto id_lock = field_locks.lock_field("id");
         seq_ids->erase(seq_id);
+        filter_cache.remove_id(seq_id);
+    } else {
+        std::unordered_set<std::string> written_fields;
+        for(auto it = document.begin(); it != document.end(); ++it) {
+            written_fields.insert(it.key());
+        }
+
+        filter_cache.invalidate(written_fields, false);
     }
 
     return Option<uint32_t>(seq_id);
@@ -6869,6 +7317,7 @@ void Index::tokenize_string_field(const nlohmann::json& document, const field& s
 
 art_leaf* Index::get_token_leaf(const std::string & field_name, const unsigned char* token, uint32_t token_len) {
     std::shared_lock lock(mutex);
+    field_locks_t::shared_lock_t field_lock(field_locks, field_locks_t::stripes_of(field_name));
     const art_tree *t = search_index.at(field_name);
     return (art_leaf*) art_search(t, token, (int) token_len);
 }
@@ -6881,6 +7330,10 @@ const spp::sparse_hash_map<std::string, num_tree_t*>& Index::_get_numerical_inde
     return numerical_index;
 }
 
+const filter_result_cache_t& Index::_get_filter_cache() const {
+    return filter_cache;
+}
+
 const spp::sparse_hash_map<std::string, NumericTrie*>& Index::_get_range_index() const {
     return range_index;
 }
@@ -6908,14 +7361,15 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         search_schema.emplace(new_field.name, new_field);
 
         if(new_field.type == field_types::FLOAT_ARRAY && new_field.num_dim > 0) {
-            auto hnsw_index = new hnsw_index_t(new_field.num_dim, 1024, new_field.vec_dist, new_field.hnsw_params["M"].get<uint32_t>(), new_field.hnsw_params["ef_construction"].get<uint32_t>());
+            auto hnsw_index = new hnsw_index_t(new_field.num_dim, 1024, new_field.vec_dist, new_field.hnsw_params["M"].get<uint32_t>(), new_field.hnsw_params["ef_construction"].get<uint32_t>(),
+                                               hnsw_index_t::is_int8_quantized(new_field.hnsw_params));
             vector_index.emplace(new_field.name, hnsw_index);
             continue;
         }
 
         if(new_field.is_sortable()) {
             if(new_field.is_num_sortable()) {
-                auto doc_to_score = new spp::sparse_hash_map<uint32_t, int64_t, Hasher32>();
+                auto doc_to_score = new sort_column_t(get_sort_column_width(new_field));
                 sort_index.emplace(new_field.name, doc_to_score);
             } else if(new_field.is_str_sortable()) {
                 str_sort_index.emplace(new_field.name, new adi_tree_t);
@@ -6960,7 +7414,7 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         if(new_field.infix) {
             array_mapped_infix_t infix_sets(ARRAY_INFIX_DIM);
             for(auto& infix_set: infix_sets) {
-                infix_set = new tsl::htrie_set<char>();
+                infix_set = new trigram_index_t();
             }
 
             infix_index.emplace(new_field.name, infix_sets);
@@ -7040,6 +7494,9 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
             vector_index.erase(del_field.name);
         }
     }
+
+    // cached filter results could refer to fields that no longer exist or now have a different type
+    filter_cache.clear();
 }
 
 void Index::handle_doc_ops(const tsl::htrie_map<char, field>& search_schema,
@@ -7144,12 +7601,14 @@ void Index::get_doc_changes(const index_operation_t op, const tsl::htrie_map<cha
 
 size_t Index::num_seq_ids() const {
     std::shared_lock lock(mutex);
+    field_locks_t::shared_lock_t field_lock(field_locks, field_locks_t::stripes_of("id"));
     return seq_ids->num_ids();
 }
 
 Option<bool> Index::seq_ids_outside_top_k(const std::string& field_name, size_t k,
                                           std::vector<uint32_t>& outside_seq_ids) {
     std::shared_lock lock(mutex);
+    field_locks_t::shared_lock_t field_lock(field_locks, field_locks_t::stripes_of(field_name));
     auto field_it = numerical_index.find(field_name);
     if(field_it != numerical_index.end()) {
         field_it->second->seq_ids_outside_top_k(k, outside_seq_ids);
@@ -7464,14 +7923,68 @@ void Index::repair_hnsw_index() {
     }
 }
 
+Option<bool> Index::save_vector_index(const std::string& field_name, const std::string& file_path,
+                                      size_t& max_elements) const {
+    std::shared_lock lock(mutex);
+    field_locks_t::shared_lock_t field_lock(field_locks, field_locks_t::stripes_of(field_name));
+
+    auto vector_index_it = vector_index.find(field_name);
+    if(vector_index_it == vector_index.end()) {
+        return Option<bool>(404, "Vector index for field `" + field_name + "` not found.");
+    }
+
+    const size_t num_elements = vector_index_it->second->vecdex->getCurrentElementCount();
+    if(num_elements > max_elements) {
+        return Option<bool>(false);
+    }
+
+    max_elements -= num_elements;
+
+    try {
+        vector_index_it->second->save(file_path);
+    } catch(const std::exception& e) {
+        return Option<bool>(500, "Error while saving vector index of field `" + field_name + "`: " + e.what());
+    }
+
+    return Option<bool>(true);
+}
+
+Option<bool> Index::load_vector_index(const std::string& field_name, const std::string& file_path,
+                                      uint32_t seq_id_watermark) {
+    std::unique_lock lock(mutex);
+
+    auto vector_index_it = vector_index.find(field_name);
+    if(vector_index_it == vector_index.end()) {
+        return Option<bool>(404, "Vector index for field `" + field_name + "` not found.");
+    }
+
+    try {
+        vector_index_it->second->load(file_path, seq_id_watermark);
+    } catch(const std::exception& e) {
+        return Option<bool>(500, "Error while loading vector index of field `" + field_name + "`: " + e.what());
+    }
+
+    return Option<bool>(true);
+}
+
+void Index::clear_restored_vector_watermarks() {
+    std::unique_lock lock(mutex);
+
+    for(auto& vec_kv: vector_index) {
+        vec_kv.second->restored_seq_id_watermark = 0;
+    }
+}
+
 int64_t Index::reference_string_sort_score(const string &field_name, const uint32_t &seq_id) const {
     std::shared_lock lock(mutex);
+    field_locks_t::shared_lock_t field_lock(field_locks, field_locks_t::stripes_of(field_name));
     return str_sort_index.at(field_name)->rank(seq_id);
 }
 
 Option<bool> Index::get_related_ids(const std::string& collection_name, const string& field_name,
                                     const uint32_t& seq_id, std::vector<uint32_t>& result) const {
     std::shared_lock lock(mutex);
+    field_locks_t::shared_lock_t field_lock(field_locks, field_locks_t::stripes_of(field_name));
     if (search_schema.count(field_name) == 0) {
         return Option<bool>(400, "Could not find `" + field_name + "` in the collection `" + collection_name + "`.");
     }
@@ -7510,6 +8023,7 @@ Option<bool> Index::get_object_array_related_id(const std::string& collection_na
                                                 const uint32_t& seq_id, const uint32_t& object_index,
                                                 uint32_t& result) const {
     std::shared_lock lock(mutex);
+    field_locks_t::shared_lock_t field_lock(field_locks, field_locks_t::stripes_of(field_name));
     if (object_array_reference_index.count(field_name) == 0 || object_array_reference_index.at(field_name) == nullptr) {
         return Option<bool>(404, "`" + field_name + "` not found in `" + collection_name +
                                     ".object_array_reference_index`");
@@ -7526,6 +8040,7 @@ Option<uint32_t> Index::get_sort_index_value_with_lock(const std::string& collec
                                                        const std::string& field_name,
                                                        const uint32_t& seq_id) const {
     std::shared_lock lock(mutex);
+    field_locks_t::shared_lock_t field_lock(field_locks, field_locks_t::stripes_of(field_name));
     if (search_schema.count(field_name) == 0) {
         return Option<uint32_t>(400, "Could not find `" + field_name + "` in the collection `" + collection_name + "`.");
     } else if (search_schema.at(field_name).is_array()) {
@@ -0,0 +1,144 @@
+#include "inference_batcher.h"
+#include <algorithm>
+#include <chrono>
+
+inference_batcher_t::inference_batcher_t(run_batch_t run_batch, size_t max_parallel_batches):
+        run_batch(std::move(run_batch)), max_parallel_batches(std::max<size_t>(1, max_parallel_batches)) {
+
+}
+
+std::vector<embedding_res_t> inference_batcher_t::infer(std::vector<encoded_input_t>&& encoded_inputs) {
+    std::vector<inference_t> inferences(encoded_inputs.size());
+
+    for(size_t i = 0; i < encoded_inputs.size(); i++) {
+        inferences[i].encoded_input = std::move(encoded_inputs[i]);
+    }
+
+    size_t num_pending = inferences.size();
+    const uint64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for(auto& inference: inferences) {
+        inference.enqueued_us = now_us;
+        inference.num_pending = &num_pending;
+        pending_inferences.push_back(&inference);
+    }
+
+    while(num_pending != 0) {
+        if(pending_inferences.empty() || num_running_batches >= max_parallel_batches) {
+            cv.wait(lock);
+            continue;
+        }
+
+        // the batch can include the inputs of other callers, which are waiting for this thread to run it
+        std::vector<inference_t*> batch = take_batch();
+        num_running_batches++;
+        lock.unlock();
+
+        const uint64_t start_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        for(auto inference: batch) {
+            queue_wait_us += (start_us - inference->enqueued_us);
+        }
+
+        num_batches++;
+        num_inputs += batch.size();
+
+        run_batch(batch);
+
+        run_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count() - start_us;
+
+        lock.lock();
+        num_running_batches--;
+
+        for(auto inference: batch) {
+            (*inference->num_pending)--;
+        }
+
+        cv.notify_all();
+    }
+
+    lock.unlock();
+
+    std::vector<embedding_res_t> outputs;
+    outputs.reserve(inferences.size());
+
+    for(auto& inference: inferences) {
+        outputs.push_back(std::move(inference.result));
+    }
+
+    return outputs;
+}
+
+std::vector<inference_batcher_t::inference_t*> inference_batcher_t::take_batch() {
+    // The oldest input is always taken, so that no input is left waiting behind newer ones. It is joined by the
+    // inputs closest to it in length, so that little of the batch is padding.
+    inference_t* oldest = pending_inferences.front();
+
+    std::vector<inference_t*> by_length(pending_inferences.begin(), pending_inferences.end());
+    std::stable_sort(by_length.begin(), by_length.end(), [](const inference_t* a, const inference_t* b) {
+        return a->encoded_input.input_ids.size() < b->encoded_input.input_ids.size();
+    });
+
+    auto input_len = [](const inference_t* inference) {
+        return std::max<size_t>(1, inference->encoded_input.input_ids.size());
+    };
+
+    size_t begin = std::find(by_length.begin(), by_length.end(), oldest) - by_length.begin();
+    size_t end = begin + 1;
+    size_t max_len = input_len(oldest);
+
+    while(end - begin < MAX_BATCH_SIZE) {
+        // a shorter input only adds its own padding, a longer one pads every input already in the batch
+        const size_t batch_len = end - begin + 1;
+        bool can_take_shorter = (begin > 0 && batch_len * max_len <= MAX_BATCH_TOKENS);
+        bool can_take_longer = (end < by_length.size() &&
+                                batch_len * std::max(max_len, input_len(by_length[end])) <= MAX_BATCH_TOKENS);
+
+        if(can_take_shorter && can_take_longer) {
+            size_t shorter_padding = max_len - input_len(by_length[begin - 1]);
+            size_t longer_padding = (input_len(by_length[end]) - max_len) * (end - begin);
+            can_take_shorter = (shorter_padding <= longer_padding);
+            can_take_longer = !can_take_shorter;
+        }
+
+        if(can_take_shorter) {
+            begin--;
+        } else if(can_take_longer) {
+            max_len = std::max(max_len, input_len(by_length[end]));
+            end++;
+        } else {
+            break;
+        }
+    }
+
+    std::vector<inference_t*> batch(by_length.begin() + begin, by_length.begin() + end);
+
+    for(auto inference: batch) {
+        inference->in_batch = true;
+    }
+
+    pending_inferences.erase(std::remove_if(pending_inferences.begin(), pending_inferences.end(),
+                                            [](const inference_t* inference) { return inference->in_batch; }),
+                             pending_inferences.end());
+
+    return batch;
+}
+
+nlohmann::json inference_batcher_t::get_stats() const {
+    nlohmann::json stats;
+    const uint64_t batches = num_batches;
+    const uint64_t inputs = num_inputs;
+
+    stats["num_batches"] = batches;
+    stats["num_inputs"] = inputs;
+    stats["avg_batch_size"] = (batches == 0) ? 0.0 : double(inputs) / batches;
+    stats["avg_queue_wait_ms"] = (inputs == 0) ? 0.0 : double(queue_wait_us) / inputs / 1000;
+    stats["avg_run_ms"] = (batches == 0) ? 0.0 : double(run_us) / batches / 1000;
+
+    return stats;
+}
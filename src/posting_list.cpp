@@ -7,6 +7,13 @@
 /* block_t operations */
 
 uint32_t posting_list_t::block_t::upsert(const uint32_t id, const std::vector<uint32_t>& positions) {
+    for(uint32_t position : positions) {
+        // zero is used as a marker for the last token of a field and is never a position
+        if(position != 0 && position < min_position) {
+            min_position = position;
+        }
+    }
+
     if(id > ids.last() || ids.getLength() == 0) {
         // append to the end
         ids.append(id);
@@ -232,6 +239,8 @@ posting_list_t::~posting_list_t() {
 
 void posting_list_t::merge_adjacent_blocks(posting_list_t::block_t* block1, posting_list_t::block_t* block2,
                                            size_t num_block2_ids_to_move) {
+    block1->min_position = std::min(block1->min_position, block2->min_position);
+
     // merge ids
     uint32_t* ids1 = block1->ids.uncompress();
     uint32_t* ids2 = block2->ids.uncompress();
@@ -378,6 +387,8 @@ void posting_list_t::split_block(posting_list_t::block_t* src_block, posting_lis
         return;
     }
 
+    dst_block->min_position = src_block->min_position;
+
     uint32_t* raw_ids = src_block->ids.uncompress();
     size_t ids_first_half_length = (src_block->size() / 2);
     size_t ids_second_half_length = (src_block->size() - ids_first_half_length);
@@ -1728,10 +1739,7 @@ posting_list_t::block_t* posting_list_t::iterator_t::block() const {
 void posting_list_t::iterator_t::skip_to(uint32_t id) {
     // first look to skip within current block
     if(id <= this->last_block_id()) {
-        while(curr_index < curr_block->size() && this->id() < id) {
-            curr_index++;
-        }
-
+        curr_index = ArrayUtils::lower_bound_from(ids, curr_block->size(), curr_index, id);
         return ;
     }
 
@@ -1749,9 +1757,7 @@ void posting_list_t::iterator_t::skip_to(uint32_t id) {
     offset_index = curr_block->offset_index.uncompress();
     offsets = curr_block->offsets.uncompress();
 
-    while(curr_index < curr_block->size() && this->id() < id) {
-        curr_index++;
-    }
+    curr_index = ArrayUtils::lower_bound_from(ids, curr_block->size(), 0, id);
 
     if(curr_index == curr_block->size()) {
         reset_cache();
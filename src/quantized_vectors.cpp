@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "quantized_vectors.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define QUANTIZED_VECTORS_SIMD
+#define QUANTIZED_VECTORS_AVX2
+#elif defined(__aarch64__)
+#include <sse2neon.h>
+#define QUANTIZED_VECTORS_SIMD
+#endif
+
+static constexpr float INT8_MAX_CODE = 127.0f;
+
+static int32_t dot_product_scalar(const int8_t* a, const int8_t* b, size_t num_dim) {
+    int32_t sum = 0;
+    for(size_t i = 0; i < num_dim; i++) {
+        sum += int32_t(a[i]) * int32_t(b[i]);
+    }
+
+    return sum;
+}
+
+#ifdef QUANTIZED_VECTORS_SIMD
+static int32_t dot_product_sse2(const int8_t* a, const int8_t* b, size_t num_dim) {
+    __m128i sum = _mm_setzero_si128();
+    size_t i = 0;
+
+    for(; i + 16 <= num_dim; i += 16) {
+        const __m128i va = _mm_loadu_si128((const __m128i*) (a + i));
+        const __m128i vb = _mm_loadu_si128((const __m128i*) (b + i));
+
+        // interleaving a byte with itself and shifting right sign extends it to 16 bits
+        const __m128i va_lo = _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+        const __m128i va_hi = _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+        const __m128i vb_lo = _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8);
+        const __m128i vb_hi = _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8);
+
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(va_lo, vb_lo));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(va_hi, vb_hi));
+    }
+
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*) lanes, sum);
+
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + dot_product_scalar(a + i, b + i, num_dim - i);
+}
+#endif
+
+#ifdef QUANTIZED_VECTORS_AVX2
+__attribute__((target("avx2")))
+static int32_t dot_product_avx2(const int8_t* a, const int8_t* b, size_t num_dim) {
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for(; i + 16 <= num_dim; i += 16) {
+        const __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*) (a + i)));
+        const __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*) (b + i)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(va, vb));
+    }
+
+    __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_cvtsi128_si32(sum128) + dot_product_scalar(a + i, b + i, num_dim - i);
+}
+#endif
+
+typedef int32_t (*dot_product_fn_t)(const int8_t*, const int8_t*, size_t);
+
+static dot_product_fn_t resolve_dot_product() {
+#if defined(QUANTIZED_VECTORS_AVX2)
+    if(__builtin_cpu_supports("avx2")) {
+        return dot_product_avx2;
+    }
+#endif
+
+#if defined(QUANTIZED_VECTORS_SIMD)
+    return dot_product_sse2;
+#else
+    return dot_product_scalar;
+#endif
+}
+
+static const dot_product_fn_t dot_product_impl = resolve_dot_product();
+
+static float int8_inner_product_distance(const void* a, const void* b, const void* dist_func_param) {
+    const size_t num_dim = *((const size_t*) dist_func_param);
+
+    float scale_a, scale_b;
+    std::memcpy(&scale_a, a, sizeof(float));
+    std::memcpy(&scale_b, b, sizeof(float));
+
+    const int8_t* codes_a = (const int8_t*) a + sizeof(float);
+    const int8_t* codes_b = (const int8_t*) b + sizeof(float);
+
+    return 1.0f - scale_a * scale_b * float(dot_product_impl(codes_a, codes_b, num_dim));
+}
+
+Int8InnerProductSpace::Int8InnerProductSpace(size_t num_dim): num_dim(num_dim), data_size(sizeof(float) + num_dim) {
+
+}
+
+size_t Int8InnerProductSpace::get_data_size() {
+    return data_size;
+}
+
+hnswlib::DISTFUNC<float> Int8InnerProductSpace::get_dist_func() {
+    return int8_inner_product_distance;
+}
+
+void* Int8InnerProductSpace::get_dist_func_param() {
+    return &num_dim;
+}
+
+void Int8InnerProductSpace::quantize(const float* values, size_t num_dim, void* dest) {
+    // symmetric, per vector scale: the largest magnitude maps to 127
+    float max_abs = 0.0f;
+    for(size_t i = 0; i < num_dim; i++) {
+        max_abs = std::max(max_abs, std::fabs(values[i]));
+    }
+
+    const float scale = max_abs / INT8_MAX_CODE;
+    const float inv_scale = (scale == 0.0f) ? 0.0f : 1.0f / scale;
+
+    std::memcpy(dest, &scale, sizeof(float));
+    int8_t* codes = (int8_t*) dest + sizeof(float);
+
+    for(size_t i = 0; i < num_dim; i++) {
+        const float code = std::round(values[i] * inv_scale);
+        codes[i] = int8_t(std::max(-INT8_MAX_CODE, std::min(INT8_MAX_CODE, code)));
+    }
+}
+
+int32_t Int8InnerProductSpace::dot_product(const int8_t* a, const int8_t* b, size_t num_dim) {
+    return dot_product_impl(a, b, num_dim);
+}
+
+half_vector_store_t::half_vector_store_t(size_t num_dim): num_dim(num_dim) {
+
+}
+
+void half_vector_store_t::upsert(uint32_t seq_id, const float* vals) {
+    std::unique_lock lock(mutex);
+
+    uint32_t slot;
+    auto slot_it = seq_id_slots.find(seq_id);
+
+    if(slot_it != seq_id_slots.end()) {
+        slot = slot_it->second;
+    } else if(!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+        seq_id_slots.emplace(seq_id, slot);
+    } else {
+        slot = values.size() / num_dim;
+        values.resize(values.size() + num_dim);
+        seq_id_slots.emplace(seq_id, slot);
+    }
+
+    uint16_t* slot_values = values.data() + size_t(slot) * num_dim;
+    for(size_t i = 0; i < num_dim; i++) {
+        slot_values[i] = float_to_half(vals[i]);
+    }
+}
+
+void half_vector_store_t::erase(uint32_t seq_id) {
+    std::unique_lock lock(mutex);
+
+    auto slot_it = seq_id_slots.find(seq_id);
+    if(slot_it == seq_id_slots.end()) {
+        return ;
+    }
+
+    free_slots.push_back(slot_it->second);
+    seq_id_slots.erase(slot_it);
+}
+
+bool half_vector_store_t::get(uint32_t seq_id, std::vector<float>& vals) const {
+    std::shared_lock lock(mutex);
+
+    auto slot_it = seq_id_slots.find(seq_id);
+    if(slot_it == seq_id_slots.end()) {
+        return false;
+    }
+
+    const uint16_t* slot_values = values.data() + size_t(slot_it->second) * num_dim;
+    vals.resize(num_dim);
+
+    for(size_t i = 0; i < num_dim; i++) {
+        vals[i] = half_to_float(slot_values[i]);
+    }
+
+    return true;
+}
+
+size_t half_vector_store_t::size() const {
+    std::shared_lock lock(mutex);
+    return seq_id_slots.size();
+}
+
+void half_vector_store_t::save(const std::string& file_path) const {
+    std::shared_lock lock(mutex);
+
+    std::ofstream output(file_path, std::ios::binary | std::ios::trunc);
+    if(!output) {
+        throw std::runtime_error("Could not open " + file_path + " for writing.");
+    }
+
+    const uint64_t header[2] = {num_dim, seq_id_slots.size()};
+    output.write((const char*) header, sizeof(header));
+
+    for(const auto& kv: seq_id_slots) {
+        output.write((const char*) &kv.first, sizeof(uint32_t));
+        output.write((const char*) (values.data() + size_t(kv.second) * num_dim), num_dim * sizeof(uint16_t));
+    }
+
+    if(!output.flush()) {
+        throw std::runtime_error("Could not write " + file_path + ".");
+    }
+}
+
+void half_vector_store_t::load(const std::string& file_path) {
+    std::ifstream input(file_path, std::ios::binary);
+    if(!input) {
+        throw std::runtime_error("Could not open " + file_path + ".");
+    }
+
+    uint64_t header[2];
+    if(!input.read((char*) header, sizeof(header)) || header[0] != num_dim) {
+        throw std::runtime_error("Invalid vector file " + file_path + ".");
+    }
+
+    std::vector<uint16_t> loaded_values;
+    spp::sparse_hash_map<uint32_t, uint32_t> loaded_slots;
+
+    for(uint64_t slot = 0; slot < header[1]; slot++) {
+        uint32_t seq_id;
+        loaded_values.resize(loaded_values.size() + num_dim);
+
+        if(!input.read((char*) &seq_id, sizeof(uint32_t)) ||
+           !input.read((char*) (loaded_values.data() + slot * num_dim), num_dim * sizeof(uint16_t))) {
+            throw std::runtime_error("Truncated vector file " + file_path + ".");
+        }
+
+        loaded_slots.emplace(seq_id, slot);
+    }
+
+    std::unique_lock lock(mutex);
+    values = std::move(loaded_values);
+    seq_id_slots = std::move(loaded_slots);
+    free_slots.clear();
+}
+
+uint16_t half_vector_store_t::float_to_half(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(float));
+
+    const uint16_t sign = (bits >> 16) & 0x8000;
+    const uint32_t magnitude = bits & 0x7fffffff;
+
+    if(magnitude >= 0x47800000) {
+        // beyond the half range (65536 and up), infinity or NaN
+        return sign | (magnitude > 0x7f800000 ? 0x7e00 : 0x7c00);
+    }
+
+    if(magnitude < 0x38800000) {
+        // below the smallest normal half (2^-14): subnormal, in units of 2^-24
+        float abs_value;
+        std::memcpy(&abs_value, &magnitude, sizeof(float));
+        return sign | uint16_t(std::nearbyint(abs_value * 16777216.0f));
+    }
+
+    // rebias the exponent and round the mantissa from 23 to 10 bits, to nearest even: a carry out of the mantissa
+    // correctly bumps the exponent
+    uint32_t half = (magnitude - 0x38000000) >> 13;
+    const uint32_t remainder = magnitude & 0x1fff;
+
+    if(remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        half++;
+    }
+
+    return sign | uint16_t(half);
+}
+
+float half_vector_store_t::half_to_float(uint16_t value) {
+    const uint32_t sign = uint32_t(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1f;
+    const uint32_t mantissa = value & 0x3ff;
+
+    uint32_t bits;
+
+    if(exponent == 0) {
+        const float abs_value = float(mantissa) / 16777216.0f;
+        std::memcpy(&bits, &abs_value, sizeof(float));
+        bits |= sign;
+    } else if(exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(float));
+    return result;
+}
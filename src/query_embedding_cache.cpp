@@ -0,0 +1,148 @@
+#include <cctype>
+#include "query_embedding_cache.h"
+
+query_embedding_cache_t::query_embedding_cache_t(size_t max_bytes): max_bytes(max_bytes) {
+
+}
+
+std::string query_embedding_cache_t::normalize_query(const std::string& query) {
+    std::string normalized;
+    normalized.reserve(query.size());
+
+    for(const char c: query) {
+        if(std::isspace(static_cast<unsigned char>(c))) {
+            if(!normalized.empty() && normalized.back() != ' ') {
+                normalized += ' ';
+            }
+        } else {
+            normalized += c;
+        }
+    }
+
+    if(!normalized.empty() && normalized.back() == ' ') {
+        normalized.pop_back();
+    }
+
+    return normalized;
+}
+
+std::string query_embedding_cache_t::get_key(const std::string& model_key, const std::string& query) {
+    // model key is length prefixed so that it cannot run into the query
+    return std::to_string(model_key.size()) + ":" + model_key + query;
+}
+
+size_t query_embedding_cache_t::get_entry_bytes(const std::string& key, const entry_t& entry) {
+    // key is held by both the map and the LRU list
+    return 2 * key.size() + entry.model_key.size() + entry.embedding.size() * sizeof(float) + sizeof(entry_t);
+}
+
+bool query_embedding_cache_t::find(const std::string& model_key, const std::string& query,
+                                   std::vector<float>& embedding) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if(max_bytes == 0) {
+        return false;
+    }
+
+    auto it = entries.find(get_key(model_key, query));
+    if(it == entries.end()) {
+        num_misses++;
+        return false;
+    }
+
+    lru.splice(lru.begin(), lru, it->second.lru_it);
+    embedding = it->second.embedding;
+    num_hits++;
+
+    return true;
+}
+
+void query_embedding_cache_t::insert(const std::string& model_key, const std::string& query,
+                                     const std::vector<float>& embedding) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if(max_bytes == 0) {
+        return ;
+    }
+
+    const std::string key = get_key(model_key, query);
+
+    auto it = entries.find(key);
+    if(it != entries.end()) {
+        erase(it);
+    }
+
+    entry_t entry;
+    entry.model_key = model_key;
+    entry.embedding = embedding;
+
+    const size_t entry_bytes = get_entry_bytes(key, entry);
+    if(entry_bytes > max_bytes) {
+        return ;
+    }
+
+    lru.push_front(key);
+    entry.lru_it = lru.begin();
+    entries.emplace(key, std::move(entry));
+    num_bytes += entry_bytes;
+
+    evict();
+}
+
+void query_embedding_cache_t::erase(std::unordered_map<std::string, entry_t>::iterator it) {
+    num_bytes -= get_entry_bytes(it->first, it->second);
+    lru.erase(it->second.lru_it);
+    entries.erase(it);
+}
+
+void query_embedding_cache_t::evict() {
+    while(num_bytes > max_bytes && !lru.empty()) {
+        erase(entries.find(lru.back()));
+        num_evictions++;
+    }
+}
+
+void query_embedding_cache_t::erase_model(const std::string& model_key) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for(auto it = entries.begin(); it != entries.end();) {
+        if(it->second.model_key == model_key) {
+            auto erase_it = it++;
+            erase(erase_it);
+        } else {
+            it++;
+        }
+    }
+}
+
+void query_embedding_cache_t::set_max_bytes(size_t max_bytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    this->max_bytes = max_bytes;
+    evict();
+}
+
+void query_embedding_cache_t::clear() {
+    std::unique_lock<std::mutex> lock(mutex);
+    entries.clear();
+    lru.clear();
+    num_bytes = 0;
+}
+
+size_t query_embedding_cache_t::size() const {
+    std::unique_lock<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+nlohmann::json query_embedding_cache_t::get_stats() const {
+    std::unique_lock<std::mutex> lock(mutex);
+    nlohmann::json stats;
+
+    stats["num_entries"] = entries.size();
+    stats["num_bytes"] = num_bytes;
+    stats["max_bytes"] = max_bytes;
+    stats["num_hits"] = num_hits.load();
+    stats["num_misses"] = num_misses.load();
+    stats["num_evictions"] = num_evictions.load();
+
+    return stats;
+}
@@ -507,6 +507,20 @@ void* ReplicationState::save_snapshot(void* arg) {
         }
     }
 
+    if(!sa->vector_index_snapshot_path.empty()) {
+        // add persisted vector index files to writer state
+        butil::FileEnumerator vector_index_dir_enum(butil::FilePath(sa->vector_index_snapshot_path), false,
+                                                    butil::FileEnumerator::FILES);
+        for (butil::FilePath file = vector_index_dir_enum.Next(); !file.empty(); file = vector_index_dir_enum.Next()) {
+            auto file_name = std::string(vector_index_snapshot_name) + "/" + file.BaseName().value();
+            if (sa->writer->add_file(file_name) != 0) {
+                sa->done->status().set_error(EIO, "Fail to add vector index file to writer.");
+                sa->replication_state->snapshot_in_progress = false;
+                return nullptr;
+            }
+        }
+    }
+
     const std::string& temp_snapshot_dir = sa->writer->get_path();
 
     sa->done->Run();
@@ -555,6 +569,7 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
     snapshot_in_progress = true;
     std::string db_snapshot_path = writer->get_path() + "/" + db_snapshot_name;
     std::string analytics_db_snapshot_path = writer->get_path() + "/" + analytics_db_snapshot_name;
+    std::string vector_index_snapshot_path;
 
     {
         // grab batch indexer lock so that we can take a clean snapshot
@@ -589,6 +604,23 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
                 done->status().set_error(EIO, "AnalyticsStore : Checkpoint creation failure.");
             }
         }
+
+        if(Config::get_instance().get_enable_vector_index_snapshot()) {
+            // graphs must be saved while writes are paused so that they stay consistent with the db checkpoint:
+            // the number of vectors written is capped so that the pause stays bounded
+            vector_index_snapshot_path = writer->get_path() + "/" + vector_index_snapshot_name;
+            butil::CreateDirectory(butil::FilePath(vector_index_snapshot_path), true);
+
+            auto save_op = CollectionManager::get_instance().save_vector_indices(
+                vector_index_snapshot_path, Config::get_instance().get_vector_index_snapshot_max_elements()
+            );
+            if(!save_op.ok()) {
+                // not fatal: vector indices will be rebuilt from the stored documents on load
+                LOG(ERROR) << "Failure during vector index snapshot, msg: " << save_op.error();
+                butil::DeleteFile(butil::FilePath(vector_index_snapshot_path), true);
+                vector_index_snapshot_path.clear();
+            }
+        }
     }
 
     SnapshotArg* arg = new SnapshotArg;
@@ -602,6 +634,8 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
         arg->analytics_db_snapshot_path = analytics_db_snapshot_path;
     }
 
+    arg->vector_index_snapshot_path = vector_index_snapshot_path;
+
     if(!ext_snapshot_path.empty()) {
         arg->ext_snapshot_path = ext_snapshot_path;
         ext_snapshot_path = "";
@@ -612,11 +646,11 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
     bthread_start_urgent(&tid, NULL, save_snapshot, arg);
 }
 
-int ReplicationState::init_db() {
+int ReplicationState::init_db(const std::string& vector_index_snapshot_path) {
     LOG(INFO) << "Loading collections from disk...";
 
     Option<bool> init_op = CollectionManager::get_instance().load(
-        num_collections_parallel_load, num_documents_parallel_load
+        num_collections_parallel_load, num_documents_parallel_load, vector_index_snapshot_path
     );
 
     if(init_op.ok()) {
@@ -670,7 +704,9 @@ int ReplicationState::on_snapshot_load(braft::SnapshotReader* reader) {
         return reload_store;
     }
 
-    bool init_db_status = init_db();
+    // vector graphs persisted along with this snapshot are restored instead of being rebuilt
+    const std::string vector_index_snapshot_path = reader->get_path() + "/" + vector_index_snapshot_name;
+    bool init_db_status = init_db(vector_index_snapshot_path);
 
     return init_db_status;
 }
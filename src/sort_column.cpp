@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "sort_column.h"
+
+sort_column_t::sort_column_t(uint8_t width): width(width == WIDTH_8 || width == WIDTH_32 ? width : WIDTH_64) {
+
+}
+
+sort_column_t::~sort_column_t() {
+    free(values);
+    free(present);
+}
+
+void sort_column_t::grow(uint32_t seq_id) {
+    // grow geometrically so that sequential inserts are amortized, while keeping the bitmap word aligned
+    uint64_t new_capacity = capacity < MIN_CAPACITY ? MIN_CAPACITY : (capacity + (capacity >> 1));
+    if(new_capacity <= seq_id) {
+        new_capacity = uint64_t(seq_id) + 1;
+    }
+
+    new_capacity = ((new_capacity + 63) / 64) * 64;
+
+    // each pointer is taken over as soon as it is reallocated, so that a failure of the other one does not leave it
+    // dangling: the column stays usable at its old capacity
+    auto new_values = (uint8_t*) realloc(values, new_capacity * width);
+    if(new_values == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    values = new_values;
+
+    auto new_present = (uint64_t*) realloc(present, (new_capacity / 64) * sizeof(uint64_t));
+    if(new_present == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    present = new_present;
+
+    memset(values + (capacity * width), 0, (new_capacity - capacity) * width);
+    memset(present + (capacity / 64), 0, ((new_capacity - capacity) / 64) * sizeof(uint64_t));
+
+    capacity = new_capacity;
+}
+
+bool sort_column_t::emplace(uint32_t seq_id, int64_t value) {
+    if(seq_id >= capacity) {
+        grow(seq_id);
+    } else if(contains(seq_id)) {
+        return false;
+    }
+
+    switch(width) {
+        case WIDTH_8:
+            reinterpret_cast<int8_t*>(values)[seq_id] = (int8_t) value;
+            break;
+        case WIDTH_32:
+            reinterpret_cast<int32_t*>(values)[seq_id] = (int32_t) value;
+            break;
+        default:
+            reinterpret_cast<int64_t*>(values)[seq_id] = value;
+    }
+
+    present[seq_id >> 6] |= (1ULL << (seq_id & 63));
+    num_values++;
+    return true;
+}
+
+void sort_column_t::erase(uint32_t seq_id) {
+    if(!contains(seq_id)) {
+        return ;
+    }
+
+    present[seq_id >> 6] &= ~(1ULL << (seq_id & 63));
+    num_values--;
+}
+
+void sort_column_t::gather(const uint32_t* seq_ids, size_t num_seq_ids, std::vector<int64_t>& out) const {
+    out.reserve(out.size() + std::min<size_t>(num_seq_ids, num_values));
+
+    // dispatch on the width once instead of per value
+    switch(width) {
+        case WIDTH_8:
+            for(size_t i = 0; i < num_seq_ids; i++) {
+                if(contains(seq_ids[i])) {
+                    out.push_back(reinterpret_cast<const int8_t*>(values)[seq_ids[i]]);
+                }
+            }
+            break;
+        case WIDTH_32:
+            for(size_t i = 0; i < num_seq_ids; i++) {
+                if(contains(seq_ids[i])) {
+                    out.push_back(reinterpret_cast<const int32_t*>(values)[seq_ids[i]]);
+                }
+            }
+            break;
+        default:
+            for(size_t i = 0; i < num_seq_ids; i++) {
+                if(contains(seq_ids[i])) {
+                    out.push_back(reinterpret_cast<const int64_t*>(values)[seq_ids[i]]);
+                }
+            }
+    }
+}
+
+int64_t sort_column_t::at(uint32_t seq_id) const {
+    if(!contains(seq_id)) {
+        throw std::out_of_range("sort_column_t: no value for seq_id " + std::to_string(seq_id));
+    }
+
+    return load(seq_id);
+}
+
+void sort_column_t::clear() {
+    free(values);
+    free(present);
+    values = nullptr;
+    present = nullptr;
+    capacity = 0;
+    num_values = 0;
+}
@@ -5,6 +5,7 @@
 #include <random>
 #include <openssl/sha.h>
 #include <map>
+#include <cstring>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include "logger.h"
@@ -633,4 +634,91 @@ size_t StringUtils::split_facet(const std::string &s, std::vector<std::string> &
 
 size_t StringUtils::get_occurence_count(const std::string &str, char symbol) {
     return std::count(str.begin(), str.end(), symbol);
-}
\ No newline at end of file
+}
+
+bool StringUtils::is_closed_json_object(const char* text, size_t length) {
+    size_t i = 0;
+    while(i < length && isspace(static_cast<unsigned char>(text[i]))) {
+        i++;
+    }
+
+    if(i == length || text[i] != '{') {
+        return false;
+    }
+
+    size_t depth = 0;
+    bool in_string = false;
+
+    for(; i < length; i++) {
+        const char c = text[i];
+
+        if(in_string) {
+            if(c == '\\') {
+                i++;
+            } else if(c == '"') {
+                in_string = false;
+            }
+
+            continue;
+        }
+
+        if(c == '"') {
+            in_string = true;
+        } else if(c == '{' || c == '[') {
+            depth++;
+        } else if(c == '}' || c == ']') {
+            if(--depth == 0) {
+                break;
+            }
+        }
+    }
+
+    if(i >= length) {
+        return false;
+    }
+
+    for(i++; i < length; i++) {
+        if(!isspace(static_cast<unsigned char>(text[i]))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void StringUtils::split_json_lines(std::string& body, std::vector<std::string>& json_lines, bool is_last_chunk) {
+    const char* data = body.data();
+    const size_t length = body.size();
+
+    size_t line_start = 0;
+
+    while(line_start < length) {
+        const char* line_end = static_cast<const char*>(std::memchr(data + line_start, '\n', length - line_start));
+        const size_t line_end_index = (line_end == nullptr) ? length : size_t(line_end - data);
+
+        if(line_end_index != line_start) {
+            json_lines.emplace_back(data + line_start, line_end_index - line_start);
+        }
+
+        line_start = line_end_index + 1;
+    }
+
+    if(is_last_chunk) {
+        body.clear();
+        return;
+    }
+
+    if(json_lines.empty()) {
+        return;
+    }
+
+    const std::string& last_line = json_lines.back();
+    if(is_closed_json_object(last_line.data(), last_line.size())) {
+        body.clear();
+        return;
+    }
+
+    // eject partial record
+    body = std::move(json_lines.back());
+    json_lines.pop_back();
+}
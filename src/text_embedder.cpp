@@ -1,6 +1,8 @@
 #include "text_embedder.h"
 #include "embedder_manager.h"
 #include "logger.h"
+#include "tsconfig.h"
+#include <algorithm>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -28,6 +30,18 @@ TextEmbedder::TextEmbedder(const std::string& model_name) {
             session_options.AppendExecutionProvider_CUDA(cuda_options);
         }
     }
+
+    const Config& config = Config::get_instance();
+    if(config.get_embedding_intra_op_threads() != 0) {
+        session_options.SetIntraOpNumThreads(config.get_embedding_intra_op_threads());
+    }
+
+    // a session can run several batches at once
+    batcher_ = std::make_unique<inference_batcher_t>(
+        [this](const std::vector<inference_batcher_t::inference_t*>& batch) { run_batch(batch); },
+        config.get_embedding_max_parallel_batches()
+    );
+
     std::string abs_path = EmbedderManager::get_absolute_model_path(model_name);
     session_options.EnableOrtCustomOps();
     LOG(INFO) << "Loading model from disk: " << abs_path;
@@ -121,220 +135,155 @@ embedding_res_t TextEmbedder::Embed(const std::string& text, const size_t remote
     if(is_remote()) {
         return remote_embedder_->Embed(text, remote_embedder_timeout_ms, remote_embedding_num_tries);
     } else {
-        // Cannot run same model in parallel, so lock the mutex
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto encoded_input = tokenizer_->Encode(text);
+        return infer({text})[0];
+    }
+}
+
+std::vector<embedding_res_t> TextEmbedder::batch_embed(const std::vector<std::string>& inputs, const size_t remote_embedding_batch_size,
+                                                       const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries) {
+    if(!is_remote()) {
+        return infer(inputs);
+    }
+
+    return remote_embedder_->batch_embed(inputs, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries);
+}
+
+std::vector<embedding_res_t> TextEmbedder::infer(const std::vector<std::string>& inputs) {
+    std::vector<encoded_input_t> encoded_inputs(inputs.size());
+
+    {
+        std::lock_guard<std::mutex> lock(tokenizer_mutex_);
+        for(size_t i = 0; i < inputs.size(); i++) {
+            encoded_inputs[i] = tokenizer_->Encode(inputs[i]);
+        }
+    }
+
+    return batcher_->infer(std::move(encoded_inputs));
+}
+
+void TextEmbedder::run_batch(const std::vector<inference_batcher_t::inference_t*>& batch) {
+    std::vector<inference_batcher_t::inference_t*> inputs;
+    size_t max_input_len = 0;
+
+    for(auto inference: batch) {
+        if(inference->encoded_input.input_ids.empty()) {
+            inference->result = embedding_res_t(400, nlohmann::json({{"error", "Invalid input: empty sequence"}}));
+            continue;
+        }
+
+        inputs.push_back(inference);
+        max_input_len = std::max(max_input_len, inference->encoded_input.input_ids.size());
+    }
+
+    if(inputs.empty()) {
+        return ;
+    }
+
+    const bool is_clip = (tokenizer_->get_tokenizer_type() == TokenizerType::clip);
+    const bool has_token_type_ids = (session_->GetInputCount() == 3 && !is_clip);
+
+    // inputs are padded to the longest one while they are flattened
+    std::vector<int64_t> input_ids_flatten(inputs.size() * max_input_len, 0);
+    std::vector<int64_t> attention_mask_flatten(inputs.size() * max_input_len, 0);
+    std::vector<int64_t> token_type_ids_flatten(has_token_type_ids ? inputs.size() * max_input_len : 0, 0);
+
+    for(size_t i = 0; i < inputs.size(); i++) {
+        const auto& encoded_input = inputs[i]->encoded_input;
+        std::copy(encoded_input.input_ids.begin(), encoded_input.input_ids.end(),
+                  input_ids_flatten.begin() + i * max_input_len);
+        std::copy(encoded_input.attention_mask.begin(), encoded_input.attention_mask.end(),
+                  attention_mask_flatten.begin() + i * max_input_len);
+
+        // edge case: xlm_roberta does not have token_type_ids, but if the model has it as input, we leave it as 0s
+        if(has_token_type_ids) {
+            std::copy(encoded_input.token_type_ids.begin(), encoded_input.token_type_ids.end(),
+                      token_type_ids_flatten.begin() + i * max_input_len);
+        }
+    }
+
+    try {
         // create input tensor object from data values
-        Ort::AllocatorWithDefaultOptions allocator;
         Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
         std::vector<Ort::Value> input_tensors;
         std::vector<std::vector<int64_t>> input_shapes;
         std::vector<const char*> input_node_names = {"input_ids", "attention_mask"};
         // If model is DistilBERT or sentencepiece, it has 2 inputs, else it has 3 inputs
-        if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
+        if(has_token_type_ids) {
             input_node_names.push_back("token_type_ids");
-        } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
+        } else if(session_->GetInputCount() == 3 && is_clip) {
             input_node_names.push_back("pixel_values");
         }
-        input_shapes.push_back({1, static_cast<int64_t>(encoded_input.input_ids.size())});
-        input_shapes.push_back({1, static_cast<int64_t>(encoded_input.attention_mask.size())});
-        if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-            // edge case: xlm_roberta does not have token_type_ids, but if the model has it as input, we need to fill it with 0s
-            if(encoded_input.token_type_ids.size() == 0) {
-                encoded_input.token_type_ids.resize(encoded_input.input_ids.size(), 0);
-            }
 
-            input_shapes.push_back({1, static_cast<int64_t>(encoded_input.token_type_ids.size())});
-        } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
+        const int64_t batch_size = inputs.size();
+        const int64_t seq_len = max_input_len;
+
+        input_shapes.push_back({batch_size, seq_len});
+        input_shapes.push_back({batch_size, seq_len});
+        if(has_token_type_ids) {
+            input_shapes.push_back({batch_size, seq_len});
+        } else if(session_->GetInputCount() == 3 && is_clip) {
             // dummy input for clip
             input_shapes.push_back({1, 3, 224, 224});
         }
-        input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, encoded_input.input_ids.data(), encoded_input.input_ids.size(), input_shapes[0].data(), input_shapes[0].size()));
-        input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, encoded_input.attention_mask.data(), encoded_input.attention_mask.size(), input_shapes[1].data(), input_shapes[1].size()));
-        if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-            input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, encoded_input.token_type_ids.data(), encoded_input.token_type_ids.size(), input_shapes[2].data(), input_shapes[2].size()));
-        } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
+
+        std::vector<float> pixel_values;
+
+        input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, input_ids_flatten.data(), input_ids_flatten.size(), input_shapes[0].data(), input_shapes[0].size()));
+        input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, attention_mask_flatten.data(), attention_mask_flatten.size(), input_shapes[1].data(), input_shapes[1].size()));
+        if(has_token_type_ids) {
+            input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, token_type_ids_flatten.data(), token_type_ids_flatten.size(), input_shapes[2].data(), input_shapes[2].size()));
+        } else if(session_->GetInputCount() == 3 && is_clip) {
             // dummy input for clip
-            std::vector<float> pixel_values(3 * 224 * 224, 0.5);
+            pixel_values.resize(3 * 224 * 224, 0.5);
             input_tensors.push_back(Ort::Value::CreateTensor<float>(memory_info, pixel_values.data(), pixel_values.size(), input_shapes[2].data(), input_shapes[2].size()));
         }
 
-        //LOG(INFO) << "Running model";
         // create output tensor object
         std::vector<const char*> output_node_names = {output_tensor_name.c_str()};
+
         auto output_tensor = session_->Run(Ort::RunOptions{nullptr}, input_node_names.data(), input_tensors.data(), input_tensors.size(), output_node_names.data(), output_node_names.size());
-        std::vector<std::vector<float>> output;
         float* data = output_tensor[0].GetTensorMutableData<float>();
-        // print output tensor shape
         auto shape = output_tensor[0].GetTensorTypeAndShapeInfo().GetShape();
-        // edge case for clip model
-        if(shape.size() == 2) {
-            // insert 1 to index 0
-            shape.insert(shape.begin(), 1);
-        }
-
-        for (int i = 0; i < shape[1]; i++) {
-            std::vector<float> temp;
-            for (int j = 0; j < shape[2]; j++) {
-                temp.push_back(data[i * shape[2] + j]);
-            }
-            // edge case for clip model
-            if(tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-                return embedding_res_t(temp);
-            }
-            output.push_back(temp);
-        }
-        auto pooled_output = mean_pooling(output, encoded_input.attention_mask);
-        return embedding_res_t(pooled_output);
-    }
-}
 
-std::vector<embedding_res_t> TextEmbedder::batch_embed(const std::vector<std::string>& inputs, const size_t remote_embedding_batch_size,
-                                                       const size_t remote_embedding_timeout_ms, const size_t remote_embedding_num_tries) {
-    std::vector<embedding_res_t> outputs;
-    if(!is_remote()) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for(int i = 0; i < inputs.size(); i += 8) {
-            auto input_batch = std::vector<std::string>(inputs.begin() + i, inputs.begin() + std::min(i + 8, static_cast<int>(inputs.size())));
-            auto encoded_inputs = batch_encode(input_batch);
-            
-            // create input tensor object from data values
-            Ort::AllocatorWithDefaultOptions allocator;
-            Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-            std::vector<Ort::Value> input_tensors;
-            std::vector<std::vector<int64_t>> input_shapes;
-            std::vector<const char*> input_node_names = {"input_ids", "attention_mask"};
-            // If model is DistilBERT or sentencepiece, it has 2 inputs, else it has 3 inputs
-            if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-                input_node_names.push_back("token_type_ids");
-            } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-                input_node_names.push_back("pixel_values");
-            }
-
-            input_shapes.push_back({static_cast<int64_t>(encoded_inputs.input_ids.size()), static_cast<int64_t>(encoded_inputs.input_ids[0].size())});
-            input_shapes.push_back({static_cast<int64_t>(encoded_inputs.attention_mask.size()), static_cast<int64_t>(encoded_inputs.attention_mask[0].size())});
-            if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-                input_shapes.push_back({static_cast<int64_t>(encoded_inputs.token_type_ids.size()), static_cast<int64_t>(encoded_inputs.token_type_ids[0].size())});
-            } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-                // dummy input for clip
-                input_shapes.push_back({1, 3, 224, 224});
-            }
-
-            std::vector<int64_t> input_ids_flatten;
-            std::vector<int64_t> attention_mask_flatten;
-            std::vector<int64_t> token_type_ids_flatten;
-
-            for (int i = 0; i < encoded_inputs.input_ids.size(); i++) {
-                for (int j = 0; j < encoded_inputs.input_ids[i].size(); j++) {
-                    input_ids_flatten.push_back(encoded_inputs.input_ids[i][j]);
-                }
-            }
-
-            for (int i = 0; i < encoded_inputs.attention_mask.size(); i++) {
-                for (int j = 0; j < encoded_inputs.attention_mask[i].size(); j++) {
-                    attention_mask_flatten.push_back(encoded_inputs.attention_mask[i][j]);
-                }
-            }
-
-            if(session_->GetInputCount() == 3) {
-                for (int i = 0; i < encoded_inputs.token_type_ids.size(); i++) {
-                    for (int j = 0; j < encoded_inputs.token_type_ids[i].size(); j++) {
-                        token_type_ids_flatten.push_back(encoded_inputs.token_type_ids[i][j]);
-                    }
-                }
+        if(is_clip) {
+            // no mean pooling for clip: there is a single embedding per input
+            const int64_t num_dims = shape.back();
+            for(size_t i = 0; i < inputs.size(); i++) {
+                inputs[i]->result = embedding_res_t(std::vector<float>(data + i * num_dims, data + (i + 1) * num_dims));
             }
-
-            input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, input_ids_flatten.data(), input_ids_flatten.size(), input_shapes[0].data(), input_shapes[0].size()));
-            input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, attention_mask_flatten.data(), attention_mask_flatten.size(), input_shapes[1].data(), input_shapes[1].size()));
-            if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-                input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(memory_info, token_type_ids_flatten.data(), token_type_ids_flatten.size(), input_shapes[2].data(), input_shapes[2].size()));
-            } else if(session_->GetInputCount() == 3 && tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-                // dummy input for clip
-                std::vector<float> pixel_values(3 * 224 * 224, 0.5);
-                input_tensors.push_back(Ort::Value::CreateTensor<float>(memory_info, pixel_values.data(), pixel_values.size(), input_shapes[2].data(), input_shapes[2].size()));
-            }
-
-            //LOG(INFO) << "Running model";
-            // create output tensor object
-            std::vector<const char*> output_node_names = {output_tensor_name.c_str()};
-
-            // if seq length is 0, return empty vector
-            if(input_shapes[0][1] == 0) {
-                for(int i = 0; i < input_batch.size(); i++) {
-                    outputs.push_back(embedding_res_t(400, nlohmann::json({{"error", "Invalid input: empty sequence"}})));
-                }
-                continue;
-            }
-
-            auto output_tensor = session_->Run(Ort::RunOptions{nullptr}, input_node_names.data(), input_tensors.data(), input_tensors.size(), output_node_names.data(), output_node_names.size());
-            float* data = output_tensor[0].GetTensorMutableData<float>();
-            // print output tensor shape
-            auto shape = output_tensor[0].GetTensorTypeAndShapeInfo().GetShape();
-            // edge case for clip model
-            if(shape.size() == 2) {
-                // insert 1 to index 0
-                shape.insert(shape.begin(), 1);
-            }
-            for (int i = 0; i < shape[0]; i++) {
+        } else {
+            for(size_t i = 0; i < inputs.size(); i++) {
                 std::vector<std::vector<float>> output;
-                for (int j = 0; j < shape[1]; j++) {
-                    std::vector<float> output_row;
-                    for (int k = 0; k < shape[2]; k++) {
-                        output_row.push_back(data[i * shape[1] * shape[2] + j * shape[2] + k]);
-                    }
-                    if(tokenizer_->get_tokenizer_type() == TokenizerType::clip) {
-                        // no mean pooling for clip
-                        outputs.push_back(embedding_res_t(output_row));
-                        continue;
-                    }
-                    output.push_back(output_row);
-                }
-                if(tokenizer_->get_tokenizer_type() != TokenizerType::clip) {
-                    outputs.push_back(embedding_res_t(mean_pooling(output, encoded_inputs.attention_mask[i])));
+                for(int64_t j = 0; j < shape[1]; j++) {
+                    const float* row = data + i * shape[1] * shape[2] + j * shape[2];
+                    output.emplace_back(row, row + shape[2]);
                 }
+
+                std::vector<int64_t> attention_mask(attention_mask_flatten.begin() + i * max_input_len,
+                                                    attention_mask_flatten.begin() + (i + 1) * max_input_len);
+                inputs[i]->result = embedding_res_t(mean_pooling(output, attention_mask));
             }
         }
-    } else {
-        outputs = std::move(remote_embedder_->batch_embed(inputs, remote_embedding_batch_size, remote_embedding_timeout_ms, remote_embedding_num_tries));
-    }
-    
-    return outputs;
-}
-
-TextEmbedder::~TextEmbedder() { }
-
-batch_encoded_input_t TextEmbedder::batch_encode(const std::vector<std::string>& inputs) {
-    batch_encoded_input_t encoded_inputs;
-    for(auto& input : inputs) {
-        auto encoded_input = tokenizer_->Encode(input);
-        encoded_inputs.input_ids.push_back(encoded_input.input_ids);
-        encoded_inputs.attention_mask.push_back(encoded_input.attention_mask);
-        encoded_inputs.token_type_ids.push_back(encoded_input.token_type_ids);
-    }
-
-    // Pad inputs
-    size_t max_input_len = 0;
-    for(auto& input_ids : encoded_inputs.input_ids) {
-        if(input_ids.size() > max_input_len) {
-            max_input_len = input_ids.size();
+    } catch(const std::exception& e) {
+        // the inputs can belong to other callers, so the error is handed to each of them instead of being thrown
+        LOG(ERROR) << "Error while running embedding model: " << e.what();
+        for(auto inference: inputs) {
+            inference->result = embedding_res_t(500, nlohmann::json({{"error", std::string("Error while running embedding model: ") + e.what()}}));
         }
     }
+}
 
-    for(auto& input_ids : encoded_inputs.input_ids) {
-        input_ids.resize(max_input_len, 0);
-    }
-
-    for(auto& attention_mask : encoded_inputs.attention_mask) {
-        attention_mask.resize(max_input_len, 0);
-    }
-
-    for(auto& token_type_ids : encoded_inputs.token_type_ids) {
-        token_type_ids.resize(max_input_len, 0);
+nlohmann::json TextEmbedder::get_inference_stats() const {
+    if(batcher_ == nullptr) {
+        // remote models are not batched here
+        return nlohmann::json::object();
     }
 
-    return encoded_inputs;
+    return batcher_->get_stats();
 }
 
+TextEmbedder::~TextEmbedder() { }
+
 Option<bool> TextEmbedder::validate() {
     if(session_->GetInputCount() != 3 && session_->GetInputCount() != 2) {
         LOG(ERROR) << "Invalid model: input count is not 3 or 2";
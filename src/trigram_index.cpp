@@ -0,0 +1,125 @@
+#include <algorithm>
+#include "trigram_index.h"
+
+void trigram_index_t::get_trigrams(const std::string& token, std::vector<uint32_t>& trigrams) {
+    trigrams.clear();
+
+    for(size_t i = 0; i + TRIGRAM_LEN <= token.size(); i++) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(token.data() + i);
+        trigrams.push_back((uint32_t(bytes[0]) << 16) | (uint32_t(bytes[1]) << 8) | uint32_t(bytes[2]));
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+trigram_index_t::~trigram_index_t() {
+    for(auto& kv: trigram_token_ids) {
+        delete kv.second;
+    }
+
+    trigram_token_ids.clear();
+}
+
+void trigram_index_t::insert(const std::string& token) {
+    if(token_ids.find(token) != token_ids.end()) {
+        return ;
+    }
+
+    uint32_t token_id;
+
+    if(!free_token_ids.empty()) {
+        token_id = free_token_ids.back();
+        free_token_ids.pop_back();
+        tokens[token_id] = token;
+    } else {
+        token_id = tokens.size();
+        tokens.push_back(token);
+    }
+
+    token_ids.insert(token, token_id);
+
+    std::vector<uint32_t> trigrams;
+    get_trigrams(token, trigrams);
+
+    for(auto trigram: trigrams) {
+        id_list_t*& ids = trigram_token_ids[trigram];
+        if(ids == nullptr) {
+            ids = new id_list_t(TOKEN_IDS_BLOCK_SIZE);
+        }
+
+        ids->upsert(token_id);
+    }
+}
+
+void trigram_index_t::erase(const std::string& token) {
+    auto token_it = token_ids.find(token);
+    if(token_it == token_ids.end()) {
+        return ;
+    }
+
+    const uint32_t token_id = token_it.value();
+    token_ids.erase(token_it);
+
+    std::vector<uint32_t> trigrams;
+    get_trigrams(token, trigrams);
+
+    for(auto trigram: trigrams) {
+        auto ids_it = trigram_token_ids.find(trigram);
+        if(ids_it == trigram_token_ids.end()) {
+            continue;
+        }
+
+        ids_it->second->erase(token_id);
+
+        if(ids_it->second->num_ids() == 0) {
+            delete ids_it->second;
+            trigram_token_ids.erase(ids_it);
+        }
+    }
+
+    tokens[token_id].clear();
+    tokens[token_id].shrink_to_fit();
+    free_token_ids.push_back(token_id);
+}
+
+void trigram_index_t::for_each_candidate(const std::string& query,
+                                         const std::function<bool(const std::string&)>& func) const {
+    if(query.size() < TRIGRAM_LEN) {
+        std::string key_buffer;
+
+        for(auto it = token_ids.begin(); it != token_ids.end(); it++) {
+            it.key(key_buffer);
+            if(!func(key_buffer)) {
+                return ;
+            }
+        }
+
+        return ;
+    }
+
+    std::vector<uint32_t> trigrams;
+    get_trigrams(query, trigrams);
+
+    std::vector<id_list_t*> id_lists;
+    id_lists.reserve(trigrams.size());
+
+    for(auto trigram: trigrams) {
+        auto ids_it = trigram_token_ids.find(trigram);
+        if(ids_it == trigram_token_ids.end()) {
+            // no token has this trigram
+            return ;
+        }
+
+        id_lists.push_back(ids_it->second);
+    }
+
+    std::vector<uint32_t> candidate_ids;
+    id_list_t::intersect(id_lists, candidate_ids);
+
+    for(auto token_id: candidate_ids) {
+        if(!func(tokens[token_id])) {
+            return ;
+        }
+    }
+}
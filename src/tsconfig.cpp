@@ -226,6 +226,26 @@ void Config::load_config_env() {
         this->db_compaction_interval = std::stoi(get_env("TYPESENSE_DB_COMPACTION_INTERVAL"));
     }
 
+    if(!get_env("TYPESENSE_WRITE_COALESCE_MAX_DOCS").empty()) {
+        this->write_coalesce_max_docs = std::stoi(get_env("TYPESENSE_WRITE_COALESCE_MAX_DOCS"));
+    }
+
+    if(!get_env("TYPESENSE_WRITE_COALESCE_WAIT_MS").empty()) {
+        this->write_coalesce_wait_ms = std::stoi(get_env("TYPESENSE_WRITE_COALESCE_WAIT_MS"));
+    }
+
+    if(!get_env("TYPESENSE_EMBEDDING_MAX_PARALLEL_BATCHES").empty()) {
+        this->embedding_max_parallel_batches = std::stoi(get_env("TYPESENSE_EMBEDDING_MAX_PARALLEL_BATCHES"));
+    }
+
+    if(!get_env("TYPESENSE_EMBEDDING_INTRA_OP_THREADS").empty()) {
+        this->embedding_intra_op_threads = std::stoi(get_env("TYPESENSE_EMBEDDING_INTRA_OP_THREADS"));
+    }
+
+    if(!get_env("TYPESENSE_QUERY_EMBEDDING_CACHE_SIZE_MB").empty()) {
+        this->query_embedding_cache_size_mb = std::stoi(get_env("TYPESENSE_QUERY_EMBEDDING_CACHE_SIZE_MB"));
+    }
+
     if(!get_env("TYPESENSE_THREAD_POOL_SIZE").empty()) {
         this->thread_pool_size = std::stoi(get_env("TYPESENSE_THREAD_POOL_SIZE"));
     }
@@ -252,6 +272,11 @@ void Config::load_config_env() {
 
     this->skip_writes = ("TRUE" == get_env("TYPESENSE_SKIP_WRITES"));
     this->enable_lazy_filter = ("TRUE" == get_env("TYPESENSE_ENABLE_LAZY_FILTER"));
+    this->enable_vector_index_snapshot = ("TRUE" == get_env("TYPESENSE_ENABLE_VECTOR_INDEX_SNAPSHOT"));
+
+    if(!get_env("TYPESENSE_VECTOR_INDEX_SNAPSHOT_MAX_ELEMENTS").empty()) {
+        this->vector_index_snapshot_max_elements = std::stoul(get_env("TYPESENSE_VECTOR_INDEX_SNAPSHOT_MAX_ELEMENTS"));
+    }
     this->reset_peers_on_error = ("TRUE" == get_env("TYPESENSE_RESET_PEERS_ON_ERROR"));
 }
 
@@ -407,6 +432,26 @@ void Config::load_config_file(cmdline::parser& options) {
         this->db_compaction_interval = (int) reader.GetInteger("server", "db-compaction-interval", 0);
     }
 
+    if(reader.Exists("server", "write-coalesce-max-docs")) {
+        this->write_coalesce_max_docs = (int) reader.GetInteger("server", "write-coalesce-max-docs", 1);
+    }
+
+    if(reader.Exists("server", "write-coalesce-wait-ms")) {
+        this->write_coalesce_wait_ms = (int) reader.GetInteger("server", "write-coalesce-wait-ms", 0);
+    }
+
+    if(reader.Exists("server", "embedding-max-parallel-batches")) {
+        this->embedding_max_parallel_batches = (int) reader.GetInteger("server", "embedding-max-parallel-batches", 1);
+    }
+
+    if(reader.Exists("server", "embedding-intra-op-threads")) {
+        this->embedding_intra_op_threads = (int) reader.GetInteger("server", "embedding-intra-op-threads", 0);
+    }
+
+    if(reader.Exists("server", "query-embedding-cache-size-mb")) {
+        this->query_embedding_cache_size_mb = (int) reader.GetInteger("server", "query-embedding-cache-size-mb", 16);
+    }
+
     if(reader.Exists("server", "thread-pool-size")) {
         this->thread_pool_size = (int) reader.GetInteger("server", "thread-pool-size", 0);
     }
@@ -443,6 +488,16 @@ void Config::load_config_file(cmdline::parser& options) {
         this->enable_lazy_filter = (enable_lazy_filter_str == "true");
     }
 
+    if(reader.Exists("server", "enable-vector-index-snapshot")) {
+        auto enable_vector_index_snapshot_str = reader.Get("server", "enable-vector-index-snapshot", "false");
+        this->enable_vector_index_snapshot = (enable_vector_index_snapshot_str == "true");
+    }
+
+    if(reader.Exists("server", "vector-index-snapshot-max-elements")) {
+        this->vector_index_snapshot_max_elements = (int) reader.GetInteger("server", "vector-index-snapshot-max-elements",
+                                                                           5000000);
+    }
+
     if(reader.Exists("server", "skip-writes")) {
         auto skip_writes_str = reader.Get("server", "skip-writes", "false");
         this->skip_writes = (skip_writes_str == "true");
@@ -585,6 +640,26 @@ void Config::load_config_cmd_args(cmdline::parser& options)  {
         this->db_compaction_interval = options.get<uint32_t>("db-compaction-interval");
     }
 
+    if(options.exist("write-coalesce-max-docs")) {
+        this->write_coalesce_max_docs = options.get<uint32_t>("write-coalesce-max-docs");
+    }
+
+    if(options.exist("write-coalesce-wait-ms")) {
+        this->write_coalesce_wait_ms = options.get<uint32_t>("write-coalesce-wait-ms");
+    }
+
+    if(options.exist("embedding-max-parallel-batches")) {
+        this->embedding_max_parallel_batches = options.get<uint32_t>("embedding-max-parallel-batches");
+    }
+
+    if(options.exist("embedding-intra-op-threads")) {
+        this->embedding_intra_op_threads = options.get<uint32_t>("embedding-intra-op-threads");
+    }
+
+    if(options.exist("query-embedding-cache-size-mb")) {
+        this->query_embedding_cache_size_mb = options.get<uint32_t>("query-embedding-cache-size-mb");
+    }
+
     if(options.exist("thread-pool-size")) {
         this->thread_pool_size = options.get<uint32_t>("thread-pool-size");
     }
@@ -621,6 +696,14 @@ void Config::load_config_cmd_args(cmdline::parser& options)  {
         this->enable_lazy_filter = options.get<bool>("enable-lazy-filter");
     }
 
+    if(options.exist("enable-vector-index-snapshot")) {
+        this->enable_vector_index_snapshot = options.get<bool>("enable-vector-index-snapshot");
+    }
+
+    if(options.exist("vector-index-snapshot-max-elements")) {
+        this->vector_index_snapshot_max_elements = options.get<uint32_t>("vector-index-snapshot-max-elements");
+    }
+
     if(options.exist("enable-search-logging")) {
         this->enable_search_logging = options.get<bool>("enable-search-logging");
     }
@@ -113,7 +113,14 @@ void init_cmdline_options(cmdline::parser & options, int argc, char **argv) {
     options.add<uint32_t>("analytics-flush-interval", '\0', "Frequency of persisting analytics data to disk (in seconds).", false, 3600);
     options.add<uint32_t>("housekeeping-interval", '\0', "Frequency of housekeeping background job (in seconds).", false, 1800);
     options.add<bool>("enable-lazy-filter", '\0', "Filter clause will be evaluated lazily.", false, false);
+    options.add<bool>("enable-vector-index-snapshot", '\0', "Persist vector indices along with snapshots so that they are not rebuilt on restart.", false, false);
+    options.add<uint32_t>("vector-index-snapshot-max-elements", '\0', "Vector indices are persisted along with a snapshot only up to this many vectors in total, since writes are paused while they are saved. Larger ones are rebuilt on restart.", false, 5000000);
     options.add<uint32_t>("db-compaction-interval", '\0', "Frequency of RocksDB compaction (in seconds).", false, 604800);
+    options.add<uint32_t>("write-coalesce-max-docs", '\0', "When > 1, up to this many consecutive single document writes to a collection are indexed as one batch.", false, 1);
+    options.add<uint32_t>("write-coalesce-wait-ms", '\0', "How long a coalesced batch of single document writes waits for more writes to arrive (in milliseconds).", false, 0);
+    options.add<uint32_t>("embedding-max-parallel-batches", '\0', "Number of batches that a local embedding model runs at the same time.", false, 1);
+    options.add<uint32_t>("embedding-intra-op-threads", '\0', "Number of threads that a local embedding model uses to run a batch (0 leaves it to onnxruntime).", false, 0);
+    options.add<uint32_t>("query-embedding-cache-size-mb", '\0', "Memory used to cache the embeddings of search queries (0 disables the cache).", false, 16);
 
     // DEPRECATED
     options.add<std::string>("listen-address", 'h', "[DEPRECATED: use `api-address`] Address to which Typesense API service binds.", false, "0.0.0.0");
@@ -449,6 +456,7 @@ int run_server(const Config & config, const std::string & version, void (*master
         LOG(INFO) << "Failed to initialize rate limit manager: " << rate_limit_manager_init.error();
     }
     EmbedderManager::set_model_dir(config.get_data_dir() + "/models");
+    EmbedderManager::get_instance().set_query_embedding_cache_max_bytes(config.get_query_embedding_cache_size_mb() * 1024 * 1024);
 
     auto conversations_init = ConversationManager::get_instance().init(&store);
 
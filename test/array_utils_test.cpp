@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
 #include "array_utils.h"
 #include "logger.h"
 
@@ -214,4 +216,41 @@ TEST(SortedArrayTest, SkipToID) {
     found = ArrayUtils::skip_index_to_id(index, array.data(), array.size(), 30);
     ASSERT_FALSE(found);
     ASSERT_EQ(12, index);
-}
\ No newline at end of file
+}
+
+TEST(SortedArrayTest, LowerBoundFrom) {
+    std::vector<uint32_t> array;
+    for (uint32_t i = 0; i < 100; i++) {
+        array.push_back(i * 3);
+    }
+
+    ASSERT_EQ(0, ArrayUtils::lower_bound_from(array.data(), array.size(), 0, 0));
+    ASSERT_EQ(5, ArrayUtils::lower_bound_from(array.data(), array.size(), 0, 15));
+    ASSERT_EQ(6, ArrayUtils::lower_bound_from(array.data(), array.size(), 0, 16));
+    ASSERT_EQ(10, ArrayUtils::lower_bound_from(array.data(), array.size(), 10, 3));
+    ASSERT_EQ(99, ArrayUtils::lower_bound_from(array.data(), array.size(), 10, 297));
+    ASSERT_EQ(100, ArrayUtils::lower_bound_from(array.data(), array.size(), 10, 298));
+    ASSERT_EQ(100, ArrayUtils::lower_bound_from(array.data(), array.size(), 100, 5));
+    ASSERT_EQ(0, ArrayUtils::lower_bound_from(array.data(), 0, 0, 5));
+
+    // values that don't fit in a signed 32-bit integer must compare correctly too
+    std::vector<uint32_t> large = {1, 2, 0x7FFFFFFF, 0x80000000, 0x80000001, 0xFFFFFFF0, 0xFFFFFFFF};
+    ASSERT_EQ(3, ArrayUtils::lower_bound_from(large.data(), large.size(), 0, 0x80000000));
+    ASSERT_EQ(6, ArrayUtils::lower_bound_from(large.data(), large.size(), 1, 0xFFFFFFF1));
+    ASSERT_EQ(6, ArrayUtils::count_less_than(large.data(), large.size(), UINT32_MAX));
+
+    std::mt19937 gen(137);
+    std::vector<uint32_t> rand_array;
+    uint32_t val = 0;
+    for (size_t i = 0; i < 5000; i++) {
+        val += 1 + (gen() % 50);
+        rand_array.push_back(val);
+    }
+
+    for (size_t i = 0; i < 2000; i++) {
+        const uint32_t start_index = gen() % (rand_array.size() + 1);
+        const uint32_t id = gen() % (val + 100);
+        auto expected = std::lower_bound(rand_array.begin() + start_index, rand_array.end(), id) - rand_array.begin();
+        ASSERT_EQ(expected, ArrayUtils::lower_bound_from(rand_array.data(), rand_array.size(), start_index, id));
+    }
+}
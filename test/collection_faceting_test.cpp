@@ -2038,6 +2038,50 @@ TEST_F(CollectionFacetingTest, SampleFacetCounts) {
     ASSERT_EQ("Value of `facet_sample_percent` must be less than 100.", res_op.error());
 }
 
+TEST_F(CollectionFacetingTest, SampleRangeFacetCounts) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, true),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    for(size_t i = 0; i < 1000; i++) {
+        nlohmann::json doc;
+        doc["title"] = "Title " + std::to_string(i);
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto res = coll1->search("*", {}, "", {"points(Low:[0, 500], High:[500, 1000])"}, {}, {0}, 3, 1, FREQUENCY,
+                             {true}, 5, spp::sparse_hash_set<std::string>(),
+                             spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {}, {}, 0,
+                             "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7, fallback,
+                             4, {off}, 3, 3, 2, 2, false, "", true, 0, max_score, 10, 0).get();
+
+    ASSERT_EQ(1000, res["found"].get<size_t>());
+    ASSERT_EQ(1, res["facet_counts"].size());
+    ASSERT_EQ(2, res["facet_counts"][0]["counts"].size());
+    ASSERT_TRUE(res["facet_counts"][0]["sampled"].get<bool>());
+
+    // the sampled range counts are scaled back up to approximately the real counts
+    for(size_t i = 0; i < res["facet_counts"][0]["counts"].size(); i++) {
+        auto count = res["facet_counts"][0]["counts"][i]["count"].get<size_t>();
+        ASSERT_GE(count, 400);
+        ASSERT_LE(count, 600);
+    }
+
+    // without sampling, range counts are exact
+    res = coll1->search("*", {}, "", {"points(Low:[0, 500], High:[500, 1000])"}, {}, {0}, 3, 1, FREQUENCY,
+                        {true}, 5, spp::sparse_hash_set<std::string>(),
+                        spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "", 20, {}, {}, {}, 0,
+                        "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7, fallback,
+                        4, {off}, 3, 3, 2, 2, false, "", true, 0, max_score, 100, 0).get();
+
+    ASSERT_EQ(2, res["facet_counts"][0]["counts"].size());
+    ASSERT_FALSE(res["facet_counts"][0]["sampled"].get<bool>());
+    ASSERT_EQ(500, res["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+    ASSERT_EQ(500, res["facet_counts"][0]["counts"][1]["count"].get<size_t>());
+}
+
 TEST_F(CollectionFacetingTest, FacetOnArrayFieldWithSpecialChars) {
     std::vector<field> fields = {
             field("tags", field_types::STRING_ARRAY, true),
@@ -3083,3 +3127,50 @@ TEST_F(CollectionFacetingTest, FacetingWithCoercedString) {
     ASSERT_EQ(3, results["facet_counts"][0]["counts"].size());
     ASSERT_EQ(1, results["facet_counts"][0]["counts"][0]["count"]);
 }
+
+TEST_F(CollectionFacetingTest, TopValuesOfCorrelatedFilterOnHighCardinalityFacet) {
+    std::vector<field> fields = {field("brand", field_types::STRING, true),
+                                 field("in_results", field_types::BOOL, false)};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "", 0, "", {}, {}).get();
+
+    std::vector<std::string> records;
+    auto add_docs = [&](const std::string& brand, size_t num_docs, size_t num_in_results) {
+        for(size_t i = 0; i < num_docs; i++) {
+            nlohmann::json doc;
+            doc["brand"] = brand;
+            doc["in_results"] = (i < num_in_results);
+            records.push_back(doc.dump());
+        }
+    };
+
+    // values that are the most frequent overall, but have few results
+    for(size_t i = 0; i < 100; i++) {
+        add_docs("decoy_" + std::to_string(i), 10, 1);
+    }
+
+    // values that are rare overall, but the most frequent in the results
+    for(size_t i = 0; i < 10; i++) {
+        add_docs("top_" + std::to_string(i), 3, 3);
+    }
+
+    for(size_t i = 0; i < 2000; i++) {
+        add_docs("filler_" + std::to_string(i), 2, 1);
+    }
+
+    nlohmann::json document;
+    auto import_response = coll1->add_many(records, document);
+    ASSERT_TRUE(import_response["success"].get<bool>());
+
+    // results are 42% of the documents and the facet has more than 2000 values
+    auto results = coll1->search("*", {}, "in_results: true", {"brand"}, {}, {0}, 0, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(2130, results["found"].get<size_t>());
+
+    auto counts = results["facet_counts"][0]["counts"];
+    ASSERT_EQ(10, counts.size());
+
+    for(const auto& count: counts) {
+        ASSERT_EQ(3, count["count"].get<size_t>());
+        ASSERT_EQ(0, count["value"].get<std::string>().rfind("top_", 0));
+    }
+}
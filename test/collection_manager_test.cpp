@@ -549,6 +549,52 @@ TEST_F(CollectionManagerTest, RestoreRecordsOnRestart) {
     ASSERT_EQ(4, results["hits"].size());
 }
 
+TEST_F(CollectionManagerTest, RestoreRecordsAcrossReaderRanges) {
+    for(size_t i = 0; i < 1000; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "Document " + std::to_string(i);
+        doc["points"] = i;
+        ASSERT_TRUE(collection1->add(doc.dump()).ok());
+    }
+
+    // leave gaps in the seq ids, so that ranges don't start and end at documents
+    for(size_t i = 0; i < 1000; i += 7) {
+        ASSERT_TRUE(collection1->remove(std::to_string(i)).ok());
+    }
+
+    collectionManager.dispose();
+    delete store;
+
+    // a batch size of 50 splits the seq ids into more than one range, which are read concurrently
+    ASSERT_LT(1, std::min<size_t>(CollectionManager::DOC_LOAD_NUM_READERS, 1000 / 50));
+
+    store = new Store("/tmp/typesense_test/coll_manager_test_db");
+    collectionManager.init(store, 1.0, "auth_key", quit);
+    auto load_op = collectionManager.load(8, 50);
+    ASSERT_TRUE(load_op.ok());
+
+    collection1 = collectionManager.get_collection("collection1").get();
+    ASSERT_NE(nullptr, collection1);
+    ASSERT_EQ(1000, collection1->get_next_seq_id());
+    ASSERT_EQ(857, collection1->get_num_documents());
+
+    for(size_t i = 0; i < 1000; i++) {
+        auto doc_op = collection1->get(std::to_string(i));
+        ASSERT_EQ(i % 7 != 0, doc_op.ok());
+
+        if(doc_op.ok()) {
+            ASSERT_EQ(i, doc_op.get()["points"].get<size_t>());
+        }
+    }
+
+    auto results = collection1->search("document", {"title"}, "points: >= 990", {}, sort_fields, {0}, 10, 1,
+                                       FREQUENCY, {false}).get();
+    ASSERT_EQ(9, results["found"].get<size_t>());
+    ASSERT_EQ("999", results["hits"][0]["document"]["id"].get<std::string>());
+    ASSERT_EQ("990", results["hits"][8]["document"]["id"].get<std::string>());
+}
+
 TEST_F(CollectionManagerTest, VerifyEmbeddedParametersOfScopedAPIKey) {
     std::vector<field> fields = {field("title", field_types::STRING, false, false, true, "", -1, 1),
                                  field("year", field_types::INT32, false),
@@ -2894,3 +2894,49 @@ TEST_F(CollectionOptimizedFacetingTest, RangeFacetRangeLabelWithSpace) {
     ASSERT_EQ(1, (int) results["facet_counts"][0]["counts"][0]["count"]);
     ASSERT_EQ("small tvs with display size", results["facet_counts"][0]["counts"][0]["value"]);
 }
+
+TEST_F(CollectionOptimizedFacetingTest, NumericFacetStatsAndRangesFromSortColumn) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("price", field_types::INT32, true),
+                                 field("rating", field_types::FLOAT, true),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "", 0, "", {}, {}).get();
+
+    for(size_t i = 0; i < 50; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "Title " + std::to_string(i);
+        doc["price"] = i;
+        doc["rating"] = i / 2.0;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    // only the top few facet values are returned, but stats and ranges must cover all of the results
+    for(auto facet_index_type: {VALUE, HASH}) {
+        auto results = coll1->search("*", {}, "price:>=10",
+                                     {"rating", "price(low:[0, 20], high:[20, 50])"},
+                                     {}, {0}, 10, 1, FREQUENCY, {true}, 10, spp::sparse_hash_set<std::string>(),
+                                     spp::sparse_hash_set<std::string>(), 2, "", 30, 4, "", 10, {}, {}, {}, 0,
+                                     "<mark>", "</mark>", {}, 1000,
+                                     true, false, true, "", true,  6000000UL,
+                                     4UL, 7UL, fallback, 4UL, {off}, 32767UL, 32767UL, 2UL, 2UL, false,
+                                     "", true, 0UL, max_score, 100UL, 0UL, 4294967295UL, facet_index_type).get();
+
+        ASSERT_EQ(40, results["found"].get<size_t>());
+        ASSERT_EQ(2, results["facet_counts"].size());
+
+        ASSERT_EQ(2, results["facet_counts"][0]["counts"].size());
+        ASSERT_FLOAT_EQ(5, results["facet_counts"][0]["stats"]["min"].get<double>());
+        ASSERT_FLOAT_EQ(24.5, results["facet_counts"][0]["stats"]["max"].get<double>());
+        ASSERT_FLOAT_EQ(590, results["facet_counts"][0]["stats"]["sum"].get<double>());
+        ASSERT_FLOAT_EQ(14.75, results["facet_counts"][0]["stats"]["avg"].get<double>());
+
+        ASSERT_EQ(2, results["facet_counts"][1]["counts"].size());
+        ASSERT_EQ("high", results["facet_counts"][1]["counts"][0]["value"].get<std::string>());
+        ASSERT_EQ(30, results["facet_counts"][1]["counts"][0]["count"].get<size_t>());
+        ASSERT_EQ("low", results["facet_counts"][1]["counts"][1]["value"].get<std::string>());
+        ASSERT_EQ(10, results["facet_counts"][1]["counts"][1]["count"].get<size_t>());
+    }
+
+    collectionManager.drop_collection("coll1");
+}
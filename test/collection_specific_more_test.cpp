@@ -3012,4 +3012,77 @@ TEST_F(CollectionSpecificMoreTest, TestFieldStore) {
     ASSERT_EQ(1, res.get()["hits"].size());
     ASSERT_EQ("store", res.get()["hits"][0]["document"]["word_to_store"].get<std::string>());
     ASSERT_TRUE(res.get()["hits"][0]["document"].count("word_not_to_store") == 0);
-}
\ No newline at end of file
+}
+
+TEST_F(CollectionSpecificMoreTest, PruningByTextMatchKeepsResultOrder) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "points", "type": "int32"}
+        ],
+        "default_sorting_field": "points"
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    // verbatim matches fill up the topster first, so that the non-verbatim documents after them can be pruned
+    for(size_t i = 0; i < 1000; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = (i < 300) ? "alpha" : "beta alpha gamma " + std::to_string(i);
+        doc["points"] = (i * 7) % 100;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    std::vector<nlohmann::json> results;
+
+    for(bool exhaustive_search: {true, false}) {
+        auto res = coll1->search("alpha", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}, 0,
+                                 spp::sparse_hash_set<std::string>(),
+                                 spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "title", 20, {}, {}, {}, 0,
+                                 "<mark>", "</mark>", {}, 1000, true, false, true, "", exhaustive_search).get();
+        results.push_back(res);
+    }
+
+    ASSERT_EQ(1000, results[0]["found"].get<size_t>());
+    ASSERT_EQ(results[0]["found"], results[1]["found"]);
+    ASSERT_EQ(10, results[1]["hits"].size());
+
+    for(size_t i = 0; i < results[0]["hits"].size(); i++) {
+        ASSERT_EQ(results[0]["hits"][i]["document"]["id"], results[1]["hits"][i]["document"]["id"]);
+        ASSERT_EQ(results[0]["hits"][i]["text_match"], results[1]["hits"][i]["text_match"]);
+        ASSERT_EQ("alpha", results[1]["hits"][i]["document"]["title"].get<std::string>());
+    }
+}
+
+TEST_F(CollectionSpecificMoreTest, BatchLargerThanWriteSliceIsFullyIndexed) {
+    std::vector<field> fields = {field("title", field_types::STRING, false)};
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    // a single batch whose token postings span several write slices of the field
+    std::vector<std::string> json_lines;
+    for(size_t i = 0; i < 1000; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "common tok" + std::to_string(i) + " word" + std::to_string(i % 10) + " more text";
+        json_lines.push_back(doc.dump());
+    }
+
+    nlohmann::json document;
+    auto import_response = coll1->add_many(json_lines, document);
+    ASSERT_TRUE(import_response["success"].get<bool>());
+    ASSERT_EQ(1000, import_response["num_imported"].get<int>());
+
+    auto results = coll1->search("common", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1000, results["found"].get<size_t>());
+
+    results = coll1->search("word3", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(100, results["found"].get<size_t>());
+
+    results = coll1->search("tok999", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1, results["found"].get<size_t>());
+    ASSERT_EQ("999", results["hits"][0]["document"]["id"].get<std::string>());
+
+    collectionManager.drop_collection("coll1");
+}
@@ -5,6 +5,8 @@
 #include "collection.h"
 #include <cstdlib>
 #include <ctime>
+#include <cmath>
+#include <fstream>
 #include "conversation_manager.h"
 #include "conversation_model_manager.h"
 #include "index.h"
@@ -4072,6 +4074,80 @@ TEST_F(CollectionVectorTest, TestHNSWParamsSummaryJSON) {
     ASSERT_EQ(0, summary["fields"][0].count("hnsw_params"));
 }
 
+TEST_F(CollectionVectorTest, Int8QuantizedVectorSearch) {
+    nlohmann::json schema_json = R"({
+        "name": "quantized",
+        "fields": [
+            {"name": "vec", "type": "float[]", "num_dim": 32, "hnsw_params": {"quantization": "int4"}}
+        ]
+    })"_json;
+
+    auto collection_create_op = collectionManager.create_collection(schema_json);
+    ASSERT_FALSE(collection_create_op.ok());
+    ASSERT_EQ("Property `hnsw_params.quantization` must be `none` or `int8`.", collection_create_op.error());
+
+    schema_json["fields"][0]["hnsw_params"]["quantization"] = "int8";
+    collection_create_op = collectionManager.create_collection(schema_json);
+    ASSERT_TRUE(collection_create_op.ok());
+    Collection* quantized_coll = collection_create_op.get();
+    ASSERT_EQ("int8", quantized_coll->get_summary_json()["fields"][0]["hnsw_params"]["quantization"].get<std::string>());
+
+    schema_json["name"] = "plain";
+    schema_json["fields"][0]["hnsw_params"].erase("quantization");
+    Collection* plain_coll = collectionManager.create_collection(schema_json).get();
+
+    std::mt19937 rng;
+    rng.seed(47);
+    std::uniform_real_distribution<float> distrib(-1, 1);
+
+    for(size_t i = 0; i < 500; i++) {
+        std::vector<float> values(32);
+        std::generate(values.begin(), values.end(), [&](){ return distrib(rng); });
+
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["vec"] = values;
+        ASSERT_TRUE(quantized_coll->add(doc.dump()).ok());
+        ASSERT_TRUE(plain_coll->add(doc.dump()).ok());
+    }
+
+    std::vector<float> query(32);
+    std::generate(query.begin(), query.end(), [&](){ return distrib(rng); });
+    const std::string vector_query = "vec:(" + nlohmann::json(query).dump() + ", k: 10, ef: 500)";
+
+    auto search = [&](Collection* coll) {
+        return coll->search("*", {}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}, Index::DROP_TOKENS_THRESHOLD,
+                            spp::sparse_hash_set<std::string>(),
+                            spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                            "", 10, {}, {}, {}, 0,
+                            "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7, fallback,
+                            4, {off}, 32767, 32767, 2,
+                            false, true, vector_query).get();
+    };
+
+    // results are reranked on the actual vectors, so they match the unquantized graph
+    auto quantized_results = search(quantized_coll);
+    auto plain_results = search(plain_coll);
+
+    ASSERT_EQ(10, quantized_results["hits"].size());
+    ASSERT_EQ(10, plain_results["hits"].size());
+
+    for(size_t i = 0; i < 10; i++) {
+        ASSERT_EQ(plain_results["hits"][i]["document"]["id"], quantized_results["hits"][i]["document"]["id"]);
+        ASSERT_NEAR(plain_results["hits"][i]["vector_distance"].get<float>(),
+                    quantized_results["hits"][i]["vector_distance"].get<float>(), 0.001);
+    }
+
+    const std::string top_id = quantized_results["hits"][0]["document"]["id"];
+    ASSERT_TRUE(quantized_coll->remove(top_id).ok());
+
+    quantized_results = search(quantized_coll);
+    ASSERT_EQ(10, quantized_results["hits"].size());
+    for(const auto& hit: quantized_results["hits"]) {
+        ASSERT_NE(top_id, hit["document"]["id"].get<std::string>());
+    }
+}
+
 TEST_F(CollectionVectorTest, TestUpdatingSameDocument){
     nlohmann::json schema_json = R"({
         "name": "test",
@@ -4444,4 +4520,107 @@ TEST_F(CollectionVectorTest, TestInvalidOpenAIURL) {
     auto collection_create_op = collectionManager.create_collection(schema_json);
     ASSERT_FALSE(collection_create_op.ok());
     ASSERT_EQ("OpenAI API error: ", collection_create_op.error());
-}
\ No newline at end of file
+}
+
+TEST_F(CollectionVectorTest, VectorIndexSnapshotRoundTrip) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "vec", "type": "float[]", "num_dim": 2}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    // points on a circle, so that the nearest neighbours of a query are unambiguous
+    auto add_doc = [&](Collection* coll, size_t i) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "Title " + std::to_string(i);
+        doc["vec"] = {std::cos(i * 0.04), std::sin(i * 0.04)};
+        ASSERT_TRUE(coll->add(doc.dump()).ok());
+    };
+
+    auto search = [&](Collection* coll, float angle) {
+        const std::string vector_query = "vec:([" + std::to_string(std::cos(angle)) + ", " +
+                                         std::to_string(std::sin(angle)) + "], k: 10, flat_search_cutoff: 0)";
+        return coll->search("*", {}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}, Index::DROP_TOKENS_THRESHOLD,
+                            spp::sparse_hash_set<std::string>(),
+                            spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                            "", 10, {}, {}, {}, 0,
+                            "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7, fallback,
+                            4, {off}, 32767, 32767, 2,
+                            false, true, vector_query).get();
+    };
+
+    for(size_t i = 0; i < 100; i++) {
+        add_doc(coll1, i);
+    }
+
+    const std::string snapshot_dir = "/tmp/typesense_test/collection_vector_search_snapshot";
+    system(("rm -rf " + snapshot_dir + " && mkdir -p " + snapshot_dir).c_str());
+    ASSERT_TRUE(collectionManager.save_vector_indices(snapshot_dir, 1000).ok());
+
+    std::ifstream manifest_file(snapshot_dir + "/" + CollectionManager::VECTOR_INDEX_MANIFEST_FILE);
+    nlohmann::json manifest = nlohmann::json::parse(manifest_file);
+    ASSERT_EQ(1, manifest.size());
+    ASSERT_EQ("vec", manifest[0]["field"].get<std::string>());
+    ASSERT_EQ(100, manifest[0]["seq_id_watermark"].get<uint32_t>());
+
+    // documents written after the graph was saved are above its watermark and get indexed on load
+    for(size_t i = 100; i < 150; i++) {
+        add_doc(coll1, i);
+    }
+
+    const std::vector<float> query_angles = {0.513, 2.113, 3.913, 4.513, 5.513};
+    std::vector<nlohmann::json> expected_results;
+    for(auto angle: query_angles) {
+        expected_results.push_back(search(coll1, angle));
+    }
+
+    auto restart = [&](const std::string& vector_index_dir) {
+        collectionManager.dispose();
+        delete store;
+
+        store = new Store("/tmp/typesense_test/collection_vector_search");
+        collectionManager.init(store, 1.0, "auth_key", quit);
+        ASSERT_TRUE(collectionManager.load(8, 1000, vector_index_dir).ok());
+    };
+
+    auto assert_same_results = [&](Collection* coll) {
+        for(size_t i = 0; i < query_angles.size(); i++) {
+            auto results = search(coll, query_angles[i]);
+            ASSERT_EQ(expected_results[i]["found"].get<size_t>(), results["found"].get<size_t>());
+            ASSERT_EQ(expected_results[i]["hits"].size(), results["hits"].size());
+
+            for(size_t j = 0; j < results["hits"].size(); j++) {
+                ASSERT_EQ(expected_results[i]["hits"][j]["document"]["id"], results["hits"][j]["document"]["id"]);
+                ASSERT_FLOAT_EQ(expected_results[i]["hits"][j]["vector_distance"].get<float>(),
+                                results["hits"][j]["vector_distance"].get<float>());
+            }
+        }
+    };
+
+    restart(snapshot_dir);
+    coll1 = collectionManager.get_collection("coll1").get();
+    ASSERT_EQ(150, coll1->get_num_documents());
+    assert_same_results(coll1);
+
+    // writes after the load go into the restored graph
+    add_doc(coll1, 150);
+    auto results = search(coll1, 150 * 0.04);
+    ASSERT_EQ("150", results["hits"][0]["document"]["id"].get<std::string>());
+
+    // a graph that doesn't fit within the snapshot limit is left out and rebuilt on load
+    system(("rm -rf " + snapshot_dir + " && mkdir -p " + snapshot_dir).c_str());
+    ASSERT_TRUE(collectionManager.save_vector_indices(snapshot_dir, 150).ok());
+
+    std::ifstream limited_manifest_file(snapshot_dir + "/" + CollectionManager::VECTOR_INDEX_MANIFEST_FILE);
+    ASSERT_EQ(0, nlohmann::json::parse(limited_manifest_file).size());
+
+    restart(snapshot_dir);
+    coll1 = collectionManager.get_collection("coll1").get();
+    ASSERT_EQ(151, coll1->get_num_documents());
+    assert_same_results(coll1);
+}
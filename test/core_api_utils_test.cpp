@@ -847,6 +847,163 @@ TEST_F(CoreAPIUtilsTest, SearchPagination) {
 
 }
 
+TEST_F(CoreAPIUtilsTest, SearchCacheNormalizedKeyAndWriteInvalidation) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+          {"name": "name", "type": "string" },
+          {"name": "points", "type": "int32" }
+        ]
+    })"_json;
+
+    auto op = collectionManager.create_collection(schema);
+    ASSERT_TRUE(op.ok());
+    Collection* coll1 = op.get();
+
+    nlohmann::json doc;
+    doc["id"] = "0";
+    doc["name"] = "Running Shoes";
+    doc["points"] = 100;
+    ASSERT_TRUE(coll1->add(doc.dump(), CREATE).ok());
+
+    std::shared_ptr<http_req> req = std::make_shared<http_req>();
+    std::shared_ptr<http_res> res = std::make_shared<http_res>(nullptr);
+    req->embedded_params_vec.push_back(nlohmann::json::object());
+
+    req->params["collection"] = "coll1";
+    req->params["q"] = "shoes";
+    req->params["query_by"] = "name";
+    req->params["use_cache"] = "true";
+
+    ASSERT_TRUE(get_search(req, res));
+    ASSERT_EQ(1, nlohmann::json::parse(res->body)["found"].get<size_t>());
+
+    const uint64_t generation = coll1->get_write_generation();
+    const uint64_t req_hash = hash_search_request(req);
+
+    // same query with different case, spacing and cache ttl must hit the cache and echo the query as sent
+    req->params["q"] = "  SHOES ";
+    req->params["cache_ttl"] = "120";
+    ASSERT_EQ(req_hash, hash_search_request(req));
+
+    req->params["q"] = "shoe";
+    ASSERT_NE(req_hash, hash_search_request(req));
+
+    req->params["q"] = "  SHOES ";
+    ASSERT_TRUE(get_search(req, res));
+    auto results = nlohmann::json::parse(res->body);
+    ASSERT_EQ(1, results["found"].get<size_t>());
+    ASSERT_EQ("  SHOES ", results["request_params"]["q"].get<std::string>());
+    ASSERT_EQ(generation, coll1->get_write_generation());
+
+    // a write bumps the collection's generation, so the next search is not served from the cache
+    doc["id"] = "1";
+    doc["name"] = "Trail Shoes";
+    doc["points"] = 50;
+    ASSERT_TRUE(coll1->add(doc.dump(), CREATE).ok());
+    ASSERT_LT(generation, coll1->get_write_generation());
+    ASSERT_NE(req_hash, hash_search_request(req));
+
+    ASSERT_TRUE(get_search(req, res));
+    ASSERT_EQ(2, nlohmann::json::parse(res->body)["found"].get<size_t>());
+
+    ASSERT_TRUE(coll1->remove("0").ok());
+    ASSERT_TRUE(get_search(req, res));
+    ASSERT_EQ(1, nlohmann::json::parse(res->body)["found"].get<size_t>());
+
+    // synonym changes bump the generation only once they are applied
+    uint64_t synonym_generation = coll1->get_write_generation();
+    ASSERT_FALSE(coll1->remove_synonym("missing").ok());
+    ASSERT_EQ(synonym_generation, coll1->get_write_generation());
+
+    ASSERT_TRUE(coll1->add_synonym(R"({"id": "syn-1", "synonyms": ["shoes", "sneakers"]})"_json).ok());
+    ASSERT_LT(synonym_generation, coll1->get_write_generation());
+
+    synonym_generation = coll1->get_write_generation();
+    ASSERT_TRUE(coll1->remove_synonym("syn-1").ok());
+    ASSERT_LT(synonym_generation, coll1->get_write_generation());
+
+    // multi search: key order of the search objects does not matter and writes invalidate the cached response
+    req->params.clear();
+    req->params["use_cache"] = "true";
+    req->body = R"({"searches": [{"collection": "coll1", "q": "shoes", "query_by": "name"}]})";
+    const uint64_t multi_req_hash = hash_multi_search_request(req);
+    ASSERT_TRUE(post_multi_search(req, res));
+    ASSERT_EQ(1, nlohmann::json::parse(res->body)["results"][0]["found"].get<size_t>());
+
+    req->params.clear();
+    req->params["use_cache"] = "true";
+    req->body = R"({"searches": [{"query_by": "name", "q": "shoes",   "collection": "coll1"}]})";
+    ASSERT_EQ(multi_req_hash, hash_multi_search_request(req));
+
+    doc["id"] = "2";
+    doc["name"] = "Tennis Shoes";
+    doc["points"] = 10;
+    ASSERT_TRUE(coll1->add(doc.dump(), CREATE).ok());
+
+    req->params.clear();
+    req->params["use_cache"] = "true";
+    req->body = R"({"searches": [{"query_by": "name", "q": "shoes", "collection": "coll1"}]})";
+    ASSERT_NE(multi_req_hash, hash_multi_search_request(req));
+    ASSERT_TRUE(post_multi_search(req, res));
+    ASSERT_EQ(2, nlohmann::json::parse(res->body)["results"][0]["found"].get<size_t>());
+}
+
+TEST_F(CoreAPIUtilsTest, SearchCacheKeyKeepsCaseOfEmbeddedQueries) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "name", "type": "string"},
+            {"name": "embedding", "type":"float[]", "embed":{"from": ["name"], "model_config": {"model_name": "ts/e5-small"}}}
+        ]
+    })"_json;
+
+    EmbedderManager::set_model_dir("/tmp/typesense_test/models");
+    ASSERT_TRUE(collectionManager.create_collection(schema).ok());
+
+    std::shared_ptr<http_req> req = std::make_shared<http_req>();
+    req->embedded_params_vec.push_back(nlohmann::json::object());
+    req->params["collection"] = "coll1";
+    req->params["q"] = "Apple";
+    req->params["use_cache"] = "true";
+
+    // keyword search matches case insensitively
+    req->params["query_by"] = "name";
+    const uint64_t keyword_hash = hash_search_request(req);
+    req->params["q"] = "apple";
+    ASSERT_EQ(keyword_hash, hash_search_request(req));
+
+    // the query is embedded as given, so a query that differs in case gets its own key
+    req->params["query_by"] = "name, embedding";
+    req->params["q"] = "Apple";
+    const uint64_t hybrid_hash = hash_search_request(req);
+    req->params["q"] = "apple";
+    ASSERT_NE(hybrid_hash, hash_search_request(req));
+
+    req->params["query_by"] = "embedding";
+    req->params["q"] = "Apple";
+    const uint64_t semantic_hash = hash_search_request(req);
+    req->params["q"] = "apple";
+    ASSERT_NE(semantic_hash, hash_search_request(req));
+
+    // an embedding field in the query_by of embedded parameters counts too
+    req->params.erase("query_by");
+    req->embedded_params_vec[0]["query_by"] = "embedding";
+    req->params["q"] = "Apple";
+    const uint64_t embedded_params_hash = hash_search_request(req);
+    req->params["q"] = "apple";
+    ASSERT_NE(embedded_params_hash, hash_search_request(req));
+
+    // so does a vector query
+    req->embedded_params_vec[0] = nlohmann::json::object();
+    req->params["query_by"] = "name";
+    req->params["vector_query"] = "embedding:([], k: 10)";
+    req->params["q"] = "Apple";
+    const uint64_t vector_query_hash = hash_search_request(req);
+    req->params["q"] = "apple";
+    ASSERT_NE(vector_query_hash, hash_search_request(req));
+}
+
 TEST_F(CoreAPIUtilsTest, ExportWithFilter) {
     Collection *coll1;
     std::vector<field> fields = {field("title", field_types::STRING, false),
@@ -1758,4 +1915,117 @@ TEST_F(CoreAPIUtilsTest, SynonymsPagination) {
     get_collections(req, resp);
     ASSERT_EQ(400, resp->status_code);
     ASSERT_EQ("{\"message\": \"Limit param should be unsigned integer.\"}", resp->body);
-}
\ No newline at end of file
+}
+
+TEST_F(CoreAPIUtilsTest, CoalescedAddDocumentsMatchSingleAdds) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),};
+
+    collectionManager.create_collection("coll1", 1, fields, "points");
+    collectionManager.create_collection("coll2", 1, fields, "points");
+
+    std::vector<std::string> bodies = {
+        R"({"id": "0", "title": "First", "points": 10})",
+        R"({"id": "1", "title": "Second", "points": 20})",
+        R"({"id": "0", "title": "Repeated", "points": 30})",
+        R"({"id": "2", "title": "Bad points", "points": "abc"})",
+        R"({"id": "3", "title": )",
+        R"({"id": "4", "title": "Last", "points": 40})",
+    };
+
+    std::vector<std::shared_ptr<http_req>> reqs;
+    std::vector<std::shared_ptr<http_res>> ress;
+
+    for(const auto& body: bodies) {
+        std::shared_ptr<http_req> req = std::make_shared<http_req>();
+        req->params["collection"] = "coll1";
+        req->body = body;
+        reqs.push_back(req);
+        ress.push_back(std::make_shared<http_res>(nullptr));
+    }
+
+    post_add_documents_coalesced(reqs, ress);
+
+    // every request gets the response that it would have got on its own
+    for(size_t i = 0; i < bodies.size(); i++) {
+        std::shared_ptr<http_req> req = std::make_shared<http_req>();
+        std::shared_ptr<http_res> res = std::make_shared<http_res>(nullptr);
+        req->params["collection"] = "coll2";
+        req->body = bodies[i];
+        post_add_document(req, res);
+
+        ASSERT_EQ(res->status_code, ress[i]->status_code);
+        ASSERT_EQ(res->body, ress[i]->body);
+    }
+
+    ASSERT_EQ(201, ress[0]->status_code);
+    ASSERT_EQ(409, ress[2]->status_code);
+    ASSERT_EQ(400, ress[3]->status_code);
+    ASSERT_EQ(400, ress[4]->status_code);
+    ASSERT_EQ(201, ress[5]->status_code);
+    ASSERT_EQ(3, collectionManager.get_collection("coll1")->get_num_documents());
+
+    // parameters are shared by the coalesced requests
+    std::shared_ptr<http_req> req = std::make_shared<http_req>();
+    std::shared_ptr<http_res> res = std::make_shared<http_res>(nullptr);
+    req->params["collection"] = "coll1";
+    req->params["action"] = "bad";
+    req->body = bodies[0];
+
+    post_add_documents_coalesced({req, req}, {res, ress[0]});
+    ASSERT_EQ(400, res->status_code);
+    ASSERT_EQ(400, ress[0]->status_code);
+
+    req->params["collection"] = "coll3";
+    req->params["action"] = "upsert";
+    post_add_documents_coalesced({req}, {res});
+    ASSERT_EQ(404, res->status_code);
+
+    // flattened fields of nested documents are not returned
+    for(const std::string& name: {"coll4", "coll5"}) {
+        nlohmann::json schema = R"({
+            "name": "",
+            "enable_nested_fields": true,
+            "fields": [
+                {"name": "details", "type": "object"}
+            ]
+        })"_json;
+        schema["name"] = name;
+        ASSERT_TRUE(collectionManager.create_collection(schema).ok());
+    }
+
+    std::vector<std::string> nested_bodies = {
+        R"({"id": "0", "details": {"name": "First", "tags": ["a", "b"]}})",
+        R"({"id": "1", "details": {"name": "Second", "tags": ["c"]}})",
+    };
+
+    reqs.clear();
+    ress.clear();
+
+    for(const auto& body: nested_bodies) {
+        std::shared_ptr<http_req> nested_req = std::make_shared<http_req>();
+        nested_req->params["collection"] = "coll4";
+        nested_req->body = body;
+        reqs.push_back(nested_req);
+        ress.push_back(std::make_shared<http_res>(nullptr));
+    }
+
+    post_add_documents_coalesced(reqs, ress);
+
+    for(size_t i = 0; i < nested_bodies.size(); i++) {
+        std::shared_ptr<http_req> nested_req = std::make_shared<http_req>();
+        std::shared_ptr<http_res> nested_res = std::make_shared<http_res>(nullptr);
+        nested_req->params["collection"] = "coll5";
+        nested_req->body = nested_bodies[i];
+        post_add_document(nested_req, nested_res);
+
+        ASSERT_EQ(201, ress[i]->status_code);
+        ASSERT_EQ(nested_res->body, ress[i]->body);
+
+        auto added_doc = nlohmann::json::parse(ress[i]->body);
+        ASSERT_EQ(0, added_doc.count(".flat"));
+        ASSERT_EQ(0, added_doc.count("details.name"));
+        ASSERT_EQ(0, added_doc.count("details.tags"));
+        ASSERT_EQ(nlohmann::json::parse(nested_bodies[i])["details"], added_doc["details"]);
+    }
+}
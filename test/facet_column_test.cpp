@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "facet_column.h"
+
+TEST(FacetColumnTest, UpsertLookupAndErase) {
+    facet_column_t column;
+    const uint32_t* facet_ids = nullptr;
+
+    ASSERT_EQ(0, column.num_ids());
+    ASSERT_FALSE(column.contains(0));
+    ASSERT_EQ(0, column.get(0, facet_ids));
+
+    column.upsert(0, {10});
+    column.upsert(3, {20, 30, 20});
+    column.upsert(5000, {40});
+
+    ASSERT_EQ(3, column.num_ids());
+    ASSERT_EQ(1, column.get(0, facet_ids));
+    ASSERT_EQ(10, facet_ids[0]);
+
+    // array elements are kept in order, including repeated values
+    ASSERT_EQ(3, column.get(3, facet_ids));
+    ASSERT_EQ(20, facet_ids[0]);
+    ASSERT_EQ(30, facet_ids[1]);
+    ASSERT_EQ(20, facet_ids[2]);
+
+    ASSERT_EQ(1, column.get(5000, facet_ids));
+    ASSERT_EQ(40, facet_ids[0]);
+    ASSERT_FALSE(column.contains(1));
+    ASSERT_FALSE(column.contains(100000));
+
+    ASSERT_EQ(10, column.get_min_facet_id());
+    ASSERT_EQ(40, column.get_max_facet_id());
+
+    // same and different number of values
+    column.upsert(0, {11});
+    column.upsert(3, {50});
+    ASSERT_EQ(3, column.num_ids());
+    ASSERT_EQ(1, column.get(0, facet_ids));
+    ASSERT_EQ(11, facet_ids[0]);
+    ASSERT_EQ(1, column.get(3, facet_ids));
+    ASSERT_EQ(50, facet_ids[0]);
+
+    column.erase(3);
+    column.erase(4);
+    ASSERT_EQ(2, column.num_ids());
+    ASSERT_FALSE(column.contains(3));
+
+    // upserting no values is the same as erasing
+    column.upsert(0, {});
+    ASSERT_EQ(1, column.num_ids());
+    ASSERT_FALSE(column.contains(0));
+
+    column.clear();
+    ASSERT_EQ(0, column.num_ids());
+    ASSERT_FALSE(column.contains(5000));
+}
+
+TEST(FacetColumnTest, CompactsAfterUpdates) {
+    facet_column_t column;
+
+    for(uint32_t seq_id = 0; seq_id < 10000; seq_id++) {
+        column.upsert(seq_id, {seq_id, seq_id + 1});
+    }
+
+    // every update changes the number of values, so old values pile up until the column is compacted
+    for(size_t round = 0; round < 5; round++) {
+        for(uint32_t seq_id = 0; seq_id < 10000; seq_id++) {
+            if(round % 2 == 0) {
+                column.upsert(seq_id, {seq_id * 2});
+            } else {
+                column.upsert(seq_id, {seq_id, seq_id * 3, seq_id * 5});
+            }
+        }
+    }
+
+    for(uint32_t seq_id = 0; seq_id < 10000; seq_id += 3) {
+        column.erase(seq_id);
+    }
+
+    ASSERT_EQ(6666, column.num_ids());
+
+    for(uint32_t seq_id = 0; seq_id < 10000; seq_id++) {
+        const uint32_t* facet_ids = nullptr;
+        if(seq_id % 3 == 0) {
+            ASSERT_EQ(0, column.get(seq_id, facet_ids));
+        } else {
+            ASSERT_EQ(1, column.get(seq_id, facet_ids));
+            ASSERT_EQ(seq_id * 2, facet_ids[0]);
+        }
+    }
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "facet_index.h"
+#include "threadpool.h"
 
 TEST(FacetIndexTest, FacetValueDeletionString) {
     facet_index_t findex;
@@ -630,3 +631,239 @@ TEST(FacetIndexTest, DecrementSingleCount) {
     ASSERT_EQ(std::next(count_list.begin(), 2), count_map[5]);
     ASSERT_EQ(std::next(count_list.begin(), 3), count_map[4]);
 }
+
+TEST(FacetIndexTest, IntersectWithResultBitmap) {
+    facet_index_t findex;
+    findex.initialize("brand");
+
+    std::unordered_map<facet_value_id_t, std::vector<uint32_t>, facet_value_id_t::Hash> fvalue_to_seq_ids;
+    std::unordered_map<uint32_t, std::vector<facet_value_id_t>> seq_id_to_fvalues;
+
+    // value `i` is held by every seq_id that is `i` modulo 20: a mix of full and compact id lists
+    const size_t num_values = 20;
+    const size_t num_docs = 2000;
+
+    for(uint32_t seq_id = 0; seq_id < num_docs; seq_id++) {
+        // the last few values are held only by a handful of documents
+        const size_t value_index = (seq_id >= 1000 && seq_id % num_values >= 15) ? 0 : seq_id % num_values;
+        facet_value_id_t fvalue("brand" + std::to_string(value_index), value_index + 1);
+        fvalue_to_seq_ids[fvalue].push_back(seq_id);
+        seq_id_to_fvalues[seq_id] = {fvalue};
+    }
+
+    findex.insert("brand", fvalue_to_seq_ids, seq_id_to_fvalues, true);
+
+    std::vector<uint32_t> result_ids;
+    for(uint32_t seq_id = 0; seq_id < num_docs; seq_id += 3) {
+        result_ids.push_back(seq_id);
+    }
+
+    // merging against every value costs more than a bitmap, so the result ids get materialized after a few values
+    ASSERT_LT(facet_index_t::result_bitmap_cost(result_ids.data(), result_ids.size()), result_ids.size() * 2);
+
+    field brandf("brand", field_types::STRING, true);
+    facet a_facet("brand", 0);
+    std::map<std::string, docid_count_t> found;
+
+    findex.intersect(a_facet, brandf, false, false, 1, {}, {}, {}, result_ids.data(), result_ids.size(),
+                     num_values, found, false);
+
+    ASSERT_EQ(num_values, found.size());
+
+    std::map<std::string, uint32_t> expected_counts;
+    for(auto seq_id: result_ids) {
+        const size_t value_index = (seq_id >= 1000 && seq_id % num_values >= 15) ? 0 : seq_id % num_values;
+        expected_counts["brand" + std::to_string(value_index)]++;
+    }
+
+    for(const auto& kv: expected_counts) {
+        ASSERT_EQ(kv.second, found[kv.first].count) << kv.first;
+    }
+
+    // results that are too sparse within the seq_id space are never materialized
+    std::vector<uint32_t> sparse_result_ids = {1, 100000};
+    ASSERT_EQ(SIZE_MAX, facet_index_t::result_bitmap_cost(sparse_result_ids.data(), sparse_result_ids.size()));
+}
+
+TEST(FacetIndexTest, ValueIndexCostEstimate) {
+    facet_index_t findex;
+    findex.initialize("category");
+
+    std::unordered_map<facet_value_id_t, std::vector<uint32_t>, facet_value_id_t::Hash> fvalue_to_seq_ids;
+    std::unordered_map<uint32_t, std::vector<facet_value_id_t>> seq_id_to_fvalues;
+
+    // 4 values spread over 10K documents
+    const size_t num_docs = 10000;
+    for(uint32_t seq_id = 0; seq_id < num_docs; seq_id++) {
+        facet_value_id_t fvalue("category" + std::to_string(seq_id % 4), (seq_id % 4) + 1);
+        fvalue_to_seq_ids[fvalue].push_back(seq_id);
+        seq_id_to_fvalues[seq_id] = {fvalue};
+    }
+
+    findex.insert("category", fvalue_to_seq_ids, seq_id_to_fvalues, true);
+
+    // most of the documents match: walking 4 id lists beats looking up the facet hashes of every result
+    std::vector<uint32_t> result_ids;
+    for(uint32_t seq_id = 0; seq_id < num_docs; seq_id += 2) {
+        result_ids.push_back(seq_id);
+    }
+
+    ASSERT_TRUE(findex.is_value_index_cheaper("category", result_ids.data(), result_ids.size(), 10, num_docs));
+
+    // only a handful of documents match: the id lists are far longer than the results
+    std::vector<uint32_t> few_result_ids = {10, 20, 30};
+    ASSERT_FALSE(findex.is_value_index_cheaper("category", few_result_ids.data(), few_result_ids.size(), 10, num_docs));
+
+    ASSERT_FALSE(findex.is_value_index_cheaper("unknown", result_ids.data(), result_ids.size(), 10, num_docs));
+}
+
+TEST(FacetIndexTest, CountChangesAreOrderedOnRead) {
+    facet_index_t findex;
+    findex.initialize("brand");
+    field brandf("brand", field_types::STRING, true);
+
+    // value `i` is held by `i + 1` documents, so the count list is ordered from the last value to the first
+    const size_t num_values = 2000;
+    uint32_t next_seq_id = 0;
+
+    std::unordered_map<facet_value_id_t, std::vector<uint32_t>, facet_value_id_t::Hash> fvalue_to_seq_ids;
+    std::unordered_map<uint32_t, std::vector<facet_value_id_t>> seq_id_to_fvalues;
+
+    for(size_t i = 0; i < num_values; i++) {
+        facet_value_id_t fvalue("brand" + std::to_string(i));
+        for(size_t j = 0; j <= i; j++) {
+            fvalue_to_seq_ids[fvalue].push_back(next_seq_id);
+            seq_id_to_fvalues[next_seq_id] = {fvalue};
+            next_seq_id++;
+        }
+    }
+
+    findex.insert("brand", fvalue_to_seq_ids, seq_id_to_fvalues, true);
+
+    auto top_values = [&](size_t k) {
+        facet a_facet("brand", 0);
+        std::map<std::string, docid_count_t> found;
+        uint32_t result_ids[] = {0};
+        findex.intersect(a_facet, brandf, false, false, 1, {}, {}, {}, result_ids, 1, k, found, true);
+        return found;
+    };
+
+    auto found = top_values(2);
+    ASSERT_EQ(2, found.size());
+    ASSERT_EQ(2000, found["brand1999"].count);
+    ASSERT_EQ(1999, found["brand1998"].count);
+
+    // a few values jump to the top of the list: their nodes are moved one by one when the counts are read
+    auto add_docs = [&](const std::vector<size_t>& value_indices, size_t num_docs) {
+        fvalue_to_seq_ids.clear();
+        seq_id_to_fvalues.clear();
+
+        for(auto i: value_indices) {
+            facet_value_id_t fvalue("brand" + std::to_string(i));
+            for(size_t j = 0; j < num_docs; j++) {
+                fvalue_to_seq_ids[fvalue].push_back(next_seq_id);
+                seq_id_to_fvalues[next_seq_id] = {fvalue};
+                next_seq_id++;
+            }
+        }
+
+        findex.insert("brand", fvalue_to_seq_ids, seq_id_to_fvalues, true);
+    };
+
+    add_docs({5, 10}, 5000);
+    ASSERT_EQ(5006, findex.facet_node_count("brand", "brand5"));
+
+    found = top_values(2);
+    ASSERT_EQ(2, found.size());
+    ASSERT_EQ(5006, found["brand5"].count);
+    ASSERT_EQ(5011, found["brand10"].count);
+
+    // most of the values change: the whole list is sorted again
+    std::vector<size_t> value_indices;
+    for(size_t i = 0; i < 1500; i++) {
+        value_indices.push_back(i);
+    }
+
+    add_docs(value_indices, 3);
+
+    // a deleted document is reflected right away
+    nlohmann::json doc;
+    doc["brand"] = "brand1999";
+    findex.remove(doc, brandf, num_values * (num_values + 1) / 2 - 1);
+
+    found = top_values(4);
+    ASSERT_EQ(4, found.size());
+    ASSERT_EQ(5014, found["brand10"].count);
+    ASSERT_EQ(5009, found["brand5"].count);
+    ASSERT_EQ(1999, found["brand1999"].count);
+    ASSERT_EQ(1999, found["brand1998"].count);
+    ASSERT_EQ(1999, findex.facet_val_num_ids("brand", "brand1999"));
+}
+
+TEST(FacetIndexTest, IntersectWithMultipleTasks) {
+    facet_index_t findex;
+    findex.initialize("brand");
+    field brandf("brand", field_types::STRING, true);
+
+    std::unordered_map<facet_value_id_t, std::vector<uint32_t>, facet_value_id_t::Hash> fvalue_to_seq_ids;
+    std::unordered_map<uint32_t, std::vector<facet_value_id_t>> seq_id_to_fvalues;
+
+    // value `i` is held by `i + 1` consecutive documents
+    const size_t num_values = 500;
+    uint32_t next_seq_id = 0;
+
+    for(size_t i = 0; i < num_values; i++) {
+        facet_value_id_t fvalue("brand" + std::to_string(i), i + 1);
+        for(size_t j = 0; j <= i; j++) {
+            fvalue_to_seq_ids[fvalue].push_back(next_seq_id);
+            seq_id_to_fvalues[next_seq_id] = {fvalue};
+            next_seq_id++;
+        }
+    }
+
+    findex.insert("brand", fvalue_to_seq_ids, seq_id_to_fvalues, true);
+
+    // only the less frequent values match, so the walk passes over many values with no results
+    std::vector<uint32_t> result_ids;
+    for(uint32_t seq_id = 0; seq_id < 40000; seq_id += 3) {
+        result_ids.push_back(seq_id);
+    }
+
+    ThreadPool pool(4);
+
+    for(const std::string sort_order: {"", "asc", "desc"}) {
+        for(size_t max_facet_count: {5, 100, 1000}) {
+            for(bool has_facet_query: {false, true}) {
+                std::vector<std::vector<std::string>> searched_tokens = {{"brand1"}};
+
+                facet single_task_facet("brand", 0);
+                std::map<std::string, docid_count_t> single_task_found;
+                findex.intersect(single_task_facet, brandf, has_facet_query, false, 1, searched_tokens, {}, {},
+                                 result_ids.data(), result_ids.size(), max_facet_count, single_task_found,
+                                 false, sort_order);
+
+                facet multi_task_facet("brand", 0);
+                std::map<std::string, docid_count_t> multi_task_found;
+                findex.intersect(multi_task_facet, brandf, has_facet_query, false, 1, searched_tokens, {}, {},
+                                 result_ids.data(), result_ids.size(), max_facet_count, multi_task_found,
+                                 false, sort_order, &pool, 4);
+
+                ASSERT_FALSE(single_task_found.empty());
+                ASSERT_EQ(single_task_found.size(), multi_task_found.size());
+
+                for(const auto& kv: single_task_found) {
+                    ASSERT_EQ(1, multi_task_found.count(kv.first)) << kv.first;
+                    ASSERT_EQ(kv.second.count, multi_task_found[kv.first].count) << kv.first;
+                    ASSERT_EQ(kv.second.doc_id, multi_task_found[kv.first].doc_id) << kv.first;
+                }
+
+                ASSERT_EQ(single_task_facet.fvalue_tokens.size(), multi_task_facet.fvalue_tokens.size());
+                for(const auto& kv: single_task_facet.fvalue_tokens) {
+                    ASSERT_EQ(1, multi_task_facet.fvalue_tokens.count(kv.first)) << kv.first;
+                }
+            }
+        }
+    }
+
+    pool.shutdown();
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "field_locks.h"
+#include "filter.h"
+
+TEST(FieldLocksTest, ReadersWaitOnlyForTheFieldsTheyRead) {
+    field_locks_t locks;
+
+    std::string other_field = "points";
+    for(size_t i = 0; field_locks_t::get_stripe(other_field) == field_locks_t::get_stripe("title"); i++) {
+        other_field = "points" + std::to_string(i);
+    }
+
+    auto title_lock = locks.lock_field("title");
+
+    // a reader of another field is not held up by the write
+    std::thread other_reader([&]() {
+        field_locks_t::shared_lock_t lock(locks, field_locks_t::stripes_of(other_field));
+    });
+
+    other_reader.join();
+
+    std::atomic<bool> title_read{false};
+    std::thread title_reader([&]() {
+        field_locks_t::stripe_set_t stripes = field_locks_t::stripes_of(other_field);
+        field_locks_t::add_field("title", stripes);
+        field_locks_t::shared_lock_t lock(locks, stripes);
+        title_read = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_FALSE(title_read);
+
+    title_lock.unlock();
+    title_reader.join();
+    ASSERT_TRUE(title_read);
+}
+
+TEST(FieldLocksTest, FilterFields) {
+    filter title_filter;
+    title_filter.field_name = "title";
+
+    filter points_filter;
+    points_filter.field_name = "points";
+
+    auto filter_tree = new filter_node_t(AND, new filter_node_t(title_filter), new filter_node_t(points_filter));
+
+    field_locks_t::stripe_set_t stripes;
+    ASSERT_TRUE(field_locks_t::add_filter_fields(filter_tree, stripes));
+    ASSERT_TRUE(stripes.test(field_locks_t::get_stripe("title")));
+    ASSERT_TRUE(stripes.test(field_locks_t::get_stripe("points")));
+    delete filter_tree;
+
+    // fields read by a join are not known up front
+    filter join_filter;
+    join_filter.referenced_collection_name = "Customers";
+    filter_tree = new filter_node_t(OR, new filter_node_t(title_filter), new filter_node_t(join_filter));
+    ASSERT_FALSE(field_locks_t::add_filter_fields(filter_tree, stripes));
+    delete filter_tree;
+
+    ASSERT_TRUE(field_locks_t::add_filter_fields(nullptr, stripes));
+}
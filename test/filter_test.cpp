@@ -863,3 +863,164 @@ TEST_F(FilterTest, FilterTreeIteratorTimeout) {
     ASSERT_EQ(count, result->count); // With `override_timeout` true, we should get result.
     delete result;
 }
+
+TEST_F(FilterTest, FilterResultCache) {
+    nlohmann::json schema =
+            R"({
+                "name": "Collection",
+                "fields": [
+                    {"name": "tenant_id", "type": "string", "optional": true},
+                    {"name": "is_public", "type": "bool"},
+                    {"name": "points", "type": "int32"}
+                ]
+            })"_json;
+
+    Collection* coll = collectionManager.create_collection(schema).get();
+
+    for (size_t i = 0; i < 10; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["tenant_id"] = (i % 2 == 0) ? "t1" : "t2";
+        doc["is_public"] = (i < 6);
+        doc["points"] = i;
+        ASSERT_TRUE(coll->add(doc.dump()).ok());
+    }
+
+    const std::string doc_id_prefix = std::to_string(coll->get_collection_id()) + "_" + Collection::DOC_ID_PREFIX + "_";
+    auto const& filter_cache = coll->_get_index()->_get_filter_cache();
+
+    auto get_filter_ids = [&](const std::string& filter_query, bool& cache_hit) {
+        filter_node_t* filter_tree_root = nullptr;
+        auto filter_op = filter::parse_filter_query(filter_query, coll->get_schema(), store, doc_id_prefix,
+                                                    filter_tree_root);
+        std::unique_ptr<filter_node_t> filter_tree_guard(filter_tree_root);
+        EXPECT_TRUE(filter_op.ok());
+
+        auto iter = filter_result_iterator_t(coll->get_name(), coll->_get_index(), filter_tree_root);
+        EXPECT_TRUE(iter.init_status().ok());
+
+        // a cached subtree is available right away, without computing the iterator tree
+        cache_hit = iter._get_is_filter_result_initialized();
+        iter.compute_iterators();
+
+        std::vector<uint32_t> ids;
+        while (iter.validity == filter_result_iterator_t::valid) {
+            ids.push_back(iter.seq_id);
+            iter.next();
+        }
+
+        return ids;
+    };
+
+    bool cache_hit;
+    std::vector<uint32_t> expected = {0, 2, 4};
+    ASSERT_EQ(expected, get_filter_ids("tenant_id:= t1 && is_public: true", cache_hit));
+    ASSERT_FALSE(cache_hit);
+
+    // only the whole filter is cached: its operands match too few ids to be worth caching on their own
+    ASSERT_EQ(1, filter_cache.size());
+
+    // operands of the AND are ordered when building the cache key
+    ASSERT_EQ(expected, get_filter_ids("is_public: true && tenant_id:= t1", cache_hit));
+    ASSERT_TRUE(cache_hit);
+
+    // deleted documents are dropped from the cached ids
+    ASSERT_TRUE(coll->remove("2").ok());
+    expected = {0, 4};
+    ASSERT_EQ(expected, get_filter_ids("tenant_id:= t1 && is_public: true", cache_hit));
+    ASSERT_TRUE(cache_hit);
+
+    // writing to a filtered field evicts the entries depending on it
+    nlohmann::json doc;
+    doc["id"] = "10";
+    doc["tenant_id"] = "t1";
+    doc["is_public"] = true;
+    doc["points"] = 10;
+    ASSERT_TRUE(coll->add(doc.dump()).ok());
+
+    expected = {0, 4, 10};
+    ASSERT_EQ(expected, get_filter_ids("tenant_id:= t1 && is_public: true", cache_hit));
+    ASSERT_FALSE(cache_hit);
+
+    ASSERT_TRUE(coll->add(R"({"id": "4", "is_public": false})", UPDATE).ok());
+    expected = {0, 10};
+    ASSERT_EQ(expected, get_filter_ids("tenant_id:= t1 && is_public: true", cache_hit));
+    ASSERT_FALSE(cache_hit);
+
+    // entries on fields that were not written to stay cached
+    expected = {5, 6, 7, 8, 9, 10};
+    ASSERT_EQ(expected, get_filter_ids("points:>= 5", cache_hit));
+    ASSERT_TRUE(coll->add(R"({"id": "0", "tenant_id": "t3"})", UPDATE).ok());
+    ASSERT_EQ(expected, get_filter_ids("points:>= 5", cache_hit));
+    ASSERT_TRUE(cache_hit);
+
+    // negated filters also match documents that lack the field, so any new document evicts them
+    expected = {0, 1, 3, 5, 7, 9};
+    ASSERT_EQ(expected, get_filter_ids("tenant_id:!= t1", cache_hit));
+    ASSERT_EQ(expected, get_filter_ids("tenant_id:!= t1", cache_hit));
+    ASSERT_TRUE(cache_hit);
+
+    ASSERT_TRUE(coll->add(R"({"id": "11", "is_public": false, "points": 0})").ok());
+    expected = {0, 1, 3, 5, 7, 9, 11};
+    ASSERT_EQ(expected, get_filter_ids("tenant_id:!= t1", cache_hit));
+    ASSERT_FALSE(cache_hit);
+}
+
+TEST_F(FilterTest, FilterResultCacheBoundedByBytes) {
+    filter_result_cache_t cache(64 * 1024);
+
+    auto get_cache_key = [](const std::string& key) {
+        filter_cache_key_t cache_key;
+        cache_key.key = key;
+        cache_key.fields = {"field"};
+        return cache_key;
+    };
+
+    auto is_cached = [&](const std::string& key) {
+        uint32_t* ids = nullptr;
+        uint32_t ids_length = 0;
+        bool found = cache.find(key, ids, ids_length);
+        delete [] ids;
+        return found;
+    };
+
+    // an entry that would take up more than its share of the cache is not admitted
+    std::vector<uint32_t> huge_ids;
+    for (uint32_t i = 0; i < 100000; i++) {
+        huge_ids.push_back(i * 7919);
+    }
+
+    cache.insert(get_cache_key("huge"), huge_ids.data(), huge_ids.size());
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(0, cache.get_num_bytes());
+
+    std::vector<uint32_t> small_ids;
+    for (uint32_t i = 0; i < 100; i++) {
+        small_ids.push_back(i);
+    }
+
+    // least recently used entries are evicted to stay within the bytes of the cache
+    for (size_t i = 0; i < 1000; i++) {
+        cache.insert(get_cache_key("small_" + std::to_string(i)), small_ids.data(), small_ids.size());
+        ASSERT_TRUE(is_cached("small_0"));
+        ASSERT_LE(cache.get_num_bytes(), 64 * 1024);
+    }
+
+    ASSERT_LT(10, cache.size());
+    ASSERT_GT(1000, cache.size());
+    ASSERT_TRUE(is_cached("small_999"));
+    ASSERT_FALSE(is_cached("small_1"));
+
+    // deleted ids shrink the entries that they are dropped from
+    const size_t num_bytes = cache.get_num_bytes();
+    for (uint32_t i = 0; i < 90; i++) {
+        cache.remove_id(i);
+    }
+
+    ASSERT_TRUE(is_cached("small_999"));
+    ASSERT_GT(num_bytes, cache.get_num_bytes());
+
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(0, cache.get_num_bytes());
+}
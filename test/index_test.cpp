@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "index.h"
 #include <vector>
+#include <cmath>
+#include <algorithm>
 #include <s2/s2loop.h>
 
 /*TEST(IndexTest, PointInPolygon180thMeridian) {
@@ -68,3 +70,171 @@ TEST(IndexTest, GeoPointPackUnpack) {
         ASSERT_FLOAT_EQ(latlng.second, s2LatLng.lng().degrees());
     }
 }
+
+TEST(IndexTest, PlanFilteredVectorSearch) {
+    // nothing to filter on or to search in
+    auto plan = Index::plan_filtered_vector_search(0, 1000, 10, 10);
+    ASSERT_EQ(vector_search_plan_t::flat, plan.strategy);
+    plan = Index::plan_filtered_vector_search(10, 0, 10, 10);
+    ASSERT_EQ(vector_search_plan_t::flat, plan.strategy);
+
+    // very selective filter: computing the distance of every filtered id is cheaper than walking the graph
+    plan = Index::plan_filtered_vector_search(10000, 10000000, 10, 10);
+    ASSERT_EQ(vector_search_plan_t::flat, plan.strategy);
+    ASSERT_EQ(10000, plan.ef);
+
+    // moderately selective filter: graph search on the materialized ids, with ef widened by the inverse of the
+    // selectivity
+    plan = Index::plan_filtered_vector_search(500000, 10000000, 10, 10);
+    ASSERT_EQ(vector_search_plan_t::ids_filtered_hnsw, plan.strategy);
+    ASSERT_EQ(200, plan.ef);
+
+    // broad filter: the filter iterator is checked during the graph search
+    plan = Index::plan_filtered_vector_search(6000000, 10000000, 10, 10);
+    ASSERT_EQ(vector_search_plan_t::iterator_filtered_hnsw, plan.strategy);
+    ASSERT_EQ(17, plan.ef);
+
+    // the filter's upper bound can exceed the number of vectors
+    plan = Index::plan_filtered_vector_search(20000000, 10000000, 20, 10);
+    ASSERT_EQ(vector_search_plan_t::iterator_filtered_hnsw, plan.strategy);
+    ASSERT_EQ(20, plan.ef);
+}
+
+namespace {
+    // unit vectors spread evenly on a circle, so that the nearest neighbours of a query are the ones closest in angle
+    std::vector<float> circle_vector(double position, size_t num_vectors) {
+        const double angle = 2 * M_PI * position / num_vectors;
+        return {float(std::cos(angle)), float(std::sin(angle))};
+    }
+
+    // nearest neighbours among `ids` minus `excluded_ids`, by brute force
+    std::vector<size_t> exact_neighbours(hnsw_index_t& index, const std::vector<float>& query,
+                                         const std::vector<uint32_t>& ids, const std::vector<uint32_t>& excluded_ids,
+                                         size_t k) {
+        std::vector<std::pair<float, size_t>> dists;
+        for(auto id: ids) {
+            if(std::find(excluded_ids.begin(), excluded_ids.end(), id) != excluded_ids.end()) {
+                continue;
+            }
+
+            auto values = index.get_vector(id);
+            dists.emplace_back(1.0f - (query[0] * values[0] + query[1] * values[1]), id);
+        }
+
+        std::sort(dists.begin(), dists.end());
+
+        std::vector<size_t> neighbours;
+        for(size_t i = 0; i < std::min(k, dists.size()); i++) {
+            neighbours.push_back(dists[i].second);
+        }
+
+        return neighbours;
+    }
+
+    std::vector<size_t> search_filtered(hnsw_index_t& index, const std::vector<float>& query,
+                                        const std::vector<uint32_t>& ids, const std::vector<uint32_t>& excluded_ids,
+                                        size_t k, size_t ef) {
+        // the iterator takes over the ids
+        auto filter_ids = new uint32_t[ids.size()];
+        std::copy(ids.begin(), ids.end(), filter_ids);
+        filter_result_iterator_t filter_result_iterator(filter_ids, ids.size());
+
+        bool search_cutoff = false;
+        auto results = Index::search_filtered_vectors(&index, query.data(), k, ef, &filter_result_iterator,
+                                                      excluded_ids.data(), excluded_ids.size(), search_cutoff);
+
+        std::vector<size_t> neighbours;
+        for(const auto& result: results) {
+            neighbours.push_back(result.second);
+        }
+
+        return neighbours;
+    }
+}
+
+TEST(IndexTest, FilteredVectorSearchStrategies) {
+    const size_t num_vectors = 20000, k = 10, ef = 10;
+    hnsw_index_t index(2, num_vectors, cosine);
+
+    for(size_t i = 0; i < num_vectors; i++) {
+        index.add_point(circle_vector(i, num_vectors).data(), i);
+    }
+
+    // in between two vectors, so that no two of them are equally close
+    const auto query = circle_vector(1000.3, num_vectors);
+
+    std::vector<uint32_t> even_ids, every_4th_id, every_100th_id;
+    for(uint32_t i = 0; i < num_vectors; i++) {
+        if(i % 2 == 0) {
+            even_ids.push_back(i);
+        }
+
+        if(i % 4 == 0) {
+            every_4th_id.push_back(i);
+        }
+
+        if(i % 100 == 0) {
+            every_100th_id.push_back(i);
+        }
+    }
+
+    ASSERT_EQ(vector_search_plan_t::iterator_filtered_hnsw,
+              Index::plan_filtered_vector_search(even_ids.size(), num_vectors, k, ef).strategy);
+    ASSERT_EQ(vector_search_plan_t::ids_filtered_hnsw,
+              Index::plan_filtered_vector_search(every_4th_id.size(), num_vectors, k, ef).strategy);
+    ASSERT_EQ(vector_search_plan_t::flat,
+              Index::plan_filtered_vector_search(every_100th_id.size(), num_vectors, k, ef).strategy);
+
+    // every strategy finds the same neighbours as an exact search over the filtered vectors
+    for(const auto& ids: {even_ids, every_4th_id, every_100th_id}) {
+        auto neighbours = search_filtered(index, query, ids, {}, k, ef);
+        ASSERT_EQ(exact_neighbours(index, query, ids, {}, k), neighbours);
+        ASSERT_EQ(k, neighbours.size());
+    }
+
+    // ids excluded by a hybrid search are left out when the filter is materialized too
+    const std::vector<uint32_t> excluded_ids = {900, 1000, 1004, 1100};
+
+    auto neighbours = search_filtered(index, query, every_4th_id, excluded_ids, k, ef);
+    ASSERT_EQ(exact_neighbours(index, query, every_4th_id, excluded_ids, k), neighbours);
+    ASSERT_EQ(neighbours.end(), std::find(neighbours.begin(), neighbours.end(), 1000));
+    ASSERT_EQ(neighbours.end(), std::find(neighbours.begin(), neighbours.end(), 1004));
+
+    neighbours = search_filtered(index, query, every_100th_id, excluded_ids, k, ef);
+    ASSERT_EQ(exact_neighbours(index, query, every_100th_id, excluded_ids, k), neighbours);
+    ASSERT_EQ(neighbours.end(), std::find(neighbours.begin(), neighbours.end(), 900));
+    ASSERT_EQ(neighbours.end(), std::find(neighbours.begin(), neighbours.end(), 1000));
+    ASSERT_EQ(neighbours.end(), std::find(neighbours.begin(), neighbours.end(), 1100));
+    ASSERT_EQ(k, neighbours.size());
+}
+
+TEST(IndexTest, VectorFilterIdsFunctor) {
+    // dense ids are looked up in a bitset that starts at the first id
+    const std::vector<uint32_t> dense_ids = {500000000, 500000001, 500000063, 500000064, 500000200};
+    VectorFilterIdsFunctor dense_functor(dense_ids.data(), dense_ids.size());
+
+    for(auto id: dense_ids) {
+        ASSERT_TRUE(dense_functor(id));
+    }
+
+    ASSERT_FALSE(dense_functor(0));
+    ASSERT_FALSE(dense_functor(499999999));
+    ASSERT_FALSE(dense_functor(500000002));
+    ASSERT_FALSE(dense_functor(500000201));
+    ASSERT_FALSE(dense_functor(600000000));
+
+    // sparse ids are binary searched
+    const std::vector<uint32_t> sparse_ids = {5, 1000000, 500000000};
+    VectorFilterIdsFunctor sparse_functor(sparse_ids.data(), sparse_ids.size());
+
+    for(auto id: sparse_ids) {
+        ASSERT_TRUE(sparse_functor(id));
+    }
+
+    ASSERT_FALSE(sparse_functor(0));
+    ASSERT_FALSE(sparse_functor(6));
+    ASSERT_FALSE(sparse_functor(500000001));
+
+    VectorFilterIdsFunctor empty_functor(nullptr, 0);
+    ASSERT_FALSE(empty_functor(0));
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include <future>
+#include <thread>
+#include <vector>
+#include "inference_batcher.h"
+
+namespace {
+    // the first token identifies the input, the length decides how it is batched
+    encoded_input_t make_input(int64_t tag, size_t len) {
+        encoded_input_t encoded_input;
+        encoded_input.input_ids.assign(len, tag);
+        encoded_input.attention_mask.assign(len, 1);
+        return encoded_input;
+    }
+
+    // embeds an input as its tag and length
+    void embed_batch(const std::vector<inference_batcher_t::inference_t*>& batch) {
+        for(auto inference: batch) {
+            const auto& input_ids = inference->encoded_input.input_ids;
+            inference->result = embedding_res_t(std::vector<float>{float(input_ids[0]), float(input_ids.size())});
+        }
+    }
+}
+
+class InferenceBatcherTest : public ::testing::Test {
+protected:
+    std::mutex batches_mutex;
+    std::vector<size_t> batch_sizes;
+
+    // the first batch is held until `gate` is opened, so that the inputs of the other callers queue up behind it
+    std::promise<void> gate;
+    std::shared_future<void> gate_future = gate.get_future().share();
+    bool first_batch = true;
+
+    void hold_first_batch() {
+        {
+            std::lock_guard<std::mutex> lk(batches_mutex);
+            if(!first_batch) {
+                return ;
+            }
+            first_batch = false;
+        }
+
+        gate_future.wait();
+    }
+
+    void record_batch(const std::vector<inference_batcher_t::inference_t*>& batch) {
+        std::lock_guard<std::mutex> lk(batches_mutex);
+        batch_sizes.push_back(batch.size());
+    }
+
+    // starts a caller that holds the first batch, and callers of the inputs made by `make_inputs` behind it
+    std::vector<std::vector<embedding_res_t>> infer_behind_first_batch(
+            inference_batcher_t& batcher, size_t num_callers,
+            const std::function<std::vector<encoded_input_t>(size_t)>& make_inputs) {
+        std::vector<std::vector<embedding_res_t>> results(num_callers + 1);
+        std::vector<std::thread> callers;
+
+        callers.emplace_back([&]() {
+            std::vector<encoded_input_t> inputs;
+            inputs.push_back(make_input(-1, 4));
+            results[0] = batcher.infer(std::move(inputs));
+        });
+
+        while(true) {
+            std::lock_guard<std::mutex> lk(batches_mutex);
+            if(!first_batch) {
+                break;
+            }
+        }
+
+        for(size_t i = 0; i < num_callers; i++) {
+            callers.emplace_back([&, i]() {
+                results[i + 1] = batcher.infer(make_inputs(i));
+            });
+        }
+
+        // give the callers time to queue their inputs
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        gate.set_value();
+
+        for(auto& caller: callers) {
+            caller.join();
+        }
+
+        return results;
+    }
+};
+
+TEST_F(InferenceBatcherTest, ConcurrentCallersShareBatches) {
+    inference_batcher_t batcher([&](const std::vector<inference_batcher_t::inference_t*>& batch) {
+        record_batch(batch);
+        hold_first_batch();
+        embed_batch(batch);
+    }, 1);
+
+    auto results = infer_behind_first_batch(batcher, 100, [](size_t i) {
+        std::vector<encoded_input_t> inputs;
+        inputs.push_back(make_input(i, 4));
+        return inputs;
+    });
+
+    // the queued inputs are merged into batches of up to the maximum batch size
+    ASSERT_EQ(3, batch_sizes.size());
+    ASSERT_EQ(1, batch_sizes[0]);
+    ASSERT_EQ(inference_batcher_t::MAX_BATCH_SIZE, batch_sizes[1]);
+    ASSERT_EQ(100 - inference_batcher_t::MAX_BATCH_SIZE, batch_sizes[2]);
+
+    for(size_t i = 0; i < 100; i++) {
+        ASSERT_EQ(1, results[i + 1].size());
+        ASSERT_TRUE(results[i + 1][0].success);
+        ASSERT_EQ(float(i), results[i + 1][0].embedding[0]);
+    }
+
+    auto stats = batcher.get_stats();
+    ASSERT_EQ(3, stats["num_batches"].get<size_t>());
+    ASSERT_EQ(101, stats["num_inputs"].get<size_t>());
+    ASSERT_DOUBLE_EQ(101.0 / 3, stats["avg_batch_size"].get<double>());
+
+    // the inputs that were queued behind the first batch waited for it
+    ASSERT_LT(0, stats["avg_queue_wait_ms"].get<double>());
+    ASSERT_LE(0, stats["avg_run_ms"].get<double>());
+}
+
+TEST_F(InferenceBatcherTest, BatchesAreBoundedByTokens) {
+    inference_batcher_t batcher([&](const std::vector<inference_batcher_t::inference_t*>& batch) {
+        record_batch(batch);
+        hold_first_batch();
+        embed_batch(batch);
+    }, 1);
+
+    // only 4 of these inputs fit within the tokens of a batch
+    const size_t long_len = inference_batcher_t::MAX_BATCH_TOKENS / 4;
+
+    infer_behind_first_batch(batcher, 10, [&](size_t i) {
+        std::vector<encoded_input_t> inputs;
+        inputs.push_back(make_input(i, long_len));
+        return inputs;
+    });
+
+    std::vector<size_t> expected_batch_sizes = {1, 4, 4, 2};
+    ASSERT_EQ(expected_batch_sizes, batch_sizes);
+}
+
+TEST_F(InferenceBatcherTest, ResultsGoBackToTheirCallersInOrder) {
+    inference_batcher_t batcher([&](const std::vector<inference_batcher_t::inference_t*>& batch) {
+        record_batch(batch);
+        hold_first_batch();
+        embed_batch(batch);
+    }, 2);
+
+    // inputs of varying lengths, which are batched out of their order
+    auto results = infer_behind_first_batch(batcher, 20, [](size_t i) {
+        std::vector<encoded_input_t> inputs;
+        for(size_t j = 0; j < 10; j++) {
+            inputs.push_back(make_input(i * 100 + j, 1 + (i * 7 + j * 13) % 50));
+        }
+        return inputs;
+    });
+
+    for(size_t i = 0; i < 20; i++) {
+        ASSERT_EQ(10, results[i + 1].size());
+
+        for(size_t j = 0; j < 10; j++) {
+            ASSERT_TRUE(results[i + 1][j].success);
+            ASSERT_EQ(float(i * 100 + j), results[i + 1][j].embedding[0]);
+            ASSERT_EQ(float(1 + (i * 7 + j * 13) % 50), results[i + 1][j].embedding[1]);
+        }
+    }
+
+    ASSERT_EQ(201, batcher.get_stats()["num_inputs"].get<size_t>());
+}
+
+TEST_F(InferenceBatcherTest, BatchErrorReachesEveryCaller) {
+    const int64_t bad_tag = 5;
+
+    inference_batcher_t batcher([&](const std::vector<inference_batcher_t::inference_t*>& batch) {
+        record_batch(batch);
+        hold_first_batch();
+
+        for(auto inference: batch) {
+            if(inference->encoded_input.input_ids[0] == bad_tag) {
+                for(auto batch_inference: batch) {
+                    batch_inference->result = embedding_res_t(500, nlohmann::json({{"error", "Model failed."}}));
+                }
+                return ;
+            }
+        }
+
+        embed_batch(batch);
+    }, 1);
+
+    auto results = infer_behind_first_batch(batcher, 10, [](size_t i) {
+        std::vector<encoded_input_t> inputs;
+        inputs.push_back(make_input(i, 4));
+        return inputs;
+    });
+
+    // the inputs of all callers were run in one batch, which failed because of one of them
+    std::vector<size_t> expected_batch_sizes = {1, 10};
+    ASSERT_EQ(expected_batch_sizes, batch_sizes);
+
+    ASSERT_TRUE(results[0][0].success);
+
+    for(size_t i = 0; i < 10; i++) {
+        ASSERT_EQ(1, results[i + 1].size());
+        ASSERT_FALSE(results[i + 1][0].success);
+        ASSERT_EQ(500, results[i + 1][0].status_code);
+        ASSERT_EQ("Model failed.", results[i + 1][0].error["error"].get<std::string>());
+    }
+
+    // a later batch without the bad input succeeds
+    std::vector<encoded_input_t> inputs;
+    inputs.push_back(make_input(6, 4));
+    auto later_results = batcher.infer(std::move(inputs));
+    ASSERT_TRUE(later_results[0].success);
+
+    auto stats = batcher.get_stats();
+    ASSERT_EQ(3, stats["num_batches"].get<size_t>());
+    ASSERT_EQ(12, stats["num_inputs"].get<size_t>());
+}
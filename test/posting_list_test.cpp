@@ -2,6 +2,7 @@
 #include "posting.h"
 #include "array_utils.h"
 #include <chrono>
+#include <random>
 #include <vector>
 
 class PostingListTest : public ::testing::Test {
@@ -822,6 +823,40 @@ TEST_F(PostingListTest, IntersectionSkipBlocks) {
     delete [] final_results;
 }
 
+TEST_F(PostingListTest, IntersectionSkewedLists) {
+    // long skips within and across large blocks exercise the galloping skip_to()
+    std::vector<uint32_t> offsets = {0};
+    posting_list_t short_list(256);
+    posting_list_t long_list(256);
+
+    std::vector<uint32_t> short_ids;
+    std::vector<uint32_t> long_ids;
+
+    for(uint32_t id = 0; id < 20000; id++) {
+        if(id % 3 == 0 || id % 7 == 0) {
+            long_ids.push_back(id);
+            long_list.upsert(id, offsets);
+        }
+
+        if(id % 97 == 0 || id == 19999) {
+            short_ids.push_back(id);
+            short_list.upsert(id, offsets);
+        }
+    }
+
+    std::vector<uint32_t> expected_ids;
+    std::set_intersection(short_ids.begin(), short_ids.end(), long_ids.begin(), long_ids.end(),
+                          std::back_inserter(expected_ids));
+
+    std::vector<uint32_t> result_ids;
+    posting_list_t::intersect({&short_list, &long_list}, result_ids);
+    ASSERT_EQ(expected_ids, result_ids);
+
+    result_ids.clear();
+    posting_list_t::intersect({&long_list, &short_list}, result_ids);
+    ASSERT_EQ(expected_ids, result_ids);
+}
+
 TEST_F(PostingListTest, PostingListContainsAtleastOne) {
     // when posting list is larger than target IDs
     posting_list_t p1(100);
@@ -1548,6 +1583,96 @@ TEST_F(PostingListTest, DISABLED_BenchmarkIntersection) {
     LOG(INFO) << "Time taken for sorted array intersection: " << timeMicros;
 }
 
+TEST_F(PostingListTest, DISABLED_BenchmarkSkewedAndBalancedIntersection) {
+    std::vector<uint32_t> offsets = {0};
+    std::mt19937 gen(1337);
+
+    // {size of first list, size of second list}: skewed pair followed by a balanced pair
+    const std::vector<std::pair<size_t, size_t>> list_sizes = {{1000, 1000000}, {200000, 200000}};
+    const size_t num_range = 5000000;
+
+    for(const auto& sizes: list_sizes) {
+        std::set<uint32_t> ids1, ids2;
+        while(ids1.size() < sizes.first) {
+            ids1.insert(gen() % num_range);
+        }
+
+        while(ids2.size() < sizes.second) {
+            ids2.insert(gen() % num_range);
+        }
+
+        posting_list_t pl1(1024);
+        posting_list_t pl2(1024);
+        std::vector<uint32_t> arr1(ids1.begin(), ids1.end());
+        std::vector<uint32_t> arr2(ids2.begin(), ids2.end());
+
+        for(auto id: arr1) {
+            pl1.upsert(id, offsets);
+        }
+
+        for(auto id: arr2) {
+            pl2.upsert(id, offsets);
+        }
+
+        std::vector<uint32_t> result_ids;
+        auto begin = std::chrono::high_resolution_clock::now();
+
+        posting_list_t::intersect({&pl1, &pl2}, result_ids);
+
+        long long int timeMicros =
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - begin).count();
+
+        LOG(INFO) << "Lists of size " << arr1.size() << " and " << arr2.size() << ", result len: " << result_ids.size();
+        LOG(INFO) << "Time taken for galloping posting list intersection: " << timeMicros;
+
+        // baseline: one id at a time linear merge over the uncompressed ids
+        begin = std::chrono::high_resolution_clock::now();
+
+        uint32_t* linear_results = nullptr;
+        size_t linear_len = ArrayUtils::and_scalar(arr1.data(), arr1.size(), arr2.data(), arr2.size(), &linear_results);
+
+        timeMicros =
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - begin).count();
+
+        LOG(INFO) << "Time taken for linear intersection of uncompressed arrays: " << timeMicros;
+
+        ASSERT_EQ(linear_len, result_ids.size());
+        delete [] linear_results;
+
+        // skip cost in isolation: vectorized galloping vs the linear scan that skip_to() used before
+        std::vector<uint32_t> targets;
+        for(size_t i = 0; i < arr1.size(); i++) {
+            targets.push_back(arr1[i]);
+        }
+
+        begin = std::chrono::high_resolution_clock::now();
+        uint32_t index = 0;
+        size_t checksum = 0;
+        for(auto target: targets) {
+            index = ArrayUtils::lower_bound_from(arr2.data(), arr2.size(), index, target);
+            checksum += index;
+        }
+
+        timeMicros =
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - begin).count();
+        LOG(INFO) << "Time taken for galloping skips: " << timeMicros << ", checksum: " << checksum;
+
+        begin = std::chrono::high_resolution_clock::now();
+        index = 0;
+        checksum = 0;
+        for(auto target: targets) {
+            while(index < arr2.size() && arr2[index] < target) {
+                index++;
+            }
+            checksum += index;
+        }
+
+        timeMicros =
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - begin).count();
+        LOG(INFO) << "Time taken for linear skips: " << timeMicros << ", checksum: " << checksum;
+    }
+}
+
 TEST_F(PostingListTest, GetOrIterator) {
     std::vector<uint32_t> ids = {1, 3, 5};
     std::vector<uint32_t> offset_index = {0, 3, 6};
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "quantized_vectors.h"
+
+TEST(QuantizedVectorsTest, Int8DistanceApproximatesInnerProduct) {
+    const size_t num_dim = 37;
+    Int8InnerProductSpace space(num_dim);
+    ASSERT_EQ(sizeof(float) + num_dim, space.get_data_size());
+
+    std::mt19937 rng;
+    rng.seed(47);
+    std::uniform_real_distribution<float> distrib(-1, 1);
+    std::uniform_int_distribution<int> code_distrib(-127, 127);
+
+    for(size_t round = 0; round < 100; round++) {
+        std::vector<float> a(num_dim), b(num_dim);
+        std::generate(a.begin(), a.end(), [&](){ return distrib(rng); });
+        std::generate(b.begin(), b.end(), [&](){ return distrib(rng); });
+
+        float inner_product = 0;
+        for(size_t i = 0; i < num_dim; i++) {
+            inner_product += a[i] * b[i];
+        }
+
+        std::vector<char> a_codes(space.get_data_size()), b_codes(space.get_data_size());
+        Int8InnerProductSpace::quantize(a.data(), num_dim, a_codes.data());
+        Int8InnerProductSpace::quantize(b.data(), num_dim, b_codes.data());
+
+        float dist = space.get_dist_func()(a_codes.data(), b_codes.data(), space.get_dist_func_param());
+        ASSERT_NEAR(1.0f - inner_product, dist, 0.05);
+
+        // the SIMD kernels handle the dimensions that do not fill a whole register
+        std::vector<int8_t> x(num_dim), y(num_dim);
+        int32_t expected = 0;
+        for(size_t i = 0; i < num_dim; i++) {
+            x[i] = code_distrib(rng);
+            y[i] = code_distrib(rng);
+            expected += int32_t(x[i]) * y[i];
+        }
+
+        ASSERT_EQ(expected, Int8InnerProductSpace::dot_product(x.data(), y.data(), num_dim));
+    }
+
+    // zero vector does not divide by zero
+    std::vector<float> zeros(num_dim, 0.0f);
+    std::vector<char> zero_codes(space.get_data_size());
+    Int8InnerProductSpace::quantize(zeros.data(), num_dim, zero_codes.data());
+    ASSERT_FLOAT_EQ(1.0f, space.get_dist_func()(zero_codes.data(), zero_codes.data(), space.get_dist_func_param()));
+}
+
+TEST(QuantizedVectorsTest, HalfPrecisionConversion) {
+    for(float value: {0.0f, 1.0f, -2.5f, 0.333333f, 65504.0f, 6.1035156e-05f, 5.9604645e-08f, -0.0001f}) {
+        const float converted = half_vector_store_t::half_to_float(half_vector_store_t::float_to_half(value));
+        ASSERT_NEAR(value, converted, std::max(std::fabs(value) / 1024, 6e-8f));
+    }
+
+    ASSERT_EQ(0x3c00, half_vector_store_t::float_to_half(1.0f));
+    ASSERT_EQ(0xc000, half_vector_store_t::float_to_half(-2.0f));
+    ASSERT_EQ(0x7c00, half_vector_store_t::float_to_half(100000.0f));
+    ASSERT_TRUE(std::isinf(half_vector_store_t::half_to_float(0x7c00)));
+
+    // halfway between 1 and the next half rounds to even
+    ASSERT_EQ(0x3c00, half_vector_store_t::float_to_half(1.0f + 1.0f / 2048));
+}
+
+TEST(QuantizedVectorsTest, HalfVectorStoreUpsertEraseAndPersist) {
+    half_vector_store_t store(3);
+    std::vector<float> values;
+
+    store.upsert(10, std::vector<float>({0.5, -0.25, 1}).data());
+    store.upsert(20, std::vector<float>({1, 2, 3}).data());
+    store.upsert(10, std::vector<float>({0.75, 0, -1}).data());
+
+    ASSERT_EQ(2, store.size());
+    ASSERT_TRUE(store.get(10, values));
+    ASSERT_EQ(std::vector<float>({0.75, 0, -1}), values);
+    ASSERT_FALSE(store.get(30, values));
+
+    // erased slots are reused
+    store.erase(20);
+    store.erase(40);
+    ASSERT_FALSE(store.get(20, values));
+    store.upsert(30, std::vector<float>({4, 5, 6}).data());
+    ASSERT_EQ(2, store.size());
+
+    const std::string file_path = "/tmp/typesense_test_half_vector_store.f16";
+    store.save(file_path);
+
+    half_vector_store_t loaded_store(3);
+    loaded_store.load(file_path);
+    ASSERT_EQ(2, loaded_store.size());
+    ASSERT_TRUE(loaded_store.get(30, values));
+    ASSERT_EQ(std::vector<float>({4, 5, 6}), values);
+    ASSERT_TRUE(loaded_store.get(10, values));
+    ASSERT_EQ(std::vector<float>({0.75, 0, -1}), values);
+
+    half_vector_store_t mismatched_store(4);
+    ASSERT_THROW(mismatched_store.load(file_path), std::runtime_error);
+    ASSERT_THROW(mismatched_store.load("/tmp/typesense_test_missing.f16"), std::runtime_error);
+
+    std::remove(file_path.c_str());
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "query_embedding_cache.h"
+
+TEST(QueryEmbeddingCacheTest, FindInsertAndInvalidate) {
+    query_embedding_cache_t cache(1024 * 1024);
+    std::vector<float> embedding;
+
+    ASSERT_FALSE(cache.find("ts/e5-small", "query: shoes", embedding));
+
+    cache.insert("ts/e5-small", "query: shoes", {0.1, 0.2, 0.3});
+    cache.insert("openai/text-embedding-ada-002", "query: shoes", {0.4, 0.5});
+
+    ASSERT_TRUE(cache.find("ts/e5-small", "query: shoes", embedding));
+    ASSERT_EQ(std::vector<float>({0.1, 0.2, 0.3}), embedding);
+
+    // queries are looked up as given: normalizing them is up to the caller
+    ASSERT_FALSE(cache.find("ts/e5-small", "  query:   shoes ", embedding));
+    ASSERT_FALSE(cache.find("ts/e5-small", "query: Shoes", embedding));
+    ASSERT_TRUE(cache.find("ts/e5-small", query_embedding_cache_t::normalize_query("  query:   shoes "), embedding));
+    ASSERT_EQ("query: Shoes", query_embedding_cache_t::normalize_query("\tquery: \n Shoes  "));
+
+    // model key and query cannot run into each other
+    ASSERT_FALSE(cache.find("ts/e5-smallquery:", " shoes", embedding));
+
+    ASSERT_TRUE(cache.find("openai/text-embedding-ada-002", "query: shoes", embedding));
+    ASSERT_EQ(std::vector<float>({0.4, 0.5}), embedding);
+
+    cache.erase_model("ts/e5-small");
+    ASSERT_EQ(1, cache.size());
+    ASSERT_FALSE(cache.find("ts/e5-small", "query: shoes", embedding));
+    ASSERT_TRUE(cache.find("openai/text-embedding-ada-002", "query: shoes", embedding));
+
+    auto stats = cache.get_stats();
+    ASSERT_EQ(4, stats["num_hits"].get<size_t>());
+    ASSERT_EQ(5, stats["num_misses"].get<size_t>());
+
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(0, cache.get_stats()["num_bytes"].get<size_t>());
+}
+
+TEST(QueryEmbeddingCacheTest, EvictsLeastRecentlyUsedBeyondMaxBytes) {
+    const std::vector<float> embedding(256, 0.5);
+    query_embedding_cache_t cache(16 * 1024);
+
+    for(size_t i = 0; i < 100; i++) {
+        cache.insert("model", "query " + std::to_string(i), embedding);
+
+        // keep the first query in use
+        std::vector<float> found;
+        ASSERT_TRUE(cache.find("model", "query 0", found));
+    }
+
+    auto stats = cache.get_stats();
+    ASSERT_LE(stats["num_bytes"].get<size_t>(), 16 * 1024);
+    ASSERT_LT(cache.size(), 16);
+    ASSERT_EQ(100 - cache.size(), stats["num_evictions"].get<size_t>());
+
+    std::vector<float> found;
+    ASSERT_TRUE(cache.find("model", "query 0", found));
+    ASSERT_TRUE(cache.find("model", "query 99", found));
+    ASSERT_FALSE(cache.find("model", "query 1", found));
+
+    // shrinking the cache evicts right away, and a capacity of 0 disables it
+    cache.set_max_bytes(0);
+    ASSERT_EQ(0, cache.size());
+    cache.insert("model", "query 0", embedding);
+    ASSERT_FALSE(cache.find("model", "query 0", found));
+}
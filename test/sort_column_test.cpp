@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "sort_column.h"
+
+TEST(SortColumnTest, InsertLookupAndErase) {
+    sort_column_t column;
+    ASSERT_EQ(0, column.size());
+    ASSERT_FALSE(column.contains(0));
+    ASSERT_EQ(-1, column.get(0, -1));
+
+    ASSERT_TRUE(column.emplace(0, 100));
+    ASSERT_TRUE(column.emplace(5, INT64_MIN));
+    ASSERT_TRUE(column.emplace(7, INT64_MAX));
+
+    // existing value is not overwritten
+    ASSERT_FALSE(column.emplace(0, 200));
+
+    ASSERT_EQ(3, column.size());
+    ASSERT_EQ(100, column.at(0));
+    ASSERT_EQ(INT64_MIN, column.at(5));
+    ASSERT_EQ(INT64_MAX, column.get(7, 0));
+    ASSERT_EQ(0, column.count(6));
+    ASSERT_EQ(42, column.get(6, 42));
+    ASSERT_THROW(column.at(6), std::out_of_range);
+
+    column.erase(5);
+    column.erase(6);
+    ASSERT_EQ(2, column.size());
+    ASSERT_FALSE(column.contains(5));
+
+    // value can be stored again after erase
+    ASSERT_TRUE(column.emplace(5, -10));
+    ASSERT_EQ(-10, column.at(5));
+}
+
+TEST(SortColumnTest, GrowsBeyondInitialCapacity) {
+    sort_column_t column;
+
+    for(uint32_t i = 0; i < 10000; i += 3) {
+        column.emplace(i, int64_t(i) * 1000000);
+    }
+
+    ASSERT_EQ(3334, column.size());
+    ASSERT_GE(column.get_capacity(), 9999);
+
+    for(uint32_t i = 0; i < 10000; i++) {
+        if(i % 3 == 0) {
+            ASSERT_EQ(int64_t(i) * 1000000, column.at(i));
+        } else {
+            ASSERT_FALSE(column.contains(i));
+        }
+    }
+
+    // sparse seq id far away from the existing ones
+    column.emplace(1000000, 1);
+    ASSERT_EQ(1, column.at(1000000));
+    ASSERT_FALSE(column.contains(999999));
+    ASSERT_FALSE(column.contains(1000001));
+
+    column.clear();
+    ASSERT_EQ(0, column.size());
+    ASSERT_FALSE(column.contains(0));
+}
+
+TEST(SortColumnTest, NarrowWidths) {
+    sort_column_t bool_column(sort_column_t::WIDTH_8);
+    bool_column.emplace(1, 1);
+    bool_column.emplace(2, 0);
+    ASSERT_EQ(sort_column_t::WIDTH_8, bool_column.get_width());
+    ASSERT_EQ(1, bool_column.at(1));
+    ASSERT_EQ(0, bool_column.at(2));
+
+    sort_column_t int32_column(sort_column_t::WIDTH_32);
+    int32_column.emplace(0, INT32_MIN);
+    int32_column.emplace(3000, INT32_MAX);
+    ASSERT_EQ(INT32_MIN, int32_column.at(0));
+    ASSERT_EQ(INT32_MAX, int32_column.at(3000));
+
+    // unsupported widths fall back to 64 bits
+    sort_column_t default_column(3);
+    ASSERT_EQ(sort_column_t::WIDTH_64, default_column.get_width());
+}
@@ -165,4 +165,32 @@ TEST(StoreTest, Contains) {
     ASSERT_EQ(true, primary_store.contains("foo4"));
     ASSERT_EQ(false, primary_store.contains("foo"));
     ASSERT_EQ(false, primary_store.contains("foo5"));
-}
\ No newline at end of file
+}
+
+TEST(StoreTest, MultiGet) {
+    std::string primary_store_path = "/tmp/typesense_test/primary_store_test";
+    LOG(INFO) << "Truncating and creating: " << primary_store_path;
+    system(("rm -rf "+primary_store_path+" && mkdir -p "+primary_store_path).c_str());
+
+    Store primary_store(primary_store_path, 0, 0, true);  // disable WAL
+    primary_store.insert("foo1", "bar1");
+    primary_store.insert("foo2", "bar2");
+    primary_store.insert("foo3", "bar3");
+
+    std::vector<std::string> values;
+    std::vector<StoreStatus> statuses;
+    primary_store.multi_get({"foo3", "foo", "foo1"}, values, statuses);
+
+    ASSERT_EQ(3, values.size());
+    ASSERT_EQ(3, statuses.size());
+
+    ASSERT_EQ(StoreStatus::FOUND, statuses[0]);
+    ASSERT_EQ("bar3", values[0]);
+    ASSERT_EQ(StoreStatus::NOT_FOUND, statuses[1]);
+    ASSERT_EQ(StoreStatus::FOUND, statuses[2]);
+    ASSERT_EQ("bar1", values[2]);
+
+    primary_store.multi_get({}, values, statuses);
+    ASSERT_EQ(0, values.size());
+    ASSERT_EQ(0, statuses.size());
+}
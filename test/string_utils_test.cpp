@@ -478,3 +478,43 @@ TEST(StringUtilsTest, SplitReferenceIncludeExcludeFields) {
     ASSERT_EQ("$inventory(qty,sku,$retailer(id,title))", token);
     ASSERT_EQ(", foo)", exclude_fields.substr(index));
 }
+
+TEST(StringUtilsTest, SplitJsonLines) {
+    std::vector<std::string> json_lines;
+
+    // complete last record
+    std::string body = R"({"id": "0", "title": "a}b"})" "\n\n" R"({"id": "1", "tags": ["x", "y"]})";
+    StringUtils::split_json_lines(body, json_lines, false);
+    ASSERT_EQ(2, json_lines.size());
+    ASSERT_EQ(R"({"id": "0", "title": "a}b"})", json_lines[0]);
+    ASSERT_EQ(R"({"id": "1", "tags": ["x", "y"]})", json_lines[1]);
+    ASSERT_TRUE(body.empty());
+
+    // partial last record is kept for the next chunk, including one that is cut within a string
+    json_lines.clear();
+    body = R"({"id": "0"})" "\n" R"({"id": "1", "title": "escaped \"}")";
+    StringUtils::split_json_lines(body, json_lines, false);
+    ASSERT_EQ(1, json_lines.size());
+    ASSERT_EQ(R"({"id": "0"})", json_lines[0]);
+    ASSERT_EQ(R"({"id": "1", "title": "escaped \"}")", body);
+
+    body += R"("})" "\n";
+    json_lines.clear();
+    StringUtils::split_json_lines(body, json_lines, false);
+    ASSERT_EQ(1, json_lines.size());
+    ASSERT_EQ(R"({"id": "1", "title": "escaped \"}"})", json_lines[0]);
+    ASSERT_TRUE(body.empty());
+
+    // the last chunk hands over everything
+    json_lines.clear();
+    body = R"({"id": "0"})" "\n" R"({"id": )";
+    StringUtils::split_json_lines(body, json_lines, true);
+    ASSERT_EQ(2, json_lines.size());
+    ASSERT_EQ(R"({"id": )", json_lines[1]);
+    ASSERT_TRUE(body.empty());
+
+    ASSERT_TRUE(StringUtils::is_closed_json_object(R"( {"a": {"b": [1, 2]}} )", 22));
+    ASSERT_FALSE(StringUtils::is_closed_json_object(R"({"a": 1} {)", 10));
+    ASSERT_FALSE(StringUtils::is_closed_json_object(R"([1, 2])", 6));
+    ASSERT_FALSE(StringUtils::is_closed_json_object(R"({"a": "\)", 8));
+}
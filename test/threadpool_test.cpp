@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include "threadpool.h"
+
+class ThreadPoolTest : public ::testing::Test {
+protected:
+    ThreadPool* pool;
+
+    virtual void SetUp() {
+        pool = new ThreadPool(4);
+    }
+
+    virtual void TearDown() {
+        pool->shutdown();
+        delete pool;
+    }
+};
+
+TEST_F(ThreadPoolTest, EnqueueReturnsFuture) {
+    std::vector<std::future<int>> results;
+    for(int i = 0; i < 100; i++) {
+        results.push_back(pool->enqueue([i]() { return i * 2; }));
+    }
+
+    for(int i = 0; i < 100; i++) {
+        ASSERT_EQ(i * 2, results[i].get());
+    }
+
+    auto res = pool->enqueue_with_priority(ThreadPool::HIGH, [](int a, int b) { return a + b; }, 3, 4);
+    ASSERT_EQ(7, res.get());
+}
+
+TEST_F(ThreadPoolTest, TaskGroupWait) {
+    std::atomic<size_t> counter{0};
+
+    ThreadPool::task_group_t group(pool);
+    for(size_t i = 0; i < 1000; i++) {
+        group.run([&counter]() { counter++; });
+    }
+
+    group.wait();
+    ASSERT_EQ(1000, counter.load());
+
+    // group can be reused after a wait
+    group.run([&counter]() { counter++; });
+    group.wait();
+    ASSERT_EQ(1001, counter.load());
+}
+
+TEST_F(ThreadPoolTest, NestedTaskGroupsDoNotDeadlock) {
+    // every worker blocks on an inner group: the inner tasks must still get done by the waiting threads
+    std::atomic<size_t> counter{0};
+
+    ThreadPool::task_group_t outer(pool);
+    for(size_t i = 0; i < 16; i++) {
+        outer.run([this, &counter]() {
+            ThreadPool::task_group_t inner(pool);
+            for(size_t j = 0; j < 16; j++) {
+                inner.run([&counter]() { counter++; });
+            }
+            inner.wait();
+        });
+    }
+
+    outer.wait();
+    ASSERT_EQ(16 * 16, counter.load());
+}
+
+TEST_F(ThreadPoolTest, TaskGroupPropagatesException) {
+    std::atomic<size_t> counter{0};
+
+    ThreadPool::task_group_t group(pool);
+    for(size_t i = 0; i < 10; i++) {
+        group.run([i, &counter]() {
+            if(i == 5) {
+                throw std::runtime_error("boom");
+            }
+            counter++;
+        });
+    }
+
+    ASSERT_THROW(group.wait(), std::runtime_error);
+    ASSERT_EQ(9, counter.load());
+}
+
+TEST_F(ThreadPoolTest, TaskGroupWithoutPoolRunsInline) {
+    size_t counter = 0;
+    ThreadPool::task_group_t group(nullptr);
+    for(size_t i = 0; i < 10; i++) {
+        group.run([&counter]() { counter++; });
+    }
+
+    group.wait();
+    ASSERT_EQ(10, counter);
+}
+
+TEST_F(ThreadPoolTest, ParallelFor) {
+    std::vector<uint32_t> values(10007);
+    pool->parallel_for(0, values.size(), 8, [&values](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            values[i] = i;
+        }
+    });
+
+    for(size_t i = 0; i < values.size(); i++) {
+        ASSERT_EQ(i, values[i]);
+    }
+
+    // more chunks than elements and an empty range
+    std::atomic<size_t> num_calls{0};
+    pool->parallel_for(0, 3, 8, [&num_calls](size_t begin, size_t end) { num_calls += end - begin; });
+    pool->parallel_for(5, 5, 8, [&num_calls](size_t begin, size_t end) { num_calls++; });
+    ASSERT_EQ(3, num_calls.load());
+}
+
+TEST_F(ThreadPoolTest, HighPriorityTasksRunFirst) {
+    ThreadPool single_pool(1);
+
+    // keep the only worker busy until all of the tasks below are queued
+    std::promise<void> gate;
+    auto gate_future = gate.get_future().share();
+    single_pool.enqueue([gate_future]() { gate_future.wait(); });
+
+    std::mutex order_mutex;
+    std::vector<int> order;
+
+    for(int i = 0; i < 3; i++) {
+        single_pool.enqueue([i, &order, &order_mutex]() {
+            std::unique_lock<std::mutex> lock(order_mutex);
+            order.push_back(i);
+        });
+    }
+
+    single_pool.enqueue_with_priority(ThreadPool::HIGH, [&order, &order_mutex]() {
+        std::unique_lock<std::mutex> lock(order_mutex);
+        order.push_back(100);
+    });
+
+    gate.set_value();
+    single_pool.shutdown();
+
+    std::vector<int> expected = {100, 0, 1, 2};
+    ASSERT_EQ(expected, order);
+}
+
+TEST_F(ThreadPoolTest, ShutdownDrainsQueuedTasks) {
+    ThreadPool local_pool(2);
+    std::atomic<size_t> counter{0};
+
+    for(size_t i = 0; i < 500; i++) {
+        local_pool.enqueue([&counter]() { counter++; });
+    }
+
+    local_pool.shutdown();
+    ASSERT_EQ(500, counter.load());
+}
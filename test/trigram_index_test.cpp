@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "trigram_index.h"
+
+namespace {
+    std::vector<std::string> get_candidates(const trigram_index_t& index, const std::string& query) {
+        std::vector<std::string> candidates;
+        index.for_each_candidate(query, [&](const std::string& token) {
+            candidates.push_back(token);
+            return true;
+        });
+
+        std::sort(candidates.begin(), candidates.end());
+        return candidates;
+    }
+}
+
+TEST(TrigramIndexTest, CandidatesHaveAllTrigramsOfQuery) {
+    trigram_index_t index;
+
+    index.insert("gh100037in8900x");
+    index.insert("100037");
+    index.insert("shoe");
+    index.insert("37100");
+    index.insert("100037");
+
+    ASSERT_EQ(4, index.size());
+
+    ASSERT_EQ(std::vector<std::string>({"100037", "gh100037in8900x"}), get_candidates(index, "0003"));
+    ASSERT_EQ(std::vector<std::string>({"100037", "37100", "gh100037in8900x"}), get_candidates(index, "100"));
+    ASSERT_TRUE(get_candidates(index, "xyz").empty());
+    ASSERT_TRUE(get_candidates(index, "shoes").empty());
+
+    // queries that are shorter than a trigram are matched against every token
+    ASSERT_EQ(4, get_candidates(index, "sh").size());
+
+    // candidates can be cut short
+    size_t num_visited = 0;
+    index.for_each_candidate("100", [&](const std::string& token) {
+        num_visited++;
+        return false;
+    });
+    ASSERT_EQ(1, num_visited);
+}
+
+TEST(TrigramIndexTest, EraseAndReuseTokenIds) {
+    trigram_index_t index;
+
+    for(size_t i = 0; i < 1000; i++) {
+        index.insert("token" + std::to_string(i));
+    }
+
+    ASSERT_EQ(1000, index.size());
+    ASSERT_EQ(111, get_candidates(index, "en5").size());
+
+    for(size_t i = 0; i < 1000; i += 2) {
+        index.erase("token" + std::to_string(i));
+    }
+
+    index.erase("missing");
+    ASSERT_EQ(500, index.size());
+    ASSERT_EQ(std::vector<std::string>({"token11", "token111", "token113", "token115", "token117", "token119"}),
+              get_candidates(index, "n11"));
+
+    // freed ids are given to new tokens, which must not be confused with the erased ones
+    index.insert("replacement");
+    ASSERT_EQ(501, index.size());
+    ASSERT_EQ(std::vector<std::string>({"replacement"}), get_candidates(index, "acem"));
+    ASSERT_TRUE(get_candidates(index, "en0").empty());
+
+    for(size_t i = 1; i < 1000; i += 2) {
+        index.erase("token" + std::to_string(i));
+    }
+
+    index.erase("replacement");
+    ASSERT_EQ(0, index.size());
+    ASSERT_TRUE(get_candidates(index, "tok").empty());
+    ASSERT_TRUE(get_candidates(index, "to").empty());
+}